@@ -0,0 +1,140 @@
+/*
+ o-----------------------------------------------------------------------------o
+ |
+ | Aperture module implementation
+ |
+ | Methodical Accelerator Design - Copyright (c) 2016+
+ | Support: http://cern.ch/mad  - mad at cern.ch
+ | Authors: L. Deniau, laurent.deniau at cern.ch
+ | Contrib: -
+ |
+ o-----------------------------------------------------------------------------o
+ | You can redistribute this file and/or modify it under the terms of the GNU
+ | General Public License GPLv3 (or later), as published by the Free Software
+ | Foundation. This file is distributed in the hope that it will be useful, but
+ | WITHOUT ANY WARRANTY OF ANY KIND. See http://gnu.org/licenses for details.
+ o-----------------------------------------------------------------------------o
+*/
+
+#include <math.h>
+#include <assert.h>
+
+#include "mad_log.h"
+#include "mad_mem.h"
+#include "mad_poly.h"
+#include "mad_aper.h"
+
+// --- aperture models --------------------------------------------------------o
+
+// x, y are in the aperture frame top right sector, i.e. x, y >= 0
+// models must be consistent with apmodel in madl_aper.mad
+
+static inline log_t __attribute__((pure))
+ap_model (int kind, num_t x, num_t y, const num_t a[4])
+{
+  switch (kind) {
+  case ap_none       : return 1;
+  case ap_square     : return x < a[0] && y < a[0];
+  case ap_rectangle  : return x < a[0] && y < a[1];
+  case ap_circle     : return SQR(x) + SQR(y) < SQR(a[0]);
+  case ap_ellipse    : return SQR(x/a[0]) + SQR(y/a[1]) < 1;
+  case ap_rectcircle : return x < a[0] && y < a[1] && SQR(x) + SQR(y) < SQR(a[2]);
+  case ap_rectellipse: return x < a[0] && y < a[1] &&
+                              SQR(x/a[2]) + SQR(y/a[3]) < 1;
+  case ap_racetrack  : return x < a[0] && y < a[1] &&
+                              (x < a[0]-a[2] || y < a[1]-a[3] ||
+                               SQR((x-(a[0]-a[2]))/a[2]) +
+                               SQR((y-(a[1]-a[3]))/a[3]) < 1);
+  case ap_octagon    : return x < a[0] && y < a[1] &&
+                              y < (x-(a[0]-a[2]))*a[3]/a[2] + a[1];
+  default: error("invalid aperture kind %d", kind);
+  }
+  return 0; // never reached
+}
+
+// loops specialized per kind to help the compiler to vectorize the checks
+#define AP_LOOP(EXPR) \
+  FOR(i,n) { \
+    num_t x_ = fabs(ca*x[i] + sa*y[i] - dx); \
+    num_t y_ = fabs(ca*y[i] - sa*x[i] - dy); \
+    in[i] = (EXPR); \
+  }
+
+void
+mad_ap_inside (const aper_t *ap, ssz_t n, const num_t x[], const num_t y[],
+               log_t in[])
+{
+  assert(ap && x && y && in);
+  const num_t ca = ap->ca, sa = ap->sa, dx = ap->dx, dy = ap->dy;
+  const num_t a0 = ap->ap[0], a1 = ap->ap[1], a2 = ap->ap[2], a3 = ap->ap[3];
+
+  switch (ap->kind) {
+  case ap_square     : AP_LOOP(x_ < a0 && y_ < a0); break;
+  case ap_rectangle  : AP_LOOP(x_ < a0 && y_ < a1); break;
+  case ap_circle     : AP_LOOP(SQR(x_) + SQR(y_) < SQR(a0)); break;
+  case ap_ellipse    : AP_LOOP(SQR(x_/a0) + SQR(y_/a1) < 1); break;
+  case ap_rectcircle : AP_LOOP(x_ < a0 && y_ < a1 && SQR(x_) + SQR(y_) < SQR(a2));
+                       break;
+  case ap_rectellipse: AP_LOOP(x_ < a0 && y_ < a1 && SQR(x_/a2) + SQR(y_/a3) < 1);
+                       break;
+  case ap_racetrack  : AP_LOOP(x_ < a0 && y_ < a1 &&
+                               (x_ < a0-a2 || y_ < a1-a3 ||
+                                SQR((x_-(a0-a2))/a2) + SQR((y_-(a1-a3))/a3) < 1));
+                       break;
+  case ap_octagon    : AP_LOOP(x_ < a0 && y_ < a1 && y_ < (x_-(a0-a2))*a3/a2 + a1);
+                       break;
+
+  case ap_polygon    : {
+    ensure(ap->vx && ap->vy && ap->nv > 2, "invalid polygon aperture");
+    FOR(i,n) {
+      num_t x_ = ca*x[i] + sa*y[i] - dx;
+      num_t y_ = ca*y[i] - sa*x[i] - dy;
+      // see checkpoly in madl_aper.mad for the semantic
+      in[i] = ap_model(ap->mkind, fabs(x_), fabs(y_), ap->map) ||
+              mad_pol_inside(x_, y_, ap->nv, ap->vx, ap->vy);
+    }
+  } break;
+
+  default: error("invalid aperture kind %d", ap->kind);
+  }
+}
+
+#undef AP_LOOP
+
+ssz_t
+mad_ap_check (const aper_t *ap, ssz_t n, num_t x[], num_t y[], idx_t idx[],
+              aplost_t *lst, idx_t turn, num_t s, num_t eidx)
+{
+  assert(ap && x && y && idx && lst);
+  if (n <= 0) return 0;
+
+  mad_alloc_tmp(log_t, in, n);
+  mad_ap_inside(ap, n, x, y, in);
+
+  // compact survivors, lost particles are swapped with the last survivor,
+  // i.e. same order as lostpar in madl_aper.mad (lost stored in reverse order)
+  num_t tn; idx_t ti; log_t tl;
+  for (idx_t i=0; i < n; ) {
+    if (in[i]) { ++i; continue; }
+
+    ensure(lst->n < lst->max, "aperture lost buffer overflow");
+    idx_t k = lst->n++;
+    lst->idx [k] = idx[i];
+    lst->turn[k] = turn;
+    lst->s   [k] = s;
+    lst->eidx[k] = eidx;
+    lst->x   [k] = x[i];
+    lst->y   [k] = y[i];
+
+    --n;
+    SWAP(x  [i], x  [n], tn);
+    SWAP(y  [i], y  [n], tn);
+    SWAP(idx[i], idx[n], ti);
+    SWAP(in [i], in [n], tl);
+  }
+
+  mad_free_tmp(in);
+  return n;
+}
+
+// --- end --------------------------------------------------------------------o
@@ -0,0 +1,68 @@
+#ifndef MAD_APER_H
+#define MAD_APER_H
+
+/*
+ o-----------------------------------------------------------------------------o
+ |
+ | Aperture module interface
+ |
+ | Methodical Accelerator Design - Copyright (c) 2016+
+ | Support: http://cern.ch/mad  - mad at cern.ch
+ | Authors: L. Deniau, laurent.deniau at cern.ch
+ | Contrib: -
+ |
+ o-----------------------------------------------------------------------------o
+ | You can redistribute this file and/or modify it under the terms of the GNU
+ | General Public License GPLv3 (or later), as published by the Free Software
+ | Foundation. This file is distributed in the hope that it will be useful, but
+ | WITHOUT ANY WARRANTY OF ANY KIND. See http://gnu.org/licenses for details.
+ o-----------------------------------------------------------------------------o
+
+  Purpose:
+  - batched aperture checks of particles stored as SoA (x[], y[]) for LuaJIT.
+  - compaction of surviving particles with lost particles records.
+
+ o-----------------------------------------------------------------------------o
+ */
+
+#include "mad_def.h"
+
+// --- types ------------------------------------------------------------------o
+
+// aperture kinds (must be consistent with apkind in madl_aper.mad)
+enum {
+  ap_none, ap_square, ap_rectangle, ap_circle, ap_ellipse, ap_rectcircle,
+  ap_rectellipse, ap_racetrack, ap_octagon, ap_polygon,
+};
+
+typedef struct aper_  aper_t;
+typedef struct aplost_ aplost_t;
+
+struct aper_ {              // must be identical to aper_t in madl_cmad.mad
+  int   kind, mkind;        // aperture kind and polygon inner aperture kind
+  num_t ca, sa, dx, dy;     // tilt (cos, sin) and offsets (tdir applied)
+  num_t ap[4], map[4];      // aperture and polygon inner aperture parameters
+  ssz_t nv;                 // number of polygon vertices (closed polygon)
+  const num_t *vx, *vy;     // polygon vertices
+};
+
+struct aplost_ {            // must be identical to aplost_t in madl_cmad.mad
+  ssz_t  n, max;            // number of records and capacity
+  idx_t *idx, *turn;        // position before compaction (1-based) and turn
+  num_t *s, *eidx;          // s-position and element index
+  num_t *x, *y;             // coordinates at loss (not in aperture frame)
+};
+
+// --- interface --------------------------------------------------------------o
+
+// points inside aperture? (mask)
+void  mad_ap_inside (const aper_t *ap, ssz_t n, const num_t x[], const num_t y[],
+                     log_t in[]);
+
+// check aperture, compact survivors in place (swap with last), record losses
+ssz_t mad_ap_check  (const aper_t *ap, ssz_t n, num_t x[], num_t y[], idx_t idx[],
+                     aplost_t *lst, idx_t turn, num_t s, num_t eidx);
+
+// ----------------------------------------------------------------------------o
+
+#endif // MAD_APER_H
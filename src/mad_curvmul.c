@@ -0,0 +1,3641 @@
+/*
+ o-----------------------------------------------------------------------------o
+ |
+ | Curved multipoles module implementation
+ |
+ | Methodical Accelerator Design - Copyright (c) 2016+
+ | Support: http://cern.ch/mad  - mad at cern.ch
+ | Authors: L. Deniau, laurent.deniau at cern.ch
+ | Contrib: J. Gray, joshua.gray at cern.ch
+ |
+ o-----------------------------------------------------------------------------o
+ | You can redistribute this file and/or modify it under the terms of the GNU
+ | General Public License GPLv3 (or later), as published by the Free Software
+ | Foundation. This file is distributed in the hope that it will be useful, but
+ | WITHOUT ANY WARRANTY OF ANY KIND. See http://gnu.org/licenses for details.
+ o-----------------------------------------------------------------------------o
+*/
+
+#include <math.h>
+
+#include "mad_curvmul.h"
+
+// --- coefficients -----------------------------------------------------------o
+
+/* Non-zero coefficients of the curved multipoles expansion, i.e. the terms
+   (ksl*ax + knl*bx)*eh^n and (ksl*ay + knl*by)*eh^n of bfx and bfy for x^i y^j
+   with n = i+j+1-nmul. They were generated with PTC:
+   - call make_coef(S_B_from_V,I,0)
+   - call make_coef_e(s_e,I)
+   - call get_bend_coeff(S_EB,I,1.D0,MY_TRUE)
+   - call get_bend_electric_coeff(s_e,I)
+   - call get_bend_magnetic_potential(S_B_from_V,I,1.D0,MY_TRUE)
+*/
+
+const int mad_curvmul_cidx[] = { // first coefficient of multipole n+1
+     0,  232,  464,  695,  924, 1150, 1372, 1589,
+  1800, 2004, 2200, 2387, 2564, 2730, 2884, 3025,
+  3152, 3264, 3360, 3439, 3500, 3542, 3564,
+};
+
+const curvmul_t mad_curvmul_coef[] = { // i, j, ax, bx, ay, by
+  {20, 1,                        0,                        0,    -1.0000000000000007E0,                        0},
+  {19, 2,    -10.000000000000007E0,                        0,                        0,                        0},
+  {19, 1,                        0,                        0,    0.99999999999999944E0,                        0},
+  {18, 3,                        0,                        0,     31.666666666666703E0,                        0},
+  {18, 2,     9.4999999999999947E0,                        0,                        0,                        0},
+  {18, 1,                        0,                        0,    -1.0000000000000013E0,                        0},
+  {17, 4,     142.50000000000017E0,                        0,                        0,                        0},
+  {17, 3,                        0,                        0,    -28.499999999999954E0,                        0},
+  {17, 2,    -9.0000000000000124E0,                        0,                        0,                        0},
+  {17, 1,                        0,                        0,     1.0000000000000013E0,                        0},
+  {16, 5,                        0,                        0,    -363.37500000000051E0,                        0},
+  {16, 4,    -121.12499999999980E0,                        0,                        0,                        0},
+  {16, 3,                        0,                        0,     25.500000000000060E0,                        0},
+  {16, 2,     8.5000000000000107E0,                        0,                        0,                        0},
+  {16, 1,                        0,                        0,   -0.99999999999999967E0,                        0},
+  {15, 6,    -969.00000000000136E0,                        0,                        0,                        0},
+  {15, 5,                        0,                        0,     290.69999999999931E0,                        0},
+  {15, 4,     102.00000000000024E0,                        0,                        0,                        0},
+  {15, 3,                        0,                        0,    -22.666666666666714E0,                        0},
+  {15, 2,    -7.9999999999999973E0,                        0,                        0,                        0},
+  {15, 1,                        0,                        0,    0.99999999999999978E0,                        0},
+  {14, 7,                        0,                        0,     1730.3571428571458E0,                        0},
+  {14, 6,     726.74999999999818E0,                        0,                        0,                        0},
+  {14, 5,                        0,                        0,    -229.50000000000068E0,                        0},
+  {14, 4,    -85.000000000000171E0,                        0,                        0,                        0},
+  {14, 3,                        0,                        0,     19.999999999999979E0,                        0},
+  {14, 2,     7.4999999999999982E0,                        0,                        0,                        0},
+  {14, 1,                        0,                        0,    -1.0000000000000009E0,                        0},
+  {13, 8,     3028.1250000000055E0,                        0,                        0,                        0},
+  {13, 7,                        0,                        0,    -1211.2499999999959E0,                        0},
+  {13, 6,    -535.50000000000159E0,                        0,                        0,                        0},
+  {13, 5,                        0,                        0,     178.50000000000045E0,                        0},
+  {13, 4,     69.999999999999929E0,                        0,                        0,                        0},
+  {13, 3,                        0,                        0,    -17.499999999999989E0,                        0},
+  {13, 2,    -7.0000000000000062E0,                        0,                        0,                        0},
+  {13, 1,                        0,                        0,     1.0000000000000016E0,                        0},
+  {12, 9,                        0,                        0,    -3827.2135416666738E0,                        0},
+  {12, 8,    -1968.2812499999934E0,                        0,                        0,                        0},
+  {12, 7,                        0,                        0,     828.75000000000284E0,                        0},
+  {12, 6,     386.75000000000097E0,                        0,                        0,                        0},
+  {12, 5,                        0,                        0,    -136.49999999999974E0,                        0},
+  {12, 4,    -56.874999999999964E0,                        0,                        0,                        0},
+  {12, 3,                        0,                        0,     15.166666666666694E0,                        0},
+  {12, 2,     6.5000000000000098E0,                        0,                        0,                        0},
+  {12, 1,                        0,                        0,    -1.0000000000000000E0,                        0},
+  {11,10,    -4592.6562500000082E0,                        0,                        0,                        0},
+  {11, 9,                        0,                        0,     2296.3281249999905E0,                        0},
+  {11, 8,     1243.1250000000043E0,                        0,                        0,                        0},
+  {11, 7,                        0,                        0,    -552.50000000000171E0,                        0},
+  {11, 6,    -272.99999999999949E0,                        0,                        0,                        0},
+  {11, 5,                        0,                        0,     102.37499999999986E0,                        0},
+  {11, 4,     45.500000000000085E0,                        0,                        0,                        0},
+  {11, 3,                        0,                        0,    -13.000000000000043E0,                        0},
+  {11, 2,    -6.0000000000000000E0,                        0,                        0,                        0},
+  {11, 1,                        0,                        0,     1.0000000000000007E0,                        0},
+  {10,11,                        0,                        0,     4133.3906250000091E0,                        0},
+  {10,10,     2525.9609374999895E0,                        0,                        0,                        0},
+  {10, 9,                        0,                        0,    -1329.4531250000055E0,                        0},
+  {10, 8,    -759.68750000000239E0,                        0,                        0,                        0},
+  {10, 7,                        0,                        0,     357.49999999999926E0,                        0},
+  {10, 6,     187.68749999999972E0,                        0,                        0,                        0},
+  {10, 5,                        0,                        0,    -75.075000000000159E0,                        0},
+  {10, 4,    -35.750000000000114E0,                        0,                        0,                        0},
+  {10, 3,                        0,                        0,     11.000000000000000E0,                        0},
+  {10, 2,     5.5000000000000036E0,                        0,                        0,                        0},
+  {10, 1,                        0,                        0,    -1.0000000000000000E0,                        0},
+  { 9,12,     3444.4921875000073E0,                        0,                        0,                        0},
+  { 9,11,                        0,                        0,    -2066.6953124999900E0,                        0},
+  { 9,10,    -1329.4531250000055E0,                        0,                        0,                        0},
+  { 9, 9,                        0,                        0,     738.58506944444730E0,                        0},
+  { 9, 8,     446.87499999999909E0,                        0,                        0,                        0},
+  { 9, 7,                        0,                        0,    -223.43749999999952E0,                        0},
+  { 9, 6,    -125.12500000000026E0,                        0,                        0,                        0},
+  { 9, 5,                        0,                        0,     53.625000000000227E0,                        0},
+  { 9, 4,     27.500000000000000E0,                        0,                        0,                        0},
+  { 9, 3,                        0,                        0,    -9.1666666666666785E0,                        0},
+  { 9, 2,    -5.0000000000000000E0,                        0,                        0,                        0},
+  { 9, 1,                        0,                        0,     1.0000000000000000E0,                        0},
+  { 8,13,                        0,                        0,    -2185.9277343750059E0,                        0},
+  { 8,12,    -1550.0214843749925E0,                        0,                        0,                        0},
+  { 8,11,                        0,                        0,     978.96093750000387E0,                        0},
+  { 8,10,     664.72656250000250E0,                        0,                        0,                        0},
+  { 8, 9,                        0,                        0,    -391.01562499999909E0,                        0},
+  { 8, 8,    -251.36718749999946E0,                        0,                        0,                        0},
+  { 8, 7,                        0,                        0,     134.06250000000028E0,                        0},
+  { 8, 6,     80.437500000000341E0,                        0,                        0,                        0},
+  { 8, 5,                        0,                        0,    -37.125000000000000E0,                        0},
+  { 8, 4,    -20.625000000000028E0,                        0,                        0,                        0},
+  { 8, 3,                        0,                        0,     7.4999999999999991E0,                        0},
+  { 8, 2,     4.5000000000000000E0,                        0,                        0,                        0},
+  { 8, 1,                        0,                        0,   -0.99999999999999922E0,                        0},
+  { 7,14,    -1249.1015625000034E0,                        0,                        0,                        0},
+  { 7,13,                        0,                        0,     874.37109374999511E0,                        0},
+  { 7,12,     652.64062500000261E0,                        0,                        0,                        0},
+  { 7,11,                        0,                        0,    -435.09375000000182E0,                        0},
+  { 7,10,    -312.81249999999926E0,                        0,                        0,                        0},
+  { 7, 9,                        0,                        0,     195.50781249999946E0,                        0},
+  { 7, 8,     134.06250000000028E0,                        0,                        0,                        0},
+  { 7, 7,                        0,                        0,    -76.607142857143231E0,                        0},
+  { 7, 6,    -49.500000000000000E0,                        0,                        0,                        0},
+  { 7, 5,                        0,                        0,     24.750000000000036E0,                        0},
+  { 7, 4,     14.999999999999998E0,                        0,                        0,                        0},
+  { 7, 3,                        0,                        0,    -5.9999999999999991E0,                        0},
+  { 7, 2,    -3.9999999999999969E0,                        0,                        0,                        0},
+  { 7, 1,                        0,                        0,     1.0000000000000002E0,                        0},
+  { 6,15,                        0,                        0,     541.27734375000171E0,                        0},
+  { 6,14,     437.18554687499756E0,                        0,                        0,                        0},
+  { 6,13,                        0,                        0,    -322.13671875000136E0,                        0},
+  { 6,12,    -253.80468750000105E0,                        0,                        0,                        0},
+  { 6,11,                        0,                        0,     179.15624999999952E0,                        0},
+  { 6,10,     136.85546874999963E0,                        0,                        0,                        0},
+  { 6, 9,                        0,                        0,    -91.236979166666828E0,                        0},
+  { 6, 8,    -67.031250000000327E0,                        0,                        0,                        0},
+  { 6, 7,                        0,                        0,     41.250000000000000E0,                        0},
+  { 6, 6,     28.875000000000043E0,                        0,                        0,                        0},
+  { 6, 5,                        0,                        0,    -15.750000000000000E0,                        0},
+  { 6, 4,    -10.499999999999998E0,                        0,                        0,                        0},
+  { 6, 3,                        0,                        0,     4.6666666666666607E0,                        0},
+  { 6, 2,     3.5000000000000009E0,                        0,                        0,                        0},
+  { 6, 1,                        0,                        0,    -1.0000000000000000E0,                        0},
+  { 5,16,     202.97900390625063E0,                        0,                        0,                        0},
+  { 5,15,                        0,                        0,    -162.38320312499897E0,                        0},
+  { 5,14,    -138.05859375000060E0,                        0,                        0,                        0},
+  { 5,13,                        0,                        0,     107.37890625000054E0,                        0},
+  { 5,12,     89.578124999999758E0,                        0,                        0,                        0},
+  { 5,11,                        0,                        0,    -67.183593749999773E0,                        0},
+  { 5,10,    -54.742187500000092E0,                        0,                        0,                        0},
+  { 5, 9,                        0,                        0,     39.101562500000220E0,                        0},
+  { 5, 8,     30.937500000000000E0,                        0,                        0,                        0},
+  { 5, 7,                        0,                        0,    -20.625000000000043E0,                        0},
+  { 5, 6,    -15.750000000000000E0,                        0,                        0,                        0},
+  { 5, 5,                        0,                        0,     9.4500000000000011E0,                        0},
+  { 5, 4,     6.9999999999999911E0,                        0,                        0,                        0},
+  { 5, 3,                        0,                        0,    -3.5000000000000018E0,                        0},
+  { 5, 2,    -3.0000000000000000E0,                        0,                        0,                        0},
+  { 5, 1,                        0,                        0,     1.0000000000000000E0,                        0},
+  { 4,17,                        0,                        0,    -55.968475341797067E0,                        0},
+  { 4,16,    -50.744750976562180E0,                        0,                        0,                        0},
+  { 4,15,                        0,                        0,     42.732421875000185E0,                        0},
+  { 4,14,     38.349609375000192E0,                        0,                        0,                        0},
+  { 4,13,                        0,                        0,    -31.582031249999915E0,                        0},
+  { 4,12,    -27.993164062499908E0,                        0,                        0,                        0},
+  { 4,11,                        0,                        0,     22.394531250000028E0,                        0},
+  { 4,10,     19.550781250000110E0,                        0,                        0,                        0},
+  { 4, 9,                        0,                        0,    -15.039062499999998E0,                        0},
+  { 4, 8,    -12.890625000000027E0,                        0,                        0,                        0},
+  { 4, 7,                        0,                        0,     9.3750000000000000E0,                        0},
+  { 4, 6,     7.8750000000000009E0,                        0,                        0,                        0},
+  { 4, 5,                        0,                        0,    -5.2499999999999885E0,                        0},
+  { 4, 4,    -4.3750000000000018E0,                        0,                        0,                        0},
+  { 4, 3,                        0,                        0,     2.5000000000000000E0,                        0},
+  { 4, 2,     2.5000000000000000E0,                        0,                        0,                        0},
+  { 4, 1,                        0,                        0,    -1.0000000000000004E0,                        0},
+  { 3,18,    -12.437438964843793E0,                        0,                        0,                        0},
+  { 3,17,                        0,                        0,     11.193695068359295E0,                        0},
+  { 3,16,     10.683105468750046E0,                        0,                        0,                        0},
+  { 3,15,                        0,                        0,    -9.4960937500000533E0,                        0},
+  { 3,14,    -9.0234374999999751E0,                        0,                        0,                        0},
+  { 3,13,                        0,                        0,     7.8955078124999689E0,                        0},
+  { 3,12,     7.4648437500000089E0,                        0,                        0,                        0},
+  { 3,11,                        0,                        0,    -6.3984375000000400E0,                        0},
+  { 3,10,    -6.0156249999999991E0,                        0,                        0,                        0},
+  { 3, 9,                        0,                        0,     5.0130208333333464E0,                        0},
+  { 3, 8,     4.6875000000000000E0,                        0,                        0,                        0},
+  { 3, 7,                        0,                        0,    -3.7500000000000009E0,                        0},
+  { 3, 6,    -3.4999999999999925E0,                        0,                        0,                        0},
+  { 3, 5,                        0,                        0,     2.6250000000000013E0,                        0},
+  { 3, 4,     2.5000000000000000E0,                        0,                        0,                        0},
+  { 3, 3,                        0,                        0,    -1.6666666666666663E0,                        0},
+  { 3, 2,    -2.0000000000000009E0,                        0,                        0,                        0},
+  { 3, 1,                        0,                        0,     1.0000000000000000E0,                        0},
+  { 2,19,                        0,                        0,     1.8547058105468828E0,                        0},
+  { 2,18,     1.8656158447265492E0,                        0,                        0,                        0},
+  { 2,17,                        0,                        0,    -1.7674255371093832E0,                        0},
+  { 2,16,    -1.7805175781250100E0,                        0,                        0,                        0},
+  { 2,15,                        0,                        0,     1.6757812499999953E0,                        0},
+  { 2,14,     1.6918945312499933E0,                        0,                        0,                        0},
+  { 2,13,                        0,                        0,    -1.5791015625000020E0,                        0},
+  { 2,12,    -1.5996093750000100E0,                        0,                        0,                        0},
+  { 2,11,                        0,                        0,     1.4765624999999996E0,                        0},
+  { 2,10,     1.5039062500000038E0,                        0,                        0,                        0},
+  { 2, 9,                        0,                        0,    -1.3671875000000000E0,                        0},
+  { 2, 8,    -1.4062500000000004E0,                        0,                        0,                        0},
+  { 2, 7,                        0,                        0,     1.2499999999999967E0,                        0},
+  { 2, 6,     1.3125000000000007E0,                        0,                        0,                        0},
+  { 2, 5,                        0,                        0,    -1.1250000000000000E0,                        0},
+  { 2, 4,    -1.2499999999999998E0,                        0,                        0,                        0},
+  { 2, 3,                        0,                        0,     1.0000000000000009E0,                        0},
+  { 2, 2,     1.5000000000000000E0,                        0,                        0,                        0},
+  { 2, 1,                        0,                        0,   -0.99999999999999978E0,                        0},
+  { 1,20,    0.18547058105468828E0,                        0,                        0,                        0},
+  { 1,19,                        0,                        0,   -0.18547058105468611E0,                        0},
+  { 1,18,   -0.19638061523437592E0,                        0,                        0,                        0},
+  { 1,17,                        0,                        0,    0.19638061523437619E0,                        0},
+  { 1,16,    0.20947265624999942E0,                        0,                        0,                        0},
+  { 1,15,                        0,                        0,   -0.20947265624999917E0,                        0},
+  { 1,14,   -0.22558593750000028E0,                        0,                        0,                        0},
+  { 1,13,                        0,                        0,    0.22558593750000155E0,                        0},
+  { 1,12,    0.24609374999999992E0,                        0,                        0,                        0},
+  { 1,11,                        0,                        0,   -0.24609375000000067E0,                        0},
+  { 1,10,   -0.27343750000000000E0,                        0,                        0,                        0},
+  { 1, 9,                        0,                        0,    0.27343750000000022E0,                        0},
+  { 1, 8,    0.31249999999999917E0,                        0,                        0,                        0},
+  { 1, 7,                        0,                        0,   -0.31250000000000017E0,                        0},
+  { 1, 6,   -0.37500000000000000E0,                        0,                        0,                        0},
+  { 1, 5,                        0,                        0,    0.37499999999999983E0,                        0},
+  { 1, 4,    0.50000000000000044E0,                        0,                        0,                        0},
+  { 1, 3,                        0,                        0,   -0.50000000000000000E0,                        0},
+  { 1, 2,   -0.99999999999999978E0,                        0,                        0,                        0},
+  { 1, 1,                        0,                        0,     1.0000000000000000E0,                        0},
+  { 0,21,                        0,                        0, -8.3903358096168567E-003,                        0},
+  { 0,20, -9.2735290527343056E-003,                        0,                        0,                        0},
+  { 0,19,                        0,                        0,  9.7616095291941374E-003,                        0},
+  { 0,18,  1.0910034179687566E-002,                        0,                        0,                        0},
+  { 0,17,                        0,                        0, -1.1551800896139689E-002,                        0},
+  { 0,16, -1.3092041015624948E-002,                        0,                        0,                        0},
+  { 0,15,                        0,                        0,  1.3964843750000022E-002,                        0},
+  { 0,14,  1.6113281250000111E-002,                        0,                        0,                        0},
+  { 0,13,                        0,                        0, -1.7352764423076896E-002,                        0},
+  { 0,12, -2.0507812500000056E-002,                        0,                        0,                        0},
+  { 0,11,                        0,                        0,  2.2372159090909085E-002,                        0},
+  { 0,10,  2.7343750000000021E-002,                        0,                        0,                        0},
+  { 0, 9,                        0,                        0, -3.0381944444444368E-002,                        0},
+  { 0, 8, -3.9062500000000021E-002,                        0,                        0,                        0},
+  { 0, 7,                        0,                        0,  4.4642857142857137E-002,                        0},
+  { 0, 6,  6.2499999999999972E-002,                        0,                        0,                        0},
+  { 0, 5,                        0,                        0, -7.5000000000000080E-002,                        0},
+  { 0, 4,   -0.12500000000000000E0,                        0,                        0,                        0},
+  { 0, 3,                        0,                        0,    0.16666666666666657E0,                        0},
+  { 0, 2,    0.50000000000000000E0,                        0,                        0,                        0},
+  { 0, 1,                        0,                        0,    -1.0000000000000000E0,                        0},
+  { 0, 0,     1.0000000000000000E0,                        0,                        0,     1.0000000000000000E0},
+  {20, 1,                        0,                        0,    0.99999999999999889E0,                        0},
+  {19, 2,     9.9999999999999893E0,                        0,                        0,    0.50000000000000044E0},
+  {19, 1,                        0,                        0,    -1.0000000000000002E0,                        0},
+  {18, 3,                        0,     3.1666666666666692E0,    -31.666666666666593E0,                        0},
+  {18, 2,    -9.5000000000000018E0,                        0,                        0,   -0.49999999999999967E0},
+  {18, 1,                        0,                        0,    0.99999999999999956E0,                        0},
+  {17, 4,    -142.49999999999966E0,                        0,                        0,    -7.1250000000000124E0},
+  {17, 3,                        0,    -2.9999999999999978E0,     28.500000000000018E0,                        0},
+  {17, 2,     8.9999999999999964E0,                        0,                        0,    0.50000000000000022E0},
+  {17, 1,                        0,                        0,   -0.99999999999999944E0,                        0},
+  {16, 5,                        0,    -24.225000000000044E0,     363.37499999999892E0,                        0},
+  {16, 4,     121.12500000000007E0,                        0,                        0,     6.3749999999999911E0},
+  {16, 3,                        0,     2.8333333333333348E0,    -25.499999999999986E0,                        0},
+  {16, 2,    -8.4999999999999947E0,                        0,                        0,   -0.50000000000000000E0},
+  {16, 1,                        0,                        0,    0.99999999999999900E0,                        0},
+  {15, 6,     968.99999999999716E0,                        0,                        0,     48.450000000000117E0},
+  {15, 5,                        0,     20.399999999999970E0,    -290.70000000000027E0,                        0},
+  {15, 4,    -101.99999999999994E0,                        0,                        0,    -5.6666666666666696E0},
+  {15, 3,                        0,    -2.6666666666666670E0,     22.666666666666639E0,                        0},
+  {15, 2,     7.9999999999999920E0,                        0,                        0,    0.50000000000000044E0},
+  {15, 1,                        0,                        0,    -1.0000000000000000E0,                        0},
+  {14, 7,                        0,     103.82142857142881E0,    -1730.3571428571370E0,                        0},
+  {14, 6,    -726.75000000000068E0,                        0,                        0,    -38.249999999999929E0},
+  {14, 5,                        0,    -17.000000000000011E0,     229.49999999999991E0,                        0},
+  {14, 4,     84.999999999999901E0,                        0,                        0,     5.0000000000000018E0},
+  {14, 3,                        0,     2.5000000000000018E0,    -19.999999999999957E0,                        0},
+  {14, 2,    -7.5000000000000000E0,                        0,                        0,   -0.49999999999999922E0},
+  {14, 1,                        0,                        0,    0.99999999999999978E0,                        0},
+  {13, 8,    -3028.1249999999895E0,                        0,                        0,    -151.40625000000043E0},
+  {13, 7,                        0,    -76.499999999999858E0,     1211.2500000000016E0,                        0},
+  {13, 6,     535.49999999999977E0,                        0,                        0,     29.750000000000025E0},
+  {13, 5,                        0,     14.000000000000007E0,    -178.49999999999972E0,                        0},
+  {13, 4,    -69.999999999999858E0,                        0,                        0,    -4.3750000000000098E0},
+  {13, 3,                        0,    -2.3333333333333295E0,     17.500000000000004E0,                        0},
+  {13, 2,     6.9999999999999982E0,                        0,                        0,    0.49999999999999989E0},
+  {13, 1,                        0,                        0,    -1.0000000000000009E0,                        0},
+  {12, 9,                        0,    -218.69791666666728E0,     3827.2135416666515E0,                        0},
+  {12, 8,     1968.2812500000025E0,                        0,                        0,     103.59374999999974E0},
+  {12, 7,                        0,     55.250000000000043E0,    -828.74999999999977E0,                        0},
+  {12, 6,    -386.74999999999937E0,                        0,                        0,    -22.750000000000014E0},
+  {12, 5,                        0,    -11.375000000000027E0,     136.49999999999960E0,                        0},
+  {12, 4,     56.875000000000014E0,                        0,                        0,     3.7916666666666572E0},
+  {12, 3,                        0,     2.1666666666666661E0,    -15.166666666666657E0,                        0},
+  {12, 2,    -6.5000000000000053E0,                        0,                        0,   -0.49999999999999989E0},
+  {12, 1,                        0,                        0,     1.0000000000000004E0,                        0},
+  {11,10,     4592.6562499999818E0,                        0,                        0,     229.63281250000074E0},
+  {11, 9,                        0,     138.12499999999966E0,    -2296.3281250000041E0,                        0},
+  {11, 8,    -1243.1249999999995E0,                        0,                        0,    -69.062500000000057E0},
+  {11, 7,                        0,    -39.000000000000021E0,     552.49999999999909E0,                        0},
+  {11, 6,     272.99999999999920E0,                        0,                        0,     17.062500000000060E0},
+  {11, 5,                        0,     9.0999999999999766E0,    -102.37500000000003E0,                        0},
+  {11, 4,    -45.499999999999972E0,                        0,                        0,    -3.2500000000000009E0},
+  {11, 3,                        0,    -1.9999999999999996E0,     13.000000000000018E0,                        0},
+  {11, 2,     6.0000000000000027E0,                        0,                        0,    0.49999999999999978E0},
+  {11, 1,                        0,                        0,    -1.0000000000000002E0,                        0},
+  {10,11,                        0,     229.63281250000074E0,    -4133.3906249999818E0,                        0},
+  {10,10,    -2525.9609375000045E0,                        0,                        0,    -132.94531249999960E0},
+  {10, 9,                        0,    -84.409722222222300E0,     1329.4531250000000E0,                        0},
+  {10, 8,     759.68749999999875E0,                        0,                        0,     44.687500000000021E0},
+  {10, 7,                        0,     26.812500000000092E0,    -357.49999999999875E0,                        0},
+  {10, 6,    -187.68750000000003E0,                        0,                        0,    -12.512499999999958E0},
+  {10, 5,                        0,    -7.1500000000000012E0,     75.074999999999903E0,                        0},
+  {10, 4,     35.750000000000050E0,                        0,                        0,     2.7499999999999996E0},
+  {10, 3,                        0,     1.8333333333333326E0,    -11.000000000000009E0,                        0},
+  {10, 2,    -5.5000000000000009E0,                        0,                        0,   -0.49999999999999978E0},
+  {10, 1,                        0,                        0,     1.0000000000000002E0,                        0},
+  { 9,12,    -3444.4921874999845E0,                        0,                        0,    -172.22460937500063E0},
+  { 9,11,                        0,    -120.85937499999964E0,     2066.6953125000041E0,                        0},
+  { 9,10,     1329.4531250000000E0,                        0,                        0,     73.858506944444514E0},
+  { 9, 9,                        0,     49.652777777777800E0,    -738.58506944444321E0,                        0},
+  { 9, 8,    -446.87499999999841E0,                        0,                        0,    -27.929687500000117E0},
+  { 9, 7,                        0,    -17.874999999999940E0,     223.43750000000003E0,                        0},
+  { 9, 6,     125.12499999999986E0,                        0,                        0,     8.9375000000000018E0},
+  { 9, 5,                        0,     5.4999999999999991E0,    -53.625000000000085E0,                        0},
+  { 9, 4,    -27.500000000000021E0,                        0,                        0,    -2.2916666666666656E0},
+  { 9, 3,                        0,    -1.6666666666666661E0,     9.1666666666666714E0,                        0},
+  { 9, 2,     5.0000000000000009E0,                        0,                        0,    0.49999999999999956E0},
+  { 9, 1,                        0,                        0,   -0.99999999999999956E0,                        0},
+  { 8,13,                        0,    -119.23242187500043E0,     2185.9277343749895E0,                        0},
+  { 8,12,     1550.0214843750032E0,                        0,                        0,     81.580078124999716E0},
+  { 8,11,                        0,     60.429687500000057E0,    -978.96093750000000E0,                        0},
+  { 8,10,    -664.72656249999886E0,                        0,                        0,    -39.101562500000014E0},
+  { 8, 9,                        0,    -27.929687500000117E0,     391.01562499999841E0,                        0},
+  { 8, 8,     251.36718750000003E0,                        0,                        0,     16.757812499999936E0},
+  { 8, 7,                        0,     11.491071428571432E0,    -134.06249999999980E0,                        0},
+  { 8, 6,    -80.437500000000128E0,                        0,                        0,    -6.1875000000000018E0},
+  { 8, 5,                        0,    -4.1249999999999982E0,     37.125000000000036E0,                        0},
+  { 8, 4,     20.625000000000011E0,                        0,                        0,     1.8749999999999996E0},
+  { 8, 3,                        0,     1.4999999999999987E0,    -7.5000000000000027E0,                        0},
+  { 8, 2,    -4.4999999999999982E0,                        0,                        0,   -0.50000000000000000E0},
+  { 8, 1,                        0,                        0,     1.0000000000000000E0,                        0},
+  { 7,14,     1249.1015624999941E0,                        0,                        0,     62.455078125000256E0},
+  { 7,13,                        0,     50.203124999999829E0,    -874.37109375000205E0,                        0},
+  { 7,12,    -652.64062500000000E0,                        0,                        0,    -36.257812500000036E0},
+  { 7,11,                        0,    -28.437500000000011E0,     435.09374999999920E0,                        0},
+  { 7,10,     312.81249999999875E0,                        0,                        0,     19.550781250000103E0},
+  { 7, 9,                        0,     14.895833333333277E0,    -195.50781250000003E0,                        0},
+  { 7, 8,    -134.06249999999980E0,                        0,                        0,    -9.5758928571428594E0},
+  { 7, 7,                        0,    -7.0714285714285730E0,     76.607142857143003E0,                        0},
+  { 7, 6,     49.500000000000050E0,                        0,                        0,     4.1249999999999982E0},
+  { 7, 5,                        0,     2.9999999999999991E0,    -24.750000000000014E0,                        0},
+  { 7, 4,    -15.000000000000005E0,                        0,                        0,    -1.4999999999999978E0},
+  { 7, 3,                        0,    -1.3333333333333335E0,     5.9999999999999956E0,                        0},
+  { 7, 2,     4.0000000000000000E0,                        0,                        0,    0.49999999999999978E0},
+  { 7, 1,                        0,                        0,    -1.0000000000000002E0,                        0},
+  { 6,15,                        0,     29.145703125000122E0,    -541.27734374999704E0,                        0},
+  { 6,14,    -437.18554687500102E0,                        0,                        0,    -23.009765624999915E0},
+  { 6,13,                        0,    -19.523437500000018E0,     322.13671875000011E0,                        0},
+  { 6,12,     253.80468749999955E0,                        0,                        0,     14.929687500000000E0},
+  { 6,11,                        0,     12.441406250000066E0,    -179.15624999999920E0,                        0},
+  { 6,10,    -136.85546875000003E0,                        0,                        0,    -9.1236979166666252E0},
+  { 6, 9,                        0,    -7.4479166666666687E0,     91.236979166666487E0,                        0},
+  { 6, 8,     67.031250000000128E0,                        0,                        0,     5.1562500000000018E0},
+  { 6, 7,                        0,     4.1249999999999982E0,    -41.250000000000043E0,                        0},
+  { 6, 6,    -28.875000000000018E0,                        0,                        0,    -2.6249999999999991E0},
+  { 6, 5,                        0,    -2.0999999999999970E0,     15.750000000000007E0,                        0},
+  { 6, 4,     10.499999999999993E0,                        0,                        0,     1.1666666666666670E0},
+  { 6, 3,                        0,     1.1666666666666663E0,    -4.6666666666666661E0,                        0},
+  { 6, 2,    -3.5000000000000009E0,                        0,                        0,   -0.49999999999999972E0},
+  { 6, 1,                        0,                        0,    0.99999999999999978E0,                        0},
+  { 5,16,    -202.97900390624889E0,                        0,                        0,    -10.148950195312546E0},
+  { 5,15,                        0,    -9.2039062499999673E0,     162.38320312500042E0,                        0},
+  { 5,14,     138.05859375000006E0,                        0,                        0,     7.6699218750000071E0},
+  { 5,13,                        0,     6.8906250000000000E0,    -107.37890624999986E0,                        0},
+  { 5,12,    -89.578124999999602E0,                        0,                        0,    -5.5986328125000329E0},
+  { 5,11,                        0,    -4.9765624999999778E0,     67.183593750000014E0,                        0},
+  { 5,10,     54.742187499999886E0,                        0,                        0,     3.9101562500000013E0},
+  { 5, 9,                        0,     3.4375000000000009E0,    -39.101562500000085E0,                        0},
+  { 5, 8,    -30.937500000000032E0,                        0,                        0,    -2.5781249999999987E0},
+  { 5, 7,                        0,    -2.2499999999999991E0,     20.625000000000018E0,                        0},
+  { 5, 6,     15.750000000000007E0,                        0,                        0,     1.5749999999999973E0},
+  { 5, 5,                        0,     1.4000000000000004E0,    -9.4499999999999904E0,                        0},
+  { 5, 4,    -6.9999999999999991E0,                        0,                        0,   -0.87499999999999967E0},
+  { 5, 3,                        0,   -0.99999999999999944E0,     3.5000000000000018E0,                        0},
+  { 5, 2,     2.9999999999999991E0,                        0,                        0,    0.49999999999999989E0},
+  { 5, 1,                        0,                        0,    -1.0000000000000000E0,                        0},
+  { 4,17,                        0,    -2.9849853515625133E0,     55.968475341796541E0,                        0},
+  { 4,16,     50.744750976562628E0,                        0,                        0,     2.6707763671874893E0},
+  { 4,15,                        0,     2.5566406250000022E0,    -42.732421875000021E0,                        0},
+  { 4,14,    -38.349609374999943E0,                        0,                        0,    -2.2558593749999991E0},
+  { 4,13,                        0,    -2.1533203125000129E0,     31.582031249999851E0,                        0},
+  { 4,12,     27.993164062500004E0,                        0,                        0,     1.8662109374999907E0},
+  { 4,11,                        0,     1.7773437500000004E0,    -22.394531249999950E0,                        0},
+  { 4,10,    -19.550781250000043E0,                        0,                        0,    -1.5039062500000002E0},
+  { 4, 9,                        0,    -1.4322916666666661E0,     15.039062500000020E0,                        0},
+  { 4, 8,     12.890625000000011E0,                        0,                        0,     1.1718749999999998E0},
+  { 4, 7,                        0,     1.1249999999999980E0,    -9.3750000000000071E0,                        0},
+  { 4, 6,    -7.8749999999999920E0,                        0,                        0,   -0.87500000000000044E0},
+  { 4, 5,                        0,   -0.87499999999999967E0,     5.2499999999999982E0,                        0},
+  { 4, 4,     4.3750000000000018E0,                        0,                        0,    0.62499999999999967E0},
+  { 4, 3,                        0,    0.83333333333333315E0,    -2.4999999999999987E0,                        0},
+  { 4, 2,    -2.5000000000000000E0,                        0,                        0,   -0.49999999999999989E0},
+  { 4, 1,                        0,                        0,     1.0000000000000002E0,                        0},
+  { 3,18,     12.437438964843675E0,                        0,                        0,    0.62187194824219061E0},
+  { 3,17,                        0,    0.62841796874999745E0,    -11.193695068359405E0,                        0},
+  { 3,16,    -10.683105468750005E0,                        0,                        0,   -0.59350585937500056E0},
+  { 3,15,                        0,   -0.60156249999999978E0,     9.4960937499999876E0,                        0},
+  { 3,14,     9.0234374999999574E0,                        0,                        0,    0.56396484375000411E0},
+  { 3,13,                        0,    0.57421874999999711E0,    -7.8955078125000036E0,                        0},
+  { 3,12,    -7.4648437499999831E0,                        0,                        0,   -0.53320312500000022E0},
+  { 3,11,                        0,   -0.54687500000000011E0,     6.3984375000000142E0,                        0},
+  { 3,10,     6.0156250000000080E0,                        0,                        0,    0.50130208333333315E0},
+  { 3, 9,                        0,    0.52083333333333326E0,    -5.0130208333333375E0,                        0},
+  { 3, 8,    -4.6875000000000036E0,                        0,                        0,   -0.46874999999999895E0},
+  { 3, 7,                        0,   -0.50000000000000022E0,     3.7499999999999956E0,                        0},
+  { 3, 6,     3.4999999999999991E0,                        0,                        0,    0.43749999999999972E0},
+  { 3, 5,                        0,    0.49999999999999972E0,    -2.6250000000000009E0,                        0},
+  { 3, 4,    -2.4999999999999987E0,                        0,                        0,   -0.41666666666666663E0},
+  { 3, 3,                        0,   -0.66666666666666652E0,     1.6666666666666665E0,                        0},
+  { 3, 2,     2.0000000000000004E0,                        0,                        0,    0.49999999999999989E0},
+  { 3, 1,                        0,                        0,    -1.0000000000000000E0,                        0},
+  { 2,19,                        0,  9.8190307617188000E-002,    -1.8547058105468639E0,                        0},
+  { 2,18,    -1.8656158447265674E0,                        0,                        0, -9.8190307617187042E-002},
+  { 2,17,                        0,   -0.10473632812500011E0,     1.7674255371093759E0,                        0},
+  { 2,16,     1.7805175781249978E0,                        0,                        0,    0.10473632812499992E0},
+  { 2,15,                        0,    0.11279296875000080E0,    -1.6757812499999916E0,                        0},
+  { 2,14,    -1.6918945312500007E0,                        0,                        0,   -0.11279296874999938E0},
+  { 2,13,                        0,   -0.12304687500000004E0,     1.5791015624999960E0,                        0},
+  { 2,12,     1.5996093750000036E0,                        0,                        0,    0.12304687500000004E0},
+  { 2,11,                        0,    0.13671874999999994E0,    -1.4765625000000020E0,                        0},
+  { 2,10,    -1.5039062500000011E0,                        0,                        0,   -0.13671875000000000E0},
+  { 2, 9,                        0,   -0.15624999999999967E0,     1.3671875000000013E0,                        0},
+  { 2, 8,     1.4062499999999982E0,                        0,                        0,    0.15625000000000017E0},
+  { 2, 7,                        0,    0.18749999999999989E0,    -1.2499999999999996E0,                        0},
+  { 2, 6,    -1.3125000000000004E0,                        0,                        0,   -0.18749999999999986E0},
+  { 2, 5,                        0,   -0.25000000000000000E0,     1.1249999999999993E0,                        0},
+  { 2, 4,     1.2500000000000000E0,                        0,                        0,    0.24999999999999992E0},
+  { 2, 3,                        0,    0.49999999999999989E0,    -1.0000000000000004E0,                        0},
+  { 2, 2,    -1.5000000000000000E0,                        0,                        0,   -0.50000000000000000E0},
+  { 2, 1,                        0,                        0,     1.0000000000000000E0,                        0},
+  { 1,20,   -0.18547058105468639E0,                        0,                        0, -9.2735290527344132E-003},
+  { 1,19,                        0, -1.0335821854440741E-002,    0.18547058105468808E0,                        0},
+  { 1,18,    0.19638061523437511E0,                        0,                        0,  1.0910034179687498E-002},
+  { 1,17,                        0,  1.2321920955882344E-002,   -0.19638061523437472E0,                        0},
+  { 1,16,   -0.20947265624999895E0,                        0,                        0, -1.3092041015625099E-002},
+  { 1,15,                        0, -1.5039062499999917E-002,    0.20947265625000014E0,                        0},
+  { 1,14,    0.22558593749999942E0,                        0,                        0,  1.6113281249999993E-002},
+  { 1,13,                        0,  1.8930288461538467E-002,   -0.22558593750000058E0,                        0},
+  { 1,12,   -0.24609375000000033E0,                        0,                        0, -2.0507812500000003E-002},
+  { 1,11,                        0, -2.4857954545454544E-002,    0.24609375000000008E0,                        0},
+  { 1,10,    0.27343750000000028E0,                        0,                        0,  2.7343749999999927E-002},
+  { 1, 9,                        0,  3.4722222222222258E-002,   -0.27343749999999961E0,                        0},
+  { 1, 8,   -0.31249999999999989E0,                        0,                        0, -3.9062499999999972E-002},
+  { 1, 7,                        0, -5.3571428571428534E-002,    0.31250000000000028E0,                        0},
+  { 1, 6,    0.37499999999999978E0,                        0,                        0,  6.2500000000000000E-002},
+  { 1, 5,                        0,  9.9999999999999964E-002,   -0.37499999999999989E0,                        0},
+  { 1, 4,   -0.50000000000000022E0,                        0,                        0,   -0.12500000000000000E0},
+  { 1, 3,                        0,   -0.33333333333333331E0,    0.50000000000000000E0,                        0},
+  { 1, 2,     1.0000000000000000E0,                        0,                        0,    0.50000000000000000E0},
+  { 1, 1,                        0,                        0,    -1.0000000000000000E0,                        0},
+  { 1, 0,     1.0000000000000000E0,                        0,                        0,     1.0000000000000000E0},
+  { 0,21,                        0, -4.4159662155878159E-004,  8.3903358096167543E-003,                        0},
+  { 0,20,  9.2735290527344045E-003,                        0,                        0,  4.8808047645970015E-004},
+  { 0,19,                        0,  5.7421232524671047E-004, -9.7616095291940871E-003,                        0},
+  { 0,18, -1.0910034179687484E-002,                        0,                        0, -6.4176671645220160E-004},
+  { 0,17,                        0, -7.7012005974265289E-004,  1.1551800896139641E-002,                        0},
+  { 0,16,  1.3092041015625009E-002,                        0,                        0,  8.7280273437499495E-004},
+  { 0,15,                        0,  1.0742187499999994E-003, -1.3964843749999964E-002,                        0},
+  { 0,14, -1.6113281250000042E-002,                        0,                        0, -1.2394831730769241E-003},
+  { 0,13,                        0, -1.5775240384615387E-003,  1.7352764423076948E-002,                        0},
+  { 0,12,  2.0507812500000007E-002,                        0,                        0,  1.8643465909090916E-003},
+  { 0,11,                        0,  2.4857954545454480E-003, -2.2372159090909130E-002,                        0},
+  { 0,10, -2.7343749999999962E-002,                        0,                        0, -3.0381944444444497E-003},
+  { 0, 9,                        0, -4.3402777777777745E-003,  3.0381944444444423E-002,                        0},
+  { 0, 8,  3.9062500000000035E-002,                        0,                        0,  5.5803571428571326E-003},
+  { 0, 7,                        0,  8.9285714285714281E-003, -4.4642857142857109E-002,                        0},
+  { 0, 6, -6.2499999999999979E-002,                        0,                        0, -1.2499999999999992E-002},
+  { 0, 5,                        0, -2.5000000000000001E-002,  7.5000000000000025E-002,                        0},
+  { 0, 4,    0.12500000000000000E0,                        0,                        0,  4.1666666666666671E-002},
+  { 0, 3,                        0,    0.16666666666666666E0,   -0.16666666666666666E0,                        0},
+  { 0, 2,   -0.50000000000000000E0,                        0,                        0,   -0.50000000000000000E0},
+  { 0, 1,                        0,     1.0000000000000000E0,    -1.0000000000000000E0,                        0},
+  {20, 1,                        0,                        0,    -1.0000000000000016E0,                        0},
+  {19, 2,    -10.000000000000016E0,                        0,                        0,   -0.99999999999999878E0},
+  {19, 1,                        0,                        0,     1.0000000000000013E0,                        0},
+  {18, 3,                        0,    -6.3333333333333259E0,     32.166666666666757E0,                        0},
+  {18, 2,     9.5000000000000124E0,                        0,                        0,     1.0000000000000004E0},
+  {18, 1,                        0,                        0,    -1.0000000000000009E0,                        0},
+  {17, 4,     144.75000000000040E0,                        0,                        0,     14.249999999999970E0},
+  {17, 3,                        0,     6.0000000000000027E0,    -29.000000000000075E0,                        0},
+  {17, 2,    -9.0000000000000071E0,                        0,                        0,    -1.0000000000000009E0},
+  {17, 1,                        0,                        0,     1.0000000000000009E0,                        0},
+  {16, 5,                        0,     48.449999999999896E0,    -367.20000000000118E0,                        0},
+  {16, 4,    -123.25000000000031E0,                        0,                        0,    -12.750000000000018E0},
+  {16, 3,                        0,    -5.6666666666666714E0,     26.000000000000050E0,                        0},
+  {16, 2,     8.5000000000000071E0,                        0,                        0,    0.99999999999999978E0},
+  {16, 1,                        0,                        0,    -1.0000000000000009E0,                        0},
+  {15, 6,    -979.20000000000323E0,                        0,                        0,    -96.899999999999707E0},
+  {15, 5,                        0,    -40.800000000000054E0,     294.10000000000093E0,                        0},
+  {15, 4,     104.00000000000020E0,                        0,                        0,     11.333333333333355E0},
+  {15, 3,                        0,     5.3333333333333321E0,    -23.166666666666700E0,                        0},
+  {15, 2,    -8.0000000000000071E0,                        0,                        0,    -1.0000000000000000E0},
+  {15, 1,                        0,                        0,    0.99999999999999956E0,                        0},
+  {14, 7,                        0,    -207.64285714285651E0,     1746.7500000000064E0,                        0},
+  {14, 6,     735.25000000000227E0,                        0,                        0,     76.500000000000114E0},
+  {14, 5,                        0,     34.000000000000064E0,    -232.50000000000060E0,                        0},
+  {14, 4,    -86.875000000000128E0,                        0,                        0,    -9.9999999999999982E0},
+  {14, 3,                        0,    -5.0000000000000009E0,     20.500000000000032E0,                        0},
+  {14, 2,     7.4999999999999964E0,                        0,                        0,    0.99999999999999944E0},
+  {14, 1,                        0,                        0,    -1.0000000000000002E0,                        0},
+  {13, 8,     3056.8125000000109E0,                        0,                        0,     302.81249999999881E0},
+  {13, 7,                        0,     153.00000000000023E0,    -1224.0000000000045E0,                        0},
+  {13, 6,    -542.50000000000136E0,                        0,                        0,    -59.500000000000149E0},
+  {13, 5,                        0,    -27.999999999999993E0,     181.12500000000034E0,                        0},
+  {13, 4,     71.750000000000114E0,                        0,                        0,     8.7500000000000036E0},
+  {13, 3,                        0,     4.6666666666666643E0,    -17.999999999999982E0,                        0},
+  {13, 2,    -7.0000000000000018E0,                        0,                        0,    -1.0000000000000000E0},
+  {13, 1,                        0,                        0,    0.99999999999999933E0,                        0},
+  {12, 9,                        0,     437.39583333333161E0,    -3861.7447916666811E0,                        0},
+  {12, 8,    -1989.0000000000073E0,                        0,                        0,    -207.18750000000034E0},
+  {12, 7,                        0,    -110.50000000000028E0,     838.50000000000239E0,                        0},
+  {12, 6,     392.43750000000074E0,                        0,                        0,     45.499999999999993E0},
+  {12, 5,                        0,     22.750000000000011E0,    -138.77500000000032E0,                        0},
+  {12, 4,    -58.499999999999943E0,                        0,                        0,    -7.5833333333333250E0},
+  {12, 3,                        0,    -4.3333333333333330E0,     15.666666666666673E0,                        0},
+  {12, 2,     6.4999999999999956E0,                        0,                        0,    0.99999999999999933E0},
+  {12, 1,                        0,                        0,    -1.0000000000000002E0,                        0},
+  {11,10,    -4634.0937500000173E0,                        0,                        0,    -459.26562499999790E0},
+  {11, 9,                        0,    -276.25000000000045E0,     2319.3489583333421E0,                        0},
+  {11, 8,     1257.7500000000036E0,                        0,                        0,     138.12500000000045E0},
+  {11, 7,                        0,     77.999999999999986E0,    -559.81250000000125E0,                        0},
+  {11, 6,    -277.55000000000064E0,                        0,                        0,    -34.125000000000028E0},
+  {11, 5,                        0,    -18.199999999999982E0,     104.32499999999989E0,                        0},
+  {11, 4,     47.000000000000021E0,                        0,                        0,     6.5000000000000018E0},
+  {11, 3,                        0,     3.9999999999999973E0,    -13.499999999999982E0,                        0},
+  {11, 2,    -6.0000000000000018E0,                        0,                        0,   -0.99999999999999911E0},
+  {11, 1,                        0,                        0,    0.99999999999999956E0,                        0},
+  {10,11,                        0,    -459.26562499999790E0,     4169.6484375000155E0,                        0},
+  {10,10,     2551.2838541666765E0,                        0,                        0,     265.89062500000045E0},
+  {10, 9,                        0,     168.81944444444497E0,    -1344.3489583333374E0,                        0},
+  {10, 8,    -769.74218750000171E0,                        0,                        0,    -89.374999999999986E0},
+  {10, 7,                        0,    -53.625000000000043E0,     362.86250000000103E0,                        0},
+  {10, 6,     191.26249999999979E0,                        0,                        0,     25.024999999999970E0},
+  {10, 5,                        0,     14.300000000000002E0,    -76.725000000000051E0,                        0},
+  {10, 4,    -37.124999999999950E0,                        0,                        0,    -5.4999999999999938E0},
+  {10, 3,                        0,    -3.6666666666666634E0,     11.500000000000005E0,                        0},
+  {10, 2,     5.4999999999999973E0,                        0,                        0,    0.99999999999999978E0},
+  {10, 1,                        0,                        0,    -1.0000000000000004E0,                        0},
+  { 9,12,     3474.7070312500132E0,                        0,                        0,     344.44921874999818E0},
+  { 9,11,                        0,     241.71875000000043E0,    -2086.8385416666752E0,                        0},
+  { 9,10,    -1344.3489583333374E0,                        0,                        0,    -147.71701388888943E0},
+  { 9, 9,                        0,    -99.305555555555543E0,     747.89496527777942E0,                        0},
+  { 9, 8,     453.57812500000131E0,                        0,                        0,     55.859375000000057E0},
+  { 9, 7,                        0,     35.749999999999957E0,    -227.26785714285685E0,                        0},
+  { 9, 6,    -127.87500000000009E0,                        0,                        0,    -17.875000000000011E0},
+  { 9, 5,                        0,    -10.999999999999988E0,     54.999999999999915E0,                        0},
+  { 9, 4,     28.750000000000014E0,                        0,                        0,     4.5833333333333268E0},
+  { 9, 3,                        0,     3.3333333333333326E0,    -9.6666666666666572E0,                        0},
+  { 9, 2,    -5.0000000000000018E0,                        0,                        0,   -0.99999999999999944E0},
+  { 9, 1,                        0,                        0,    0.99999999999999978E0,                        0},
+  { 8,13,                        0,     238.46484374999872E0,    -2204.7539062500082E0,                        0},
+  { 8,12,    -1565.1289062500064E0,                        0,                        0,    -163.16015625000031E0},
+  { 8,11,                        0,    -120.85937500000045E0,     989.62500000000296E0,                        0},
+  { 8,10,     673.10546875000148E0,                        0,                        0,     78.203124999999986E0},
+  { 8, 9,                        0,     55.859375000000057E0,    -396.60156250000136E0,                        0},
+  { 8, 8,    -255.67633928571396E0,                        0,                        0,    -33.515624999999950E0},
+  { 8, 7,                        0,    -22.982142857142872E0,     136.71428571428586E0,                        0},
+  { 8, 6,     82.499999999999872E0,                        0,                        0,     12.374999999999988E0},
+  { 8, 5,                        0,     8.2499999999999876E0,    -38.250000000000036E0,                        0},
+  { 8, 4,    -21.749999999999979E0,                        0,                        0,    -3.7499999999999982E0},
+  { 8, 3,                        0,    -2.9999999999999982E0,     8.0000000000000071E0,                        0},
+  { 8, 2,     4.4999999999999991E0,                        0,                        0,    0.99999999999999978E0},
+  { 8, 1,                        0,                        0,   -0.99999999999999978E0,                        0},
+  { 7,14,    -1259.8593750000048E0,                        0,                        0,    -124.91015624999926E0},
+  { 7,13,                        0,    -100.40625000000018E0,     882.73828125000364E0,                        0},
+  { 7,12,     659.75000000000193E0,                        0,                        0,     72.515625000000284E0},
+  { 7,11,                        0,     56.874999999999986E0,    -440.42578125000102E0,                        0},
+  { 7,10,    -317.28125000000108E0,                        0,                        0,    -39.101562500000057E0},
+  { 7, 9,                        0,    -29.791666666666622E0,     198.69977678571402E0,                        0},
+  { 7, 8,     136.71428571428586E0,                        0,                        0,     19.151785714285733E0},
+  { 7, 7,                        0,     14.142857142857128E0,    -78.374999999999829E0,                        0},
+  { 7, 6,    -51.000000000000050E0,                        0,                        0,    -8.2499999999999858E0},
+  { 7, 5,                        0,    -5.9999999999999973E0,     25.649999999999963E0,                        0},
+  { 7, 4,     16.000000000000014E0,                        0,                        0,     2.9999999999999960E0},
+  { 7, 3,                        0,     2.6666666666666661E0,    -6.4999999999999982E0,                        0},
+  { 7, 2,    -3.9999999999999991E0,                        0,                        0,    -1.0000000000000000E0},
+  { 7, 1,                        0,                        0,     1.0000000000000004E0,                        0},
+  { 6,15,                        0,    -58.291406249999653E0,     545.87929687500207E0,                        0},
+  { 6,14,     441.36914062500182E0,                        0,                        0,     46.019531250000071E0},
+  { 6,13,                        0,     39.046875000000149E0,    -325.58203125000102E0,                        0},
+  { 6,12,    -256.91503906250057E0,                        0,                        0,    -29.859374999999989E0},
+  { 6,11,                        0,    -24.882812500000036E0,     181.64453125000065E0,                        0},
+  { 6,10,     139.08984374999983E0,                        0,                        0,     18.247395833333307E0},
+  { 6, 9,                        0,     14.895833333333346E0,    -92.955729166666785E0,                        0},
+  { 6, 8,    -68.578124999999858E0,                        0,                        0,    -10.312499999999991E0},
+  { 6, 7,                        0,    -8.2499999999999858E0,     42.375000000000057E0,                        0},
+  { 6, 6,     29.924999999999958E0,                        0,                        0,     5.2499999999999964E0},
+  { 6, 5,                        0,     4.1999999999999940E0,    -16.450000000000017E0,                        0},
+  { 6, 4,    -11.374999999999996E0,                        0,                        0,    -2.3333333333333330E0},
+  { 6, 3,                        0,    -2.3333333333333330E0,     5.1666666666666643E0,                        0},
+  { 6, 2,     3.5000000000000018E0,                        0,                        0,    0.99999999999999978E0},
+  { 6, 1,                        0,                        0,    -1.0000000000000000E0,                        0},
+  { 5,16,     204.70473632812576E0,                        0,                        0,     20.297900390624864E0},
+  { 5,15,                        0,     18.407812500000027E0,    -163.91718750000069E0,                        0},
+  { 5,14,    -139.53515625000045E0,                        0,                        0,    -15.339843750000071E0},
+  { 5,13,                        0,    -13.781249999999995E0,     108.67089843750027E0,                        0},
+  { 5,12,     90.822265625000327E0,                        0,                        0,     11.197265625000020E0},
+  { 5,11,                        0,     9.9531249999999858E0,    -68.249999999999886E0,                        0},
+  { 5,10,    -55.773437500000071E0,                        0,                        0,    -7.8203125000000098E0},
+  { 5, 9,                        0,    -6.8749999999999947E0,     39.960937499999901E0,                        0},
+  { 5, 8,     31.781250000000043E0,                        0,                        0,     5.1562499999999911E0},
+  { 5, 7,                        0,     4.4999999999999973E0,    -21.299999999999962E0,                        0},
+  { 5, 6,    -16.450000000000017E0,                        0,                        0,    -3.1499999999999941E0},
+  { 5, 5,                        0,    -2.7999999999999994E0,     9.9749999999999943E0,                        0},
+  { 5, 4,     7.7499999999999964E0,                        0,                        0,     1.7500000000000004E0},
+  { 5, 3,                        0,     1.9999999999999996E0,    -4.0000000000000027E0,                        0},
+  { 5, 2,    -3.0000000000000000E0,                        0,                        0,    -1.0000000000000000E0},
+  { 5, 1,                        0,                        0,     1.0000000000000000E0,                        0},
+  { 4,17,                        0,     5.9699707031249609E0,    -56.439788818359602E0,                        0},
+  { 4,16,    -51.224121093750213E0,                        0,                        0,    -5.3415527343750089E0},
+  { 4,15,                        0,    -5.1132812500000231E0,     43.183593750000142E0,                        0},
+  { 4,14,     38.811035156250099E0,                        0,                        0,     4.5117187499999973E0},
+  { 4,13,                        0,     4.3066406250000080E0,    -32.012695312500135E0,                        0},
+  { 4,12,    -28.437499999999957E0,                        0,                        0,    -3.7324218749999942E0},
+  { 4,11,                        0,    -3.5546875000000044E0,     22.804687500000039E0,                        0},
+  { 4,10,     19.980468749999950E0,                        0,                        0,     3.0078124999999973E0},
+  { 4, 9,                        0,     2.8645833333333282E0,    -15.429687500000021E0,                        0},
+  { 4, 8,    -13.312499999999975E0,                        0,                        0,    -2.3437499999999987E0},
+  { 4, 7,                        0,    -2.2499999999999960E0,     9.7500000000000142E0,                        0},
+  { 4, 6,     8.3124999999999964E0,                        0,                        0,     1.7499999999999991E0},
+  { 4, 5,                        0,     1.7500000000000004E0,    -5.6249999999999938E0,                        0},
+  { 4, 4,    -5.0000000000000036E0,                        0,                        0,    -1.2499999999999998E0},
+  { 4, 3,                        0,    -1.6666666666666665E0,     3.0000000000000000E0,                        0},
+  { 4, 2,     2.5000000000000000E0,                        0,                        0,     1.0000000000000000E0},
+  { 4, 1,                        0,                        0,    -1.0000000000000000E0,                        0},
+  { 3,18,    -12.542175292968800E0,                        0,                        0,    -1.2437438964843661E0},
+  { 3,17,                        0,    -1.2568359375000020E0,     11.298431396484421E0,                        0},
+  { 3,16,     10.795898437500036E0,                        0,                        0,     1.1870117187500060E0},
+  { 3,15,                        0,     1.2031249999999993E0,    -9.6088867187500195E0,                        0},
+  { 3,14,    -9.1464843750000391E0,                        0,                        0,    -1.1279296875000018E0},
+  { 3,13,                        0,    -1.1484374999999982E0,     8.0185546874999840E0,                        0},
+  { 3,12,     7.6015625000000133E0,                        0,                        0,     1.0664062500000016E0},
+  { 3,11,                        0,     1.0937499999999991E0,    -6.5351562499999805E0,                        0},
+  { 3,10,    -6.1718750000000089E0,                        0,                        0,    -1.0026041666666645E0},
+  { 3, 9,                        0,    -1.0416666666666661E0,     5.1692708333333215E0,                        0},
+  { 3, 8,     4.8750000000000071E0,                        0,                        0,    0.93749999999999789E0},
+  { 3, 7,                        0,    0.99999999999999956E0,    -3.9374999999999991E0,                        0},
+  { 3, 6,    -3.7499999999999960E0,                        0,                        0,   -0.87500000000000000E0},
+  { 3, 5,                        0,   -0.99999999999999978E0,     2.8750000000000018E0,                        0},
+  { 3, 4,     3.0000000000000000E0,                        0,                        0,    0.83333333333333315E0},
+  { 3, 3,                        0,     1.3333333333333335E0,    -2.1666666666666665E0,                        0},
+  { 3, 2,    -2.0000000000000000E0,                        0,                        0,   -0.99999999999999978E0},
+  { 3, 1,                        0,                        0,    0.99999999999999989E0,                        0},
+  { 2,19,                        0,   -0.19638061523437358E0,     1.8702095433285431E0,                        0},
+  { 2,18,     1.8830718994140703E0,                        0,                        0,    0.19638061523437528E0},
+  { 2,17,                        0,    0.20947265625000105E0,    -1.7859084185432046E0,                        0},
+  { 2,16,    -1.8016662597656286E0,                        0,                        0,   -0.20947265624999981E0},
+  { 2,15,                        0,   -0.22558593750000033E0,     1.6983398437500079E0,                        0},
+  { 2,14,     1.7182617187499967E0,                        0,                        0,    0.22558593749999961E0},
+  { 2,13,                        0,    0.24609375000000039E0,    -1.6074969951923110E0,                        0},
+  { 2,12,    -1.6337890624999951E0,                        0,                        0,   -0.24609374999999983E0},
+  { 2,11,                        0,   -0.27343749999999939E0,     1.5138494318181845E0,                        0},
+  { 2,10,     1.5507812499999964E0,                        0,                        0,    0.27343749999999983E0},
+  { 2, 9,                        0,    0.31249999999999933E0,    -1.4192708333333357E0,                        0},
+  { 2, 8,    -1.4765624999999996E0,                        0,                        0,   -0.31249999999999978E0},
+  { 2, 7,                        0,   -0.37500000000000000E0,     1.3303571428571415E0,                        0},
+  { 2, 6,     1.4375000000000009E0,                        0,                        0,    0.37499999999999994E0},
+  { 2, 5,                        0,    0.49999999999999989E0,    -1.2750000000000001E0,                        0},
+  { 2, 4,    -1.6250000000000000E0,                        0,                        0,   -0.50000000000000011E0},
+  { 2, 3,                        0,   -0.99999999999999978E0,     1.5000000000000002E0,                        0},
+  { 2, 2,     1.4999999999999998E0,                        0,                        0,     1.0000000000000000E0},
+  { 2, 1,                        0,                        0,    -1.0000000000000000E0,                        0},
+  { 2, 0,     1.0000000000000000E0,                        0,                        0,     1.0000000000000000E0},
+  { 1,20,    0.18702095433285432E0,                        0,                        0,  1.8547058105468611E-002},
+  { 1,19,                        0,  2.0671643708881610E-002,   -0.18719321803042849E0,                        0},
+  { 1,18,   -0.19843426872702274E0,                        0,                        0, -2.1820068359375101E-002},
+  { 1,17,                        0, -2.4643841911764684E-002,    0.19869097541360337E0,                        0},
+  { 1,16,    0.21229248046875099E0,                        0,                        0,  2.6184082031250042E-002},
+  { 1,15,                        0,  3.0078124999999949E-002,   -0.21269531249999951E0,                        0},
+  { 1,14,   -0.22964242788461586E0,                        0,                        0, -3.2226562500000069E-002},
+  { 1,13,                        0, -3.7860576923076900E-002,    0.23031850961538394E0,                        0},
+  { 1,12,    0.25230823863636409E0,                        0,                        0,  4.1015624999999910E-002},
+  { 1,11,                        0,  4.9715909090909061E-002,   -0.25355113636363569E0,                        0},
+  { 1,10,   -0.28385416666666713E0,                        0,                        0, -5.4687499999999854E-002},
+  { 1, 9,                        0, -6.9444444444444392E-002,    0.28645833333333326E0,                        0},
+  { 1, 8,    0.33258928571428537E0,                        0,                        0,  7.8125000000000000E-002},
+  { 1, 7,                        0,    0.10714285714285712E0,   -0.33928571428571463E0,                        0},
+  { 1, 6,   -0.42500000000000004E0,                        0,                        0,   -0.12500000000000000E0},
+  { 1, 5,                        0,   -0.20000000000000004E0,    0.44999999999999990E0,                        0},
+  { 1, 4,    0.75000000000000011E0,                        0,                        0,    0.24999999999999997E0},
+  { 1, 3,                        0,    0.66666666666666663E0,    -1.0000000000000000E0,                        0},
+  { 1, 2,    -1.0000000000000000E0,                        0,                        0,    -1.0000000000000000E0},
+  { 1, 1,                        0,     2.0000000000000000E0,    -2.0000000000000000E0,                        0},
+  { 0,21,                        0,  8.8319324311755300E-004, -8.4600615919682483E-003,                        0},
+  { 0,20, -9.3596609015214240E-003,                        0,                        0, -9.7616095291940712E-004},
+  { 0,19,                        0, -1.1484246504934264E-003,  9.8629411160023640E-003,                        0},
+  { 0,18,  1.1038387522977965E-002,                        0,                        0,  1.2835334329044073E-003},
+  { 0,17,                        0,  1.5402401194852967E-003, -1.1705824908088309E-002,                        0},
+  { 0,16, -1.3293457031249969E-002,                        0,                        0, -1.7456054687499990E-003},
+  { 0,15,                        0, -2.1484375000000045E-003,  1.4212740384615407E-002,                        0},
+  { 0,14,  1.6451322115384567E-002,                        0,                        0,  2.4789663461538456E-003},
+  { 0,13,                        0,  3.1550480769230701E-003, -1.7782998251748304E-002,                        0},
+  { 0,12, -2.1129261363636305E-002,                        0,                        0, -3.7286931818181759E-003},
+  { 0,11,                        0, -4.9715909090908960E-003,  2.3200757575757618E-002,                        0},
+  { 0,10,  2.8645833333333329E-002,                        0,                        0,  6.0763888888888864E-003},
+  { 0, 9,                        0,  8.6805555555555559E-003, -3.2242063492063433E-002,                        0},
+  { 0, 8, -4.2410714285714329E-002,                        0,                        0, -1.1160714285714281E-002},
+  { 0, 7,                        0, -1.7857142857142856E-002,  5.0000000000000003E-002,                        0},
+  { 0, 6,  7.4999999999999983E-002,                        0,                        0,  2.4999999999999998E-002},
+  { 0, 5,                        0,  4.9999999999999996E-002,   -0.10000000000000002E0,                        0},
+  { 0, 4,   -0.25000000000000000E0,                        0,                        0, -8.3333333333333343E-002},
+  { 0, 3,                        0,   -0.33333333333333331E0,    0.66666666666666663E0,                        0},
+  { 0, 2,    -1.0000000000000000E0,                        0,                        0,    -1.0000000000000000E0},
+  {20, 1,                        0,                        0,     1.0000000000000009E0,                        0},
+  {19, 2,     10.000000000000009E0,                        0,                        0,     1.5000000000000007E0},
+  {19, 1,                        0,                        0,   -0.99999999999999933E0,                        0},
+  {18, 3,                        0,     9.5000000000000036E0,    -33.166666666666728E0,                        0},
+  {18, 2,    -9.4999999999999929E0,                        0,                        0,    -1.4999999999999996E0},
+  {18, 1,                        0,                        0,     1.0000000000000002E0,                        0},
+  {17, 4,    -149.25000000000028E0,                        0,                        0,    -21.750000000000025E0},
+  {17, 3,                        0,    -8.9999999999999982E0,     29.999999999999964E0,                        0},
+  {17, 2,     9.0000000000000018E0,                        0,                        0,     1.5000000000000007E0},
+  {17, 1,                        0,                        0,   -0.99999999999999989E0,                        0},
+  {16, 5,                        0,    -73.950000000000088E0,     374.85000000000099E0,                        0},
+  {16, 4,     127.49999999999984E0,                        0,                        0,     19.499999999999996E0},
+  {16, 3,                        0,     8.5000000000000036E0,    -27.000000000000011E0,                        0},
+  {16, 2,    -8.4999999999999982E0,                        0,                        0,    -1.5000000000000004E0},
+  {16, 1,                        0,                        0,    0.99999999999999978E0,                        0},
+  {15, 6,     999.60000000000264E0,                        0,                        0,     147.05000000000024E0},
+  {15, 5,                        0,     62.399999999999991E0,    -300.89999999999947E0,                        0},
+  {15, 4,    -108.00000000000004E0,                        0,                        0,    -17.375000000000014E0},
+  {15, 3,                        0,    -8.0000000000000018E0,     24.166666666666661E0,                        0},
+  {15, 2,     7.9999999999999982E0,                        0,                        0,     1.4999999999999996E0},
+  {15, 1,                        0,                        0,    -1.0000000000000000E0,                        0},
+  {14, 7,                        0,     315.10714285714340E0,    -1779.5357142857201E0,                        0},
+  {14, 6,    -752.24999999999875E0,                        0,                        0,    -116.24999999999996E0},
+  {14, 5,                        0,    -52.125000000000043E0,     238.50000000000009E0,                        0},
+  {14, 4,     90.624999999999972E0,                        0,                        0,     15.375000000000007E0},
+  {14, 3,                        0,     7.4999999999999982E0,    -21.499999999999986E0,                        0},
+  {14, 2,    -7.5000000000000000E0,                        0,                        0,    -1.4999999999999996E0},
+  {14, 1,                        0,                        0,     1.0000000000000000E0,                        0},
+  {13, 8,    -3114.1875000000100E0,                        0,                        0,    -459.00000000000085E0},
+  {13, 7,                        0,    -232.49999999999991E0,     1249.4999999999975E0,                        0},
+  {13, 6,     556.50000000000023E0,                        0,                        0,     90.562500000000085E0},
+  {13, 5,                        0,     43.050000000000018E0,    -186.37499999999994E0,                        0},
+  {13, 4,    -75.249999999999943E0,                        0,                        0,    -13.499999999999998E0},
+  {13, 3,                        0,    -6.9999999999999973E0,     19.000000000000000E0,                        0},
+  {13, 2,     7.0000000000000000E0,                        0,                        0,     1.5000000000000007E0},
+  {13, 1,                        0,                        0,    -1.0000000000000000E0,                        0},
+  {12, 9,                        0,    -663.00000000000125E0,     3930.8072916666824E0,                        0},
+  {12, 8,     2030.4374999999959E0,                        0,                        0,     314.43749999999983E0},
+  {12, 7,                        0,     168.18750000000017E0,    -858.00000000000068E0,                        0},
+  {12, 6,    -403.81249999999989E0,                        0,                        0,    -69.387500000000060E0},
+  {12, 5,                        0,    -35.099999999999994E0,     143.32499999999987E0,                        0},
+  {12, 4,     61.750000000000000E0,                        0,                        0,     11.749999999999996E0},
+  {12, 3,                        0,     6.5000000000000027E0,    -16.666666666666664E0,                        0},
+  {12, 2,    -6.5000000000000000E0,                        0,                        0,    -1.5000000000000000E0},
+  {12, 1,                        0,                        0,     1.0000000000000000E0,                        0},
+  {11,10,     4716.9687500000182E0,                        0,                        0,     695.80468750000148E0},
+  {11, 9,                        0,     419.24999999999977E0,    -2365.3906249999945E0,                        0},
+  {11, 8,    -1287.0000000000009E0,                        0,                        0,    -209.92968750000023E0},
+  {11, 7,                        0,    -118.95000000000010E0,     574.43749999999989E0,                        0},
+  {11, 6,     286.64999999999975E0,                        0,                        0,     52.162499999999994E0},
+  {11, 5,                        0,     28.199999999999989E0,    -108.22499999999999E0,                        0},
+  {11, 4,    -49.999999999999993E0,                        0,                        0,    -10.125000000000007E0},
+  {11, 3,                        0,    -6.0000000000000000E0,     14.500000000000004E0,                        0},
+  {11, 2,     6.0000000000000000E0,                        0,                        0,     1.4999999999999993E0},
+  {11, 1,                        0,                        0,    -1.0000000000000000E0,                        0},
+  {10,11,                        0,     695.80468750000148E0,    -4242.1640625000191E0,                        0},
+  {10,10,    -2601.9296874999941E0,                        0,                        0,    -403.30468749999966E0},
+  {10, 9,                        0,    -256.58072916666691E0,     1374.1406250000014E0,                        0},
+  {10, 8,     789.85156249999989E0,                        0,                        0,     136.07343750000013E0},
+  {10, 7,                        0,     81.969642857142844E0,    -373.58749999999958E0,                        0},
+  {10, 6,    -198.41249999999997E0,                        0,                        0,    -38.362499999999983E0},
+  {10, 5,                        0,    -22.275000000000013E0,     80.025000000000006E0,                        0},
+  {10, 4,     39.875000000000007E0,                        0,                        0,     8.6250000000000053E0},
+  {10, 3,                        0,     5.4999999999999973E0,    -12.500000000000000E0,                        0},
+  {10, 2,    -5.5000000000000000E0,                        0,                        0,    -1.4999999999999993E0},
+  {10, 1,                        0,                        0,     1.0000000000000000E0,                        0},
+  { 9,12,    -3535.1367187500159E0,                        0,                        0,    -521.70963541666788E0},
+  { 9,11,                        0,    -366.64062499999972E0,     2127.1249999999945E0,                        0},
+  { 9,10,     1374.1406250000014E0,                        0,                        0,     224.36848958333357E0},
+  { 9, 9,                        0,     151.19270833333346E0,    -766.51475694444434E0,                        0},
+  { 9, 8,    -466.98437499999949E0,                        0,                        0,    -85.225446428571388E0},
+  { 9, 7,                        0,    -54.803571428571402E0,     234.92857142857139E0,                        0},
+  { 9, 6,     133.37500000000000E0,                        0,                        0,     27.500000000000028E0},
+  { 9, 5,                        0,     17.250000000000011E0,    -57.750000000000014E0,                        0},
+  { 9, 4,    -31.250000000000000E0,                        0,                        0,    -7.2499999999999947E0},
+  { 9, 3,                        0,    -4.9999999999999982E0,     10.666666666666670E0,                        0},
+  { 9, 2,     5.0000000000000000E0,                        0,                        0,     1.4999999999999996E0},
+  { 9, 1,                        0,                        0,    -1.0000000000000000E0,                        0},
+  { 8,13,                        0,    -361.18359375000080E0,     2242.4062500000109E0,                        0},
+  { 8,12,     1595.3437499999959E0,                        0,                        0,     247.40624999999977E0},
+  { 8,11,                        0,     183.57421875000020E0,    -1010.9531250000010E0,                        0},
+  { 8,10,    -689.86328124999989E0,                        0,                        0,    -118.98046875000011E0},
+  { 8, 9,                        0,    -85.225446428571388E0,     407.77343749999949E0,                        0},
+  { 8, 8,     264.29464285714283E0,                        0,                        0,     51.267857142857103E0},
+  { 8, 7,                        0,     35.357142857142890E0,    -142.01785714285711E0,                        0},
+  { 8, 6,    -86.625000000000014E0,                        0,                        0,    -19.125000000000018E0},
+  { 8, 5,                        0,    -13.049999999999990E0,     40.499999999999993E0,                        0},
+  { 8, 4,     24.000000000000007E0,                        0,                        0,     5.9999999999999956E0},
+  { 8, 3,                        0,     4.4999999999999982E0,    -9.0000000000000000E0,                        0},
+  { 8, 2,    -4.5000000000000000E0,                        0,                        0,    -1.5000000000000000E0},
+  { 8, 1,                        0,                        0,     1.0000000000000004E0,                        0},
+  { 7,14,     1281.3750000000064E0,                        0,                        0,     189.15820312500043E0},
+  { 7,13,                        0,     152.24999999999986E0,    -899.47265624999739E0,                        0},
+  { 7,12,    -673.96875000000068E0,                        0,                        0,    -110.10644531250016E0},
+  { 7,11,                        0,    -86.531250000000085E0,     451.08984375000000E0,                        0},
+  { 7,10,     326.21874999999960E0,                        0,                        0,     59.609933035714285E0},
+  { 7, 9,                        0,     45.571428571428534E0,    -205.08370535714280E0,                        0},
+  { 7, 8,    -142.01785714285711E0,                        0,                        0,    -29.390625000000036E0},
+  { 7, 7,                        0,    -21.857142857142879E0,     81.910714285714292E0,                        0},
+  { 7, 6,     53.999999999999993E0,                        0,                        0,     12.824999999999985E0},
+  { 7, 5,                        0,     9.5999999999999925E0,    -27.450000000000010E0,                        0},
+  { 7, 4,    -18.000000000000000E0,                        0,                        0,    -4.8749999999999982E0},
+  { 7, 3,                        0,    -4.0000000000000000E0,     7.4999999999999982E0,                        0},
+  { 7, 2,     4.0000000000000018E0,                        0,                        0,     1.5000000000000000E0},
+  { 7, 1,                        0,                        0,    -1.0000000000000000E0,                        0},
+  { 6,15,                        0,     88.273828125000207E0,    -555.08320312500302E0,                        0},
+  { 6,14,    -449.73632812499869E0,                        0,                        0,    -69.767578124999929E0},
+  { 6,13,                        0,    -59.288085937500085E0,     332.47265625000034E0,                        0},
+  { 6,12,     263.13574218750000E0,                        0,                        0,     45.411132812500043E0},
+  { 6,11,                        0,     37.933593750000000E0,    -186.62109374999974E0,                        0},
+  { 6,10,    -143.55859374999997E0,                        0,                        0,    -27.886718749999972E0},
+  { 6, 9,                        0,    -22.859375000000028E0,     96.393229166666657E0,                        0},
+  { 6, 8,     71.671875000000000E0,                        0,                        0,     15.890625000000025E0},
+  { 6, 7,                        0,     12.824999999999985E0,    -44.624999999999993E0,                        0},
+  { 6, 6,    -32.025000000000013E0,                        0,                        0,    -8.2249999999999925E0},
+  { 6, 5,                        0,    -6.8249999999999975E0,     17.850000000000001E0,                        0},
+  { 6, 4,     13.124999999999996E0,                        0,                        0,     3.8750000000000009E0},
+  { 6, 3,                        0,     3.5000000000000000E0,    -6.1666666666666714E0,                        0},
+  { 6, 2,    -3.5000000000000000E0,                        0,                        0,    -1.4999999999999993E0},
+  { 6, 1,                        0,                        0,     1.0000000000000000E0,                        0},
+  { 5,16,    -208.15620117187615E0,                        0,                        0,    -30.734472656250087E0},
+  { 5,15,                        0,    -27.907031249999967E0,     166.98515624999948E0,                        0},
+  { 5,14,     142.48828125000014E0,                        0,                        0,     23.286621093750032E0},
+  { 5,13,                        0,     20.958984375000021E0,    -111.25488281250001E0,                        0},
+  { 5,12,    -93.310546874999872E0,                        0,                        0,    -17.062500000000000E0},
+  { 5,11,                        0,    -15.210937499999984E0,     70.382812499999972E0,                        0},
+  { 5,10,     57.835937500000000E0,                        0,                        0,     11.988281250000014E0},
+  { 5, 9,                        0,     10.593750000000016E0,    -41.679687500000007E0,                        0},
+  { 5, 8,    -33.468749999999993E0,                        0,                        0,    -7.9874999999999909E0},
+  { 5, 7,                        0,    -7.0499999999999936E0,     22.650000000000013E0,                        0},
+  { 5, 6,     17.850000000000001E0,                        0,                        0,     4.9874999999999972E0},
+  { 5, 5,                        0,     4.6500000000000004E0,    -11.024999999999995E0,                        0},
+  { 5, 4,    -9.2500000000000071E0,                        0,                        0,    -3.0000000000000009E0},
+  { 5, 3,                        0,    -2.9999999999999987E0,     5.0000000000000009E0,                        0},
+  { 5, 2,     3.0000000000000000E0,                        0,                        0,     1.5000000000000000E0},
+  { 5, 1,                        0,                        0,    -1.0000000000000000E0,                        0},
+  { 4,17,                        0,    -9.0395507812500249E0,     57.382415771484709E0,                        0},
+  { 4,16,     52.182861328124837E0,                        0,                        0,     8.0969238281249893E0},
+  { 4,15,                        0,     7.7622070312500107E0,    -44.085937500000057E0,                        0},
+  { 4,14,    -39.733886718750007E0,                        0,                        0,    -6.8598632812500089E0},
+  { 4,13,                        0,    -6.5625000000000000E0,     32.874023437499950E0,                        0},
+  { 4,12,     29.326171874999993E0,                        0,                        0,     5.7011718749999929E0},
+  { 4,11,                        0,     5.4492187500000071E0,    -23.624999999999993E0,                        0},
+  { 4,10,    -20.839843750000004E0,                        0,                        0,    -4.6289062500000080E0},
+  { 4, 9,                        0,    -4.4374999999999947E0,     16.210937499999993E0,                        0},
+  { 4, 8,     14.156250000000007E0,                        0,                        0,     3.6562499999999960E0},
+  { 4, 7,                        0,     3.5624999999999978E0,    -10.500000000000000E0,                        0},
+  { 4, 6,    -9.1874999999999947E0,                        0,                        0,    -2.8125000000000018E0},
+  { 4, 5,                        0,    -3.0000000000000009E0,     6.3750000000000071E0,                        0},
+  { 4, 4,     6.2500000000000009E0,                        0,                        0,     2.2499999999999991E0},
+  { 4, 3,                        0,     2.5000000000000000E0,    -4.0000000000000009E0,                        0},
+  { 4, 2,    -2.5000000000000000E0,                        0,                        0,    -1.5000000000000000E0},
+  { 4, 1,                        0,                        0,     1.0000000000000000E0,                        0},
+  { 3,18,     12.751647949218825E0,                        0,                        0,     1.8830718994140678E0},
+  { 3,17,                        0,     1.9051585477941151E0,    -11.507904052734336E0,                        0},
+  { 3,16,    -11.021484375000014E0,                        0,                        0,    -1.8016662597656274E0},
+  { 3,15,                        0,    -1.8292968750000023E0,     9.8344726562500000E0,                        0},
+  { 3,14,     9.3925781249999858E0,                        0,                        0,     1.7182617187500000E0},
+  { 3,13,                        0,     1.7542067307692286E0,    -8.2646484374999964E0,                        0},
+  { 3,12,    -7.8749999999999982E0,                        0,                        0,    -1.6337890625000020E0},
+  { 3,11,                        0,    -1.6832386363636394E0,     6.8085937500000027E0,                        0},
+  { 3,10,     6.4843749999999973E0,                        0,                        0,     1.5507812499999982E0},
+  { 3, 9,                        0,     1.6249999999999982E0,    -5.4817708333333348E0,                        0},
+  { 3, 8,    -5.2500000000000000E0,                        0,                        0,    -1.4765624999999984E0},
+  { 3, 7,                        0,    -1.6071428571428581E0,     4.3124999999999973E0,                        0},
+  { 3, 6,     4.2500000000000044E0,                        0,                        0,     1.4375000000000004E0},
+  { 3, 5,                        0,     1.7999999999999992E0,    -3.3750000000000000E0,                        0},
+  { 3, 4,    -4.0000000000000009E0,                        0,                        0,    -1.6250000000000004E0},
+  { 3, 3,                        0,    -2.0000000000000000E0,     3.1666666666666670E0,                        0},
+  { 3, 2,     2.0000000000000000E0,                        0,                        0,     1.5000000000000000E0},
+  { 3, 1,                        0,                        0,    -1.0000000000000000E0,                        0},
+  { 3, 0,     1.0000000000000000E0,                        0,                        0,     1.0000000000000000E0},
+  { 2,19,                        0,    0.29732714201274757E0,    -1.9012170088918707E0,                        0},
+  { 2,18,    -1.9179840087890558E0,                        0,                        0,   -0.29765140309053256E0},
+  { 2,17,                        0,   -0.31794110466452252E0,     1.8228741814108478E0,                        0},
+  { 2,16,     1.8439636230468750E0,                        0,                        0,    0.31843872070312534E0},
+  { 2,15,                        0,    0.34365234374999998E0,    -1.7434570312499975E0,                        0},
+  { 2,14,    -1.7709960937499993E0,                        0,                        0,   -0.34446364182692252E0},
+  { 2,13,                        0,   -0.37702824519230815E0,     1.6642878605769227E0,                        0},
+  { 2,12,     1.7021484375000007E0,                        0,                        0,    0.37846235795454647E0},
+  { 2,11,                        0,    0.42294034090909044E0,    -1.5884232954545454E0,                        0},
+  { 2,10,    -1.6445312500000004E0,                        0,                        0,   -0.42578124999999944E0},
+  { 2, 9,                        0,   -0.49218749999999950E0,     1.5234375000000000E0,                        0},
+  { 2, 8,     1.6171874999999991E0,                        0,                        0,    0.49888392857142871E0},
+  { 2, 7,                        0,    0.61607142857142871E0,    -1.4910714285714306E0,                        0},
+  { 2, 6,    -1.6875000000000000E0,                        0,                        0,   -0.63749999999999973E0},
+  { 2, 5,                        0,   -0.97500000000000020E0,     1.5750000000000004E0,                        0},
+  { 2, 4,     2.3750000000000000E0,                        0,                        0,     1.1250000000000000E0},
+  { 2, 3,                        0,     1.5000000000000000E0,    -2.5000000000000000E0,                        0},
+  { 2, 2,    -1.5000000000000000E0,                        0,                        0,    -1.5000000000000000E0},
+  { 2, 1,                        0,     3.0000000000000000E0,    -3.0000000000000000E0,                        0},
+  { 1,20,   -0.19012170088918706E0,                        0,                        0, -2.8078982704564253E-002},
+  { 1,19,                        0, -3.1331726641108691E-002,    0.19063849198190724E0,                        0},
+  { 1,18,    0.20254157571231643E0,                        0,                        0,  3.3115162568933876E-002},
+  { 1,17,                        0,  3.7463378906250039E-002,   -0.20331169577205882E0,                        0},
+  { 1,16,   -0.21793212890624969E0,                        0,                        0, -3.9880371093749971E-002},
+  { 1,15,                        0, -4.5928485576923000E-002,    0.21914062499999992E0,                        0},
+  { 1,14,    0.23775540865384609E0,                        0,                        0,  4.9353966346153889E-002},
+  { 1,13,                        0,  5.8224978146853304E-002,   -0.23978365384615391E0,                        0},
+  { 1,12,   -0.26473721590909088E0,                        0,                        0, -6.3387784090908963E-002},
+  { 1,11,                        0, -7.7414772727272624E-002,    0.26846590909090923E0,                        0},
+  { 1,10,    0.30468750000000000E0,                        0,                        0,  8.5937499999999944E-002},
+  { 1, 9,                        0,    0.11086309523809527E0,   -0.31249999999999967E0,                        0},
+  { 1, 8,   -0.37276785714285765E0,                        0,                        0,   -0.12723214285714293E0},
+  { 1, 7,                        0,   -0.18214285714285708E0,    0.39285714285714296E0,                        0},
+  { 1, 6,    0.52500000000000013E0,                        0,                        0,    0.22500000000000003E0},
+  { 1, 5,                        0,    0.44999999999999996E0,   -0.59999999999999998E0,                        0},
+  { 1, 4,    -1.2500000000000000E0,                        0,                        0,   -0.75000000000000011E0},
+  { 1, 3,                        0,    -1.0000000000000000E0,     2.0000000000000000E0,                        0},
+  { 1, 2,    -3.0000000000000000E0,                        0,                        0,    -3.0000000000000000E0},
+  { 0,21,                        0, -1.3370944145030597E-003,  8.5995131566710230E-003,                        0},
+  { 0,20,  9.5319245990953625E-003,                        0,                        0,  1.4794411674003448E-003},
+  { 0,19,                        0,  1.7429032931017829E-003, -1.0065604289618800E-002,                        0},
+  { 0,18, -1.1295094209558824E-002,                        0,                        0, -1.9509708180147009E-003},
+  { 0,17,                        0, -2.3459041819852925E-003,  1.2013872931985276E-002,                        0},
+  { 0,16,  1.3696289062499995E-002,                        0,                        0,  2.6648888221153751E-003},
+  { 0,15,                        0,  3.2902644230769261E-003, -1.4708533653846148E-002,                        0},
+  { 0,14, -1.7127403846153851E-002,                        0,                        0, -3.8106424825174912E-003},
+  { 0,13,                        0, -4.8759833916083815E-003,  1.8643465909090908E-002,                        0},
+  { 0,12,  2.2372159090909102E-002,                        0,                        0,  5.8001893939393905E-003},
+  { 0,11,                        0,  7.8124999999999948E-003, -2.4857954545454537E-002,                        0},
+  { 0,10, -3.1249999999999965E-002,                        0,                        0, -9.6726190476190549E-003},
+  { 0, 9,                        0, -1.4136904761904769E-002,  3.5962301587301654E-002,                        0},
+  { 0, 8,  4.9107142857142870E-002,                        0,                        0,  1.8749999999999989E-002},
+  { 0, 7,                        0,  3.2142857142857147E-002, -6.0714285714285741E-002,                        0},
+  { 0, 6, -9.9999999999999992E-002,                        0,                        0, -4.9999999999999989E-002},
+  { 0, 5,                        0,   -0.15000000000000002E0,    0.14999999999999999E0,                        0},
+  { 0, 4,    0.50000000000000000E0,                        0,                        0,    0.50000000000000000E0},
+  { 0, 3,                        0,    -1.0000000000000000E0,     1.0000000000000000E0,                        0},
+  {20, 1,                        0,                        0,   -0.99999999999999989E0,                        0},
+  {19, 2,    -9.9999999999999982E0,                        0,                        0,    -1.9999999999999982E0},
+  {19, 1,                        0,                        0,     1.0000000000000004E0,                        0},
+  {18, 3,                        0,    -12.666666666666655E0,     34.666666666666657E0,                        0},
+  {18, 2,     9.5000000000000036E0,                        0,                        0,     2.0000000000000000E0},
+  {18, 1,                        0,                        0,   -0.99999999999999956E0,                        0},
+  {17, 4,     155.99999999999994E0,                        0,                        0,     29.999999999999947E0},
+  {17, 3,                        0,     12.000000000000002E0,    -31.500000000000028E0,                        0},
+  {17, 2,    -8.9999999999999964E0,                        0,                        0,    -2.0000000000000018E0},
+  {17, 1,                        0,                        0,    0.99999999999999900E0,                        0},
+  {16, 5,                        0,     101.99999999999982E0,    -386.69999999999982E0,                        0},
+  {16, 4,    -133.87500000000011E0,                        0,                        0,    -27.000000000000007E0},
+  {16, 3,                        0,    -11.333333333333343E0,     28.499999999999979E0,                        0},
+  {16, 2,     8.4999999999999911E0,                        0,                        0,     1.9999999999999989E0},
+  {16, 1,                        0,                        0,    -1.0000000000000000E0,                        0},
+  {15, 6,    -1031.1999999999996E0,                        0,                        0,    -200.59999999999945E0},
+  {15, 5,                        0,    -86.400000000000020E0,     311.47500000000042E0,                        0},
+  {15, 4,     113.99999999999991E0,                        0,                        0,     24.166666666666710E0},
+  {15, 3,                        0,     10.666666666666661E0,    -25.666666666666618E0,                        0},
+  {15, 2,    -8.0000000000000000E0,                        0,                        0,    -1.9999999999999996E0},
+  {15, 1,                        0,                        0,    0.99999999999999956E0,                        0},
+  {14, 7,                        0,    -429.85714285714170E0,     1829.7857142857135E0,                        0},
+  {14, 6,     778.68750000000114E0,                        0,                        0,     159.00000000000003E0},
+  {14, 5,                        0,     72.500000000000128E0,    -247.87499999999977E0,                        0},
+  {14, 4,    -96.249999999999815E0,                        0,                        0,    -21.499999999999968E0},
+  {14, 3,                        0,    -9.9999999999999982E0,     22.999999999999993E0,                        0},
+  {14, 2,     7.4999999999999964E0,                        0,                        0,     1.9999999999999996E0},
+  {14, 1,                        0,                        0,    -1.0000000000000007E0,                        0},
+  {13, 8,     3202.1249999999986E0,                        0,                        0,     624.74999999999818E0},
+  {13, 7,                        0,     318.00000000000006E0,    -1288.6875000000025E0,                        0},
+  {13, 6,    -578.37499999999955E0,                        0,                        0,    -124.25000000000030E0},
+  {13, 5,                        0,    -60.199999999999910E0,     194.62499999999949E0,                        0},
+  {13, 4,     80.499999999999972E0,                        0,                        0,     18.999999999999986E0},
+  {13, 3,                        0,     9.3333333333333321E0,    -20.499999999999982E0,                        0},
+  {13, 2,    -7.0000000000000044E0,                        0,                        0,    -2.0000000000000004E0},
+  {13, 1,                        0,                        0,     1.0000000000000000E0,                        0},
+  {12, 9,                        0,     902.41666666666401E0,    -4036.4322916666642E0,                        0},
+  {12, 8,    -2094.1171875000041E0,                        0,                        0,    -429.00000000000017E0},
+  {12, 7,                        0,    -230.75000000000057E0,     888.06249999999920E0,                        0},
+  {12, 6,     421.68749999999886E0,                        0,                        0,     95.549999999999841E0},
+  {12, 5,                        0,     49.399999999999963E0,    -150.52499999999995E0,                        0},
+  {12, 4,    -66.624999999999943E0,                        0,                        0,    -16.666666666666661E0},
+  {12, 3,                        0,    -8.6666666666666696E0,     18.166666666666686E0,                        0},
+  {12, 2,     6.5000000000000000E0,                        0,                        0,     1.9999999999999996E0},
+  {12, 1,                        0,                        0,    -1.0000000000000004E0,                        0},
+  {11,10,    -4843.7187499999964E0,                        0,                        0,    -946.15624999999670E0},
+  {11, 9,                        0,    -572.00000000000023E0,     2435.9765625000059E0,                        0},
+  {11, 8,     1332.0937499999989E0,                        0,                        0,     287.21875000000097E0},
+  {11, 7,                        0,     163.79999999999973E0,    -597.07142857142674E0,                        0},
+  {11, 6,    -301.04999999999990E0,                        0,                        0,    -72.149999999999935E0},
+  {11, 5,                        0,    -39.999999999999986E0,     114.44999999999985E0,                        0},
+  {11, 4,     54.500000000000057E0,                        0,                        0,     14.500000000000009E0},
+  {11, 3,                        0,     7.9999999999999982E0,    -16.000000000000000E0,                        0},
+  {11, 2,    -6.0000000000000027E0,                        0,                        0,    -2.0000000000000009E0},
+  {11, 1,                        0,                        0,    0.99999999999999989E0,                        0},
+  {10,11,                        0,    -946.15624999999670E0,     4352.9687499999973E0,                        0},
+  {10,10,     2679.5742187500064E0,                        0,                        0,     549.65625000000023E0},
+  {10, 9,                        0,     351.04513888889005E0,    -1419.9453124999991E0,                        0},
+  {10, 8,    -820.97321428571172E0,                        0,                        0,    -186.79374999999962E0},
+  {10, 7,                        0,    -113.37857142857133E0,     390.26428571428562E0,                        0},
+  {10, 6,     209.82499999999970E0,                        0,                        0,     53.349999999999973E0},
+  {10, 5,                        0,     31.900000000000020E0,    -85.350000000000108E0,                        0},
+  {10, 4,    -44.000000000000000E0,                        0,                        0,    -12.499999999999993E0},
+  {10, 3,                        0,    -7.3333333333333366E0,     14.000000000000007E0,                        0},
+  {10, 2,     5.4999999999999991E0,                        0,                        0,     2.0000000000000000E0},
+  {10, 1,                        0,                        0,    -1.0000000000000002E0,                        0},
+  { 9,12,     3627.4739583333308E0,                        0,                        0,     709.04166666666379E0},
+  { 9,11,                        0,     499.68750000000023E0,    -2188.8242187500059E0,                        0},
+  { 9,10,    -1419.9453124999991E0,                        0,                        0,    -306.60590277777897E0},
+  { 9, 9,                        0,    -207.54861111111069E0,     795.24243551587028E0,                        0},
+  { 9, 8,     487.83035714285700E0,                        0,                        0,     117.46428571428557E0},
+  { 9, 7,                        0,     76.214285714285680E0,    -246.91071428571388E0,                        0},
+  { 9, 6,    -142.25000000000017E0,                        0,                        0,    -38.500000000000021E0},
+  { 9, 5,                        0,    -24.999999999999986E0,     62.250000000000014E0,                        0},
+  { 9, 4,     35.000000000000014E0,                        0,                        0,     10.666666666666675E0},
+  { 9, 3,                        0,     6.6666666666666679E0,    -12.166666666666664E0,                        0},
+  { 9, 2,    -5.0000000000000009E0,                        0,                        0,    -2.0000000000000000E0},
+  { 9, 1,                        0,                        0,     1.0000000000000000E0,                        0},
+  { 8,13,                        0,     490.87499999999801E0,    -2299.9101562499982E0,                        0},
+  { 8,12,    -1641.6181640625045E0,                        0,                        0,    -336.98437500000000E0},
+  { 8,11,                        0,    -250.85937500000097E0,     1043.7070312499995E0,                        0},
+  { 8,10,     715.71819196428328E0,                        0,                        0,     163.10937499999963E0},
+  { 8, 9,                        0,     117.46428571428557E0,    -425.08370535714272E0,                        0},
+  { 8, 8,    -277.77455357142810E0,                        0,                        0,    -71.008928571428527E0},
+  { 8, 7,                        0,    -49.500000000000021E0,     150.37500000000023E0,                        0},
+  { 8, 6,     93.375000000000014E0,                        0,                        0,     26.999999999999979E0},
+  { 8, 5,                        0,     19.200000000000017E0,    -44.250000000000028E0,                        0},
+  { 8, 4,    -27.374999999999993E0,                        0,                        0,    -9.0000000000000018E0},
+  { 8, 3,                        0,    -6.0000000000000009E0,     10.500000000000004E0,                        0},
+  { 8, 2,     4.5000000000000000E0,                        0,                        0,     2.0000000000000000E0},
+  { 8, 1,                        0,                        0,    -1.0000000000000000E0,                        0},
+  { 7,14,    -1314.2343749999991E0,                        0,                        0,    -256.99218749999881E0},
+  { 7,13,                        0,    -207.37500000000000E0,     925.08691406250273E0,                        0},
+  { 7,12,     695.80468749999966E0,                        0,                        0,     150.36328125000068E0},
+  { 7,11,                        0,     118.62499999999973E0,    -467.52120535714113E0,                        0},
+  { 7,10,    -340.06696428571416E0,                        0,                        0,    -82.033482142857039E0},
+  { 7, 9,                        0,    -63.119047619047578E0,     215.02790178571382E0,                        0},
+  { 7, 8,     150.37500000000023E0,                        0,                        0,     40.955357142857174E0},
+  { 7, 7,                        0,     30.857142857142833E0,    -87.535714285714292E0,                        0},
+  { 7, 6,    -59.000000000000043E0,                        0,                        0,    -18.300000000000018E0},
+  { 7, 5,                        0,    -14.400000000000002E0,     30.524999999999999E0,                        0},
+  { 7, 4,     21.000000000000007E0,                        0,                        0,     7.5000000000000018E0},
+  { 7, 3,                        0,     5.3333333333333339E0,    -9.0000000000000018E0,                        0},
+  { 7, 2,    -4.0000000000000000E0,                        0,                        0,    -1.9999999999999996E0},
+  { 7, 1,                        0,                        0,    0.99999999999999978E0,                        0},
+  { 6,15,                        0,    -119.92968749999946E0,     569.13515624999945E0,                        0},
+  { 6,14,     462.54345703125136E0,                        0,                        0,     94.992187499999986E0},
+  { 6,13,                        0,     80.964843750000355E0,    -343.04785156249983E0,                        0},
+  { 6,12,    -272.72070312499898E0,                        0,                        0,    -62.207031249999851E0},
+  { 6,11,                        0,    -52.203124999999929E0,     194.32031249999991E0,                        0},
+  { 6,10,     150.51953124999966E0,                        0,                        0,     38.557291666666629E0},
+  { 6, 9,                        0,     31.854166666666693E0,    -101.78385416666684E0,                        0},
+  { 6, 8,    -76.593750000000000E0,                        0,                        0,    -22.312499999999979E0},
+  { 6, 7,                        0,    -18.300000000000018E0,     48.250000000000043E0,                        0},
+  { 6, 6,     35.612499999999997E0,                        0,                        0,     11.900000000000002E0},
+  { 6, 5,                        0,     10.500000000000004E0,    -20.325000000000010E0,                        0},
+  { 6, 4,    -15.750000000000004E0,                        0,                        0,    -6.1666666666666679E0},
+  { 6, 3,                        0,    -4.6666666666666661E0,     7.6666666666666652E0,                        0},
+  { 6, 2,     3.4999999999999991E0,                        0,                        0,     1.9999999999999996E0},
+  { 6, 1,                        0,                        0,    -1.0000000000000000E0,                        0},
+  { 5,16,     213.42568359374980E0,                        0,                        0,     41.746289062499798E0},
+  { 5,15,                        0,     37.996874999999996E0,    -171.67939453125058E0,                        0},
+  { 5,14,    -147.02050781249994E0,                        0,                        0,    -31.787109375000160E0},
+  { 5,13,                        0,    -28.710937499999929E0,     115.23339843749953E0,                        0},
+  { 5,12,     97.160156249999957E0,                        0,                        0,     23.460937499999964E0},
+  { 5,11,                        0,     21.031249999999979E0,    -73.699218749999815E0,                        0},
+  { 5,10,    -61.070312500000099E0,                        0,                        0,    -16.671875000000021E0},
+  { 5, 9,                        0,    -14.874999999999986E0,     44.398437500000000E0,                        0},
+  { 5, 8,     36.187500000000028E0,                        0,                        0,     11.325000000000012E0},
+  { 5, 7,                        0,     10.200000000000003E0,    -24.862499999999990E0,                        0},
+  { 5, 6,    -20.325000000000010E0,                        0,                        0,    -7.3500000000000014E0},
+  { 5, 5,                        0,    -7.4000000000000021E0,     12.975000000000003E0,                        0},
+  { 5, 4,     11.499999999999998E0,                        0,                        0,     5.0000000000000009E0},
+  { 5, 3,                        0,     3.9999999999999991E0,    -6.4999999999999982E0,                        0},
+  { 5, 2,    -3.0000000000000000E0,                        0,                        0,    -1.9999999999999996E0},
+  { 5, 1,                        0,                        0,     1.0000000000000000E0,                        0},
+  { 4,17,                        0,     12.278320312499940E0,    -58.821237003101942E0,                        0},
+  { 4,16,    -53.649810791015810E0,                        0,                        0,    -11.021484374999996E0},
+  { 4,15,                        0,    -10.595703125000053E0,     45.470214843749993E0,                        0},
+  { 4,14,     41.154785156249829E0,                        0,                        0,     9.3925781249999769E0},
+  { 4,13,                        0,     9.0234374999999858E0,    -34.205453725961533E0,                        0},
+  { 4,12,    -30.708007812499925E0,                        0,                        0,    -7.8749999999999920E0},
+  { 4,11,                        0,    -7.5781250000000089E0,     24.908735795454589E0,                        0},
+  { 4,10,     22.199218750000000E0,                        0,                        0,     6.4843749999999911E0},
+  { 4, 9,                        0,     6.2916666666666732E0,    -17.460937500000018E0,                        0},
+  { 4, 8,    -15.539062499999993E0,                        0,                        0,    -5.2500000000000018E0},
+  { 4, 7,                        0,    -5.2500000000000018E0,     11.758928571428578E0,                        0},
+  { 4, 6,     10.812500000000004E0,                        0,                        0,     4.2500000000000018E0},
+  { 4, 5,                        0,     5.0000000000000009E0,    -7.8749999999999982E0,                        0},
+  { 4, 4,    -8.1249999999999982E0,                        0,                        0,    -3.9999999999999991E0},
+  { 4, 3,                        0,    -3.3333333333333326E0,     5.5000000000000000E0,                        0},
+  { 4, 2,     2.5000000000000000E0,                        0,                        0,     2.0000000000000000E0},
+  { 4, 1,                        0,                        0,    -1.0000000000000002E0,                        0},
+  { 4, 0,     1.0000000000000000E0,                        0,                        0,     1.0000000000000000E0},
+  { 3,18,    -13.071386000689321E0,                        0,                        0,    -2.5573120117187358E0},
+  { 3,17,                        0,    -2.5932904411764697E0,     11.828333237591954E0,                        0},
+  { 3,16,     11.367553710937498E0,                        0,                        0,     2.4586181640625142E0},
+  { 3,15,                        0,     2.5046874999999940E0,    -10.181640624999956E0,                        0},
+  { 3,14,    -9.7729867788461533E0,                        0,                        0,    -2.3613281249999960E0},
+  { 3,13,                        0,    -2.4230769230769207E0,     8.6469350961538201E0,                        0},
+  { 3,12,     8.3029119318181959E0,                        0,                        0,     2.2695312500000031E0},
+  { 3,11,                        0,     2.3579545454545423E0,    -7.2400568181818175E0,                        0},
+  { 3,10,    -6.9843750000000071E0,                        0,                        0,    -2.1927083333333366E0},
+  { 3, 9,                        0,    -2.3333333333333339E0,     5.9895833333333304E0,                        0},
+  { 3, 8,     5.8794642857142891E0,                        0,                        0,     2.1562500000000009E0},
+  { 3, 7,                        0,     2.4285714285714297E0,    -4.9642857142857162E0,                        0},
+  { 3, 6,    -5.2499999999999991E0,                        0,                        0,    -2.2500000000000004E0},
+  { 3, 5,                        0,    -3.1999999999999993E0,     4.4999999999999982E0,                        0},
+  { 3, 4,     5.5000000000000000E0,                        0,                        0,     3.1666666666666665E0},
+  { 3, 3,                        0,     2.6666666666666670E0,    -4.6666666666666661E0,                        0},
+  { 3, 2,    -2.0000000000000004E0,                        0,                        0,    -2.0000000000000000E0},
+  { 3, 1,                        0,     4.0000000000000000E0,    -4.0000000000000000E0,                        0},
+  { 2,19,                        0,   -0.40378610711348462E0,     1.9485388599313054E0,                        0},
+  { 2,18,     1.9713888729319924E0,                        0,                        0,    0.40508315142463203E0},
+  { 2,17,                        0,    0.43387379365809076E0,    -1.8795668658088238E0,                        0},
+  { 2,16,    -1.9090576171874916E0,                        0,                        0,   -0.43586425781249893E0},
+  { 2,15,                        0,   -0.47226562499999925E0,     1.8131610576923078E0,                        0},
+  { 2,14,     1.8529146634615328E0,                        0,                        0,    0.47551081730769185E0},
+  { 2,13,                        0,    0.52373798076923150E0,    -1.7530594405594440E0,                        0},
+  { 2,12,    -1.8100142045454544E0,                        0,                        0,   -0.52947443181818088E0},
+  { 2,11,                        0,   -0.59801136363636442E0,     1.7073863636363655E0,                        0},
+  { 2,10,     1.7968749999999991E0,                        0,                        0,    0.60937500000000022E0},
+  { 2, 9,                        0,    0.71875000000000022E0,    -1.6964285714285723E0,                        0},
+  { 2, 8,    -1.8616071428571437E0,                        0,                        0,   -0.74553571428571463E0},
+  { 2, 7,                        0,   -0.96428571428571452E0,     1.7857142857142865E0,                        0},
+  { 2, 6,     2.2499999999999991E0,                        0,                        0,     1.0499999999999998E0},
+  { 2, 5,                        0,     1.8999999999999999E0,    -2.4000000000000004E0,                        0},
+  { 2, 4,    -3.4999999999999996E0,                        0,                        0,    -2.5000000000000000E0},
+  { 2, 3,                        0,    -2.0000000000000000E0,     4.0000000000000000E0,                        0},
+  { 2, 2,    -6.0000000000000000E0,                        0,                        0,    -6.0000000000000000E0},
+  { 1,20,    0.19485388599313053E0,                        0,                        0,  3.8127698396381353E-002},
+  { 1,19,                        0,  4.2640331728908631E-002,   -0.19590773449593729E0,                        0},
+  { 1,18,   -0.20884076286764708E0,                        0,                        0, -4.5180376838235600E-002},
+  { 1,17,                        0, -5.1278147977941051E-002,    0.21042049632352844E0,                        0},
+  { 1,16,    0.22664513221153848E0,                        0,                        0,  5.4785156249999953E-002},
+  { 1,15,                        0,  6.3401442307692249E-002,   -0.22914663461538387E0,                        0},
+  { 1,14,   -0.25043706293706341E0,                        0,                        0, -6.8509615384615474E-002},
+  { 1,13,                        0, -8.1457604895104743E-002,    0.25469842657342656E0,                        0},
+  { 1,12,    0.28456439393939426E0,                        0,                        0,  8.9488636363636520E-002},
+  { 1,11,                        0,    0.11079545454545459E0,   -0.29261363636363613E0,                        0},
+  { 1,10,   -0.33928571428571447E0,                        0,                        0,   -0.12500000000000006E0},
+  { 1, 9,                        0,   -0.16567460317460325E0,    0.35714285714285732E0,                        0},
+  { 1, 8,    0.44642857142857162E0,                        0,                        0,    0.19642857142857148E0},
+  { 1, 7,                        0,    0.29999999999999993E0,   -0.49999999999999967E0,                        0},
+  { 1, 6,   -0.80000000000000004E0,                        0,                        0,   -0.39999999999999991E0},
+  { 1, 5,                        0,    -1.0000000000000000E0,     1.2000000000000000E0,                        0},
+  { 1, 4,     2.0000000000000000E0,                        0,                        0,     2.0000000000000000E0},
+  { 1, 3,                        0,    -4.0000000000000000E0,     4.0000000000000000E0,                        0},
+  { 0,21,                        0,  1.8156046855419693E-003, -8.8123094889682677E-003,                        0},
+  { 0,20, -9.7953867247968646E-003,                        0,                        0, -2.0131208579237570E-003},
+  { 0,19,                        0, -2.3779145704334527E-003,  1.0376354489164087E-002,                        0},
+  { 0,18,  1.1690027573529358E-002,                        0,                        0,  2.6697495404411748E-003},
+  { 0,17,                        0,  3.2226562499999972E-003, -1.2489615738122165E-002,                        0},
+  { 0,16, -1.4321664663461492E-002,                        0,                        0, -3.6771334134615267E-003},
+  { 0,15,                        0, -4.5673076923076986E-003,  1.5482954545454572E-002,                        0},
+  { 0,14,  1.8192744755244752E-002,                        0,                        0,  5.3267045454545338E-003},
+  { 0,13,                        0,  6.8837412587412711E-003, -2.0013840326340359E-002,                        0},
+  { 0,12, -2.4384469696969675E-002,                        0,                        0, -8.2859848484848567E-003},
+  { 0,11,                        0, -1.1363636363636367E-002,  2.7597402597402600E-002,                        0},
+  { 0,10,  3.5714285714285733E-002,                        0,                        0,  1.4384920634920638E-002},
+  { 0, 9,                        0,  2.1825396825396831E-002, -4.2658730158730160E-002,                        0},
+  { 0, 8, -6.2499999999999958E-002,                        0,                        0, -3.0357142857142826E-002},
+  { 0, 7,                        0, -5.7142857142857127E-002,  8.5714285714285715E-002,                        0},
+  { 0, 6,    0.19999999999999998E0,                        0,                        0,  9.9999999999999978E-002},
+  { 0, 5,                        0,    0.40000000000000002E0,   -0.60000000000000009E0,                        0},
+  { 0, 4,     1.0000000000000000E0,                        0,                        0,     1.0000000000000000E0},
+  {20, 1,                        0,                        0,     1.0000000000000004E0,                        0},
+  {19, 2,     10.000000000000004E0,                        0,                        0,     2.5000000000000009E0},
+  {19, 1,                        0,                        0,    -1.0000000000000000E0,                        0},
+  {18, 3,                        0,     15.833333333333337E0,    -36.666666666666693E0,                        0},
+  {18, 2,    -9.5000000000000000E0,                        0,                        0,    -2.5000000000000000E0},
+  {18, 1,                        0,                        0,     1.0000000000000002E0,                        0},
+  {17, 4,    -165.00000000000011E0,                        0,                        0,    -39.375000000000014E0},
+  {17, 3,                        0,    -14.999999999999998E0,     33.499999999999993E0,                        0},
+  {17, 2,     9.0000000000000018E0,                        0,                        0,     2.4999999999999982E0},
+  {17, 1,                        0,                        0,    -1.0000000000000013E0,                        0},
+  {16, 5,                        0,    -133.87500000000006E0,     403.50000000000034E0,                        0},
+  {16, 4,     142.37499999999997E0,                        0,                        0,     35.624999999999986E0},
+  {16, 3,                        0,     14.166666666666657E0,    -30.500000000000011E0,                        0},
+  {16, 2,    -8.5000000000000107E0,                        0,                        0,    -2.4999999999999991E0},
+  {16, 1,                        0,                        0,    0.99999999999999956E0,                        0},
+  {15, 6,     1076.0000000000009E0,                        0,                        0,     259.56250000000017E0},
+  {15, 5,                        0,     113.99999999999996E0,    -326.57499999999987E0,                        0},
+  {15, 4,    -122.00000000000004E0,                        0,                        0,    -32.083333333333300E0},
+  {15, 3,                        0,    -13.333333333333329E0,     27.666666666666728E0,                        0},
+  {15, 2,     7.9999999999999964E0,                        0,                        0,     2.5000000000000000E0},
+  {15, 1,                        0,                        0,    -1.0000000000000002E0,                        0},
+  {14, 7,                        0,     556.20535714285757E0,    -1899.6428571428587E0,                        0},
+  {14, 6,    -816.43749999999966E0,                        0,                        0,    -206.56249999999989E0},
+  {14, 5,                        0,    -96.249999999999915E0,     261.37500000000011E0,                        0},
+  {14, 4,     103.75000000000023E0,                        0,                        0,     28.749999999999982E0},
+  {14, 3,                        0,     12.499999999999998E0,    -24.999999999999979E0,                        0},
+  {14, 2,    -7.5000000000000018E0,                        0,                        0,    -2.5000000000000009E0},
+  {14, 1,                        0,                        0,     1.0000000000000007E0,                        0},
+  {13, 8,    -3324.3750000000027E0,                        0,                        0,    -805.42968750000080E0},
+  {13, 7,                        0,    -413.12499999999977E0,     1343.4374999999991E0,                        0},
+  {13, 6,     609.87500000000023E0,                        0,                        0,     162.18749999999983E0},
+  {13, 5,                        0,     80.499999999999943E0,    -206.62500000000068E0,                        0},
+  {13, 4,    -87.499999999999929E0,                        0,                        0,    -25.625000000000000E0},
+  {13, 3,                        0,    -11.666666666666670E0,     22.500000000000004E0,                        0},
+  {13, 2,     7.0000000000000044E0,                        0,                        0,     2.5000000000000004E0},
+  {13, 1,                        0,                        0,    -1.0000000000000004E0,                        0},
+  {12, 9,                        0,    -1163.3984375000011E0,     4182.6822916666706E0,                        0},
+  {12, 8,     2183.0859374999986E0,                        0,                        0,     555.03906249999977E0},
+  {12, 7,                        0,     301.20535714285683E0,    -930.31250000000023E0,                        0},
+  {12, 6,    -447.68750000000148E0,                        0,                        0,    -125.43749999999986E0},
+  {12, 5,                        0,    -66.625000000000000E0,     161.12499999999974E0,                        0},
+  {12, 4,     73.125000000000014E0,                        0,                        0,     22.708333333333350E0},
+  {12, 3,                        0,     10.833333333333336E0,    -20.166666666666682E0,                        0},
+  {12, 2,    -6.5000000000000027E0,                        0,                        0,    -2.5000000000000000E0},
+  {12, 1,                        0,                        0,     1.0000000000000004E0,                        0},
+  {11,10,     5019.2187500000045E0,                        0,                        0,     1217.9882812500014E0},
+  {11, 9,                        0,     740.05208333333303E0,    -2534.1536458333308E0,                        0},
+  {11, 8,    -1395.4687500000005E0,                        0,                        0,    -373.16964285714238E0},
+  {11, 7,                        0,    -215.03571428571405E0,     629.10714285714539E0,                        0},
+  {11, 6,     322.24999999999949E0,                        0,                        0,     95.375000000000000E0},
+  {11, 5,                        0,     54.500000000000036E0,    -123.75000000000000E0,                        0},
+  {11, 4,    -60.500000000000043E0,                        0,                        0,    -20.000000000000007E0},
+  {11, 3,                        0,    -10.000000000000000E0,     18.000000000000014E0,                        0},
+  {11, 2,     6.0000000000000027E0,                        0,                        0,     2.4999999999999991E0},
+  {11, 1,                        0,                        0,    -1.0000000000000000E0,                        0},
+  {10,11,                        0,     1217.9882812500014E0,    -4506.1250000000055E0,                        0},
+  {10,10,    -2787.5690104166638E0,                        0,                        0,    -709.97265624999989E0},
+  {10, 9,                        0,    -456.09623015872955E0,     1483.9973958333337E0,                        0},
+  {10, 8,     865.02232142857497E0,                        0,                        0,     243.91517857142827E0},
+  {10, 7,                        0,     149.87500000000000E0,    -414.07142857142782E0,                        0},
+  {10, 6,    -226.87500000000000E0,                        0,                        0,    -71.125000000000071E0},
+  {10, 5,                        0,    -44.000000000000021E0,     93.450000000000088E0,                        0},
+  {10, 4,     49.500000000000043E0,                        0,                        0,     17.500000000000000E0},
+  {10, 3,                        0,     9.1666666666666643E0,    -16.000000000000007E0,                        0},
+  {10, 2,    -5.5000000000000000E0,                        0,                        0,    -2.5000000000000000E0},
+  {10, 1,                        0,                        0,    0.99999999999999989E0,                        0},
+  { 9,12,    -3755.1041666666706E0,                        0,                        0,    -912.01009114583462E0},
+  { 9,11,                        0,    -645.42968749999989E0,     2274.4752604166642E0,                        0},
+  { 9,10,     1483.9973958333337E0,                        0,                        0,     397.62121775793588E0},
+  { 9, 9,                        0,     271.01686507936472E0,    -835.67398313492458E0,                        0},
+  { 9, 8,    -517.58928571428476E0,                        0,                        0,    -154.31919642857142E0},
+  { 9, 7,                        0,    -101.60714285714295E0,     264.19642857142850E0,                        0},
+  { 9, 6,     155.75000000000014E0,                        0,                        0,     51.875000000000021E0},
+  { 9, 5,                        0,     35.000000000000000E0,    -69.250000000000085E0,                        0},
+  { 9, 4,    -40.000000000000014E0,                        0,                        0,    -15.208333333333323E0},
+  { 9, 3,                        0,    -8.3333333333333321E0,     14.166666666666670E0,                        0},
+  { 9, 2,     4.9999999999999991E0,                        0,                        0,     2.5000000000000004E0},
+  { 9, 1,                        0,                        0,   -0.99999999999999989E0,                        0},
+  { 8,13,                        0,    -631.39160156250091E0,     2379.3164062500023E0,                        0},
+  { 8,12,     1705.8564453124980E0,                        0,                        0,     434.87792968749989E0},
+  { 8,11,                        0,     325.32645089285666E0,    -1089.4101562499998E0,                        0},
+  { 8,10,    -752.10658482143219E0,                        0,                        0,    -212.54185267857113E0},
+  { 8, 9,                        0,    -154.31919642857142E0,     449.63727678571331E0,                        0},
+  { 8, 8,     297.22098214285705E0,                        0,                        0,     93.984375000000085E0},
+  { 8, 7,                        0,     66.696428571428598E0,    -162.58928571428589E0,                        0},
+  { 8, 6,    -103.87500000000013E0,                        0,                        0,    -36.875000000000007E0},
+  { 8, 5,                        0,    -27.374999999999982E0,     50.250000000000028E0,                        0},
+  { 8, 4,     31.875000000000007E0,                        0,                        0,     13.124999999999998E0},
+  { 8, 3,                        0,     7.5000000000000018E0,    -12.499999999999998E0,                        0},
+  { 8, 2,    -4.4999999999999991E0,                        0,                        0,    -2.5000000000000000E0},
+  { 8, 1,                        0,                        0,     1.0000000000000002E0,                        0},
+  { 7,14,     1359.6093750000014E0,                        0,                        0,     330.38818359375051E0},
+  { 7,13,                        0,     267.61718749999994E0,    -960.60644531249864E0,                        0},
+  { 7,12,    -726.27343749999989E0,                        0,                        0,    -194.80050223214252E0},
+  { 7,11,                        0,    -154.57589285714263E0,     490.59040178571689E0,                        0},
+  { 7,10,     359.70982142857065E0,                        0,                        0,     107.51395089285714E0},
+  { 7, 9,                        0,     83.541666666666742E0,    -229.26897321428567E0,                        0},
+  { 7, 8,    -162.58928571428589E0,                        0,                        0,    -54.709821428571466E0},
+  { 7, 7,                        0,    -42.142857142857153E0,     95.892857142857281E0,                        0},
+  { 7, 6,     67.000000000000043E0,                        0,                        0,     25.437499999999979E0},
+  { 7, 5,                        0,     20.999999999999996E0,    -35.625000000000007E0,                        0},
+  { 7, 4,    -24.999999999999996E0,                        0,                        0,    -11.250000000000002E0},
+  { 7, 3,                        0,    -6.6666666666666661E0,     11.000000000000000E0,                        0},
+  { 7, 2,     4.0000000000000009E0,                        0,                        0,     2.5000000000000000E0},
+  { 7, 1,                        0,                        0,   -0.99999999999999978E0,                        0},
+  { 6,15,                        0,     154.18115234375026E0,    -588.52734375000091E0,                        0},
+  { 6,14,    -480.30322265624932E0,                        0,                        0,    -122.51708984374999E0},
+  { 6,13,                        0,    -104.89257812499983E0,     357.78613281249977E0,                        0},
+  { 6,12,     286.17773437500153E0,                        0,                        0,     80.966796874999872E0},
+  { 6,11,                        0,     68.417968750000000E0,    -205.21093749999949E0,                        0},
+  { 6,10,    -160.48828124999997E0,                        0,                        0,    -50.891927083333385E0},
+  { 6, 9,                        0,    -42.552083333333364E0,     109.59635416666679E0,                        0},
+  { 6, 8,     83.906250000000114E0,                        0,                        0,     30.156250000000007E0},
+  { 6, 7,                        0,     25.437499999999979E0,    -53.750000000000043E0,                        0},
+  { 6, 6,    -41.562500000000007E0,                        0,                        0,    -16.937499999999996E0},
+  { 6, 5,                        0,    -15.750000000000004E0,     24.624999999999996E0,                        0},
+  { 6, 4,     19.250000000000000E0,                        0,                        0,     9.5833333333333304E0},
+  { 6, 3,                        0,     5.8333333333333339E0,    -9.6666666666666696E0,                        0},
+  { 6, 2,    -3.4999999999999991E0,                        0,                        0,    -2.5000000000000000E0},
+  { 6, 1,                        0,                        0,    0.99999999999999989E0,                        0},
+  { 5,16,    -220.69775390625034E0,                        0,                        0,    -53.649810791015717E0},
+  { 5,15,                        0,    -49.006835937499993E0,     178.18447265624974E0,                        0},
+  { 5,14,     153.33691406249991E0,                        0,                        0,     41.154785156249936E0},
+  { 5,13,                        0,     37.369290865384556E0,    -120.81152343750074E0,                        0},
+  { 5,12,    -102.60546874999974E0,                        0,                        0,    -30.708007812499993E0},
+  { 5,11,                        0,    -27.759232954545482E0,     78.433593749999943E0,                        0},
+  { 5,10,     65.757812500000071E0,                        0,                        0,     22.199218750000025E0},
+  { 5, 9,                        0,     20.104166666666671E0,    -48.398437500000064E0,                        0},
+  { 5, 8,    -40.312500000000028E0,                        0,                        0,    -15.539062499999984E0},
+  { 5, 7,                        0,    -14.517857142857141E0,     28.312500000000007E0,                        0},
+  { 5, 6,     24.624999999999996E0,                        0,                        0,     10.812500000000002E0},
+  { 5, 5,                        0,     11.499999999999996E0,    -16.574999999999999E0,                        0},
+  { 5, 4,    -14.500000000000004E0,                        0,                        0,    -8.1250000000000000E0},
+  { 5, 3,                        0,    -5.0000000000000000E0,     8.4999999999999982E0,                        0},
+  { 5, 2,     2.9999999999999996E0,                        0,                        0,     2.5000000000000000E0},
+  { 5, 1,                        0,                        0,   -0.99999999999999978E0,                        0},
+  { 5, 0,     1.0000000000000000E0,                        0,                        0,     1.0000000000000000E0},
+  { 4,17,                        0,    -15.779356115004624E0,     60.806014117072692E0,                        0},
+  { 4,16,     55.682647705078040E0,                        0,                        0,     14.209442138671871E0},
+  { 4,15,                        0,     13.718261718749979E0,    -47.397949218749957E0,                        0},
+  { 4,14,    -43.146972656250270E0,                        0,                        0,    -12.216233473557670E0},
+  { 4,13,                        0,    -11.810772235576920E0,     36.085862379807594E0,                        0},
+  { 4,12,     32.680664062499979E0,                        0,                        0,     10.378639914772737E0},
+  { 4,11,                        0,     10.090553977272737E0,    -26.762428977272755E0,                        0},
+  { 4,10,    -24.199218750000032E0,                        0,                        0,    -8.7304687500000018E0},
+  { 4, 9,                        0,    -8.6328124999999911E0,     19.335937500000021E0,                        0},
+  { 4, 8,     17.695312500000004E0,                        0,                        0,     7.3493303571428568E0},
+  { 4, 7,                        0,     7.7232142857142874E0,    -13.794642857142852E0,                        0},
+  { 4, 6,    -13.812499999999998E0,                        0,                        0,    -6.5624999999999982E0},
+  { 4, 5,                        0,    -8.1250000000000000E0,     10.875000000000004E0,                        0},
+  { 4, 4,     10.624999999999998E0,                        0,                        0,     6.8750000000000000E0},
+  { 4, 3,                        0,     4.1666666666666670E0,    -7.5000000000000000E0,                        0},
+  { 4, 2,    -2.4999999999999996E0,                        0,                        0,    -2.5000000000000000E0},
+  { 4, 1,                        0,     5.0000000000000000E0,    -5.0000000000000000E0,                        0},
+  { 3,18,     13.512447581571710E0,                        0,                        0,     3.2856481215533146E0},
+  { 3,17,                        0,     3.3433981502757346E0,    -12.272159352022038E0,                        0},
+  { 3,16,    -11.849487304687489E0,                        0,                        0,    -3.1817626953124942E0},
+  { 3,15,                        0,    -3.2576622596153788E0,     10.667968750000071E0,                        0},
+  { 3,14,     10.310246394230742E0,                        0,                        0,     3.0881911057692282E0},
+  { 3,13,                        0,     3.1934276660839189E0,    -9.1917067307692246E0,                        0},
+  { 3,12,    -8.9208096590909189E0,                        0,                        0,    -3.0166903409090926E0},
+  { 3,11,                        0,    -3.1747159090909096E0,     7.8721590909091024E0,                        0},
+  { 3,10,     7.7343750000000080E0,                        0,                        0,     2.9947916666666634E0},
+  { 3, 9,                        0,     3.2663690476190474E0,    -6.7708333333333375E0,                        0},
+  { 3, 8,    -6.8973214285714262E0,                        0,                        0,    -3.1026785714285725E0},
+  { 3, 7,                        0,    -3.7499999999999991E0,     6.0714285714285721E0,                        0},
+  { 3, 6,     7.2500000000000027E0,                        0,                        0,     3.7500000000000000E0},
+  { 3, 5,                        0,     5.5000000000000000E0,    -6.9999999999999964E0,                        0},
+  { 3, 4,    -7.5000000000000000E0,                        0,                        0,    -5.8333333333333339E0},
+  { 3, 3,                        0,    -3.3333333333333330E0,     6.6666666666666652E0,                        0},
+  { 3, 2,    -10.000000000000000E0,                        0,                        0,    -10.000000000000000E0},
+  { 2,19,                        0,    0.51878654550841818E0,    -2.0137964018358199E0,                        0},
+  { 2,18,    -2.0453598920036731E0,                        0,                        0,   -0.52210190716911775E0},
+  { 2,17,                        0,   -0.56148753446691080E0,     1.9584745519301445E0,                        0},
+  { 2,16,     2.0002441406250133E0,                        0,                        0,    0.56661283052884492E0},
+  { 2,15,                        0,    0.61763822115384559E0,    -1.9115084134615330E0,                        0},
+  { 2,14,    -1.9696514423076907E0,                        0,                        0,   -0.62609265734265807E0},
+  { 2,13,                        0,   -0.69615930944055981E0,     1.8809822989510512E0,                        0},
+  { 2,12,     1.9680397727272756E0,                        0,                        0,    0.71141098484848508E0},
+  { 2,11,                        0,    0.81676136363636265E0,    -1.8849431818181839E0,                        0},
+  { 2,10,    -2.0312500000000009E0,                        0,                        0,   -0.84821428571428537E0},
+  { 2, 9,                        0,    -1.0342261904761907E0,     1.9717261904761896E0,                        0},
+  { 2, 8,     2.2767857142857144E0,                        0,                        0,     1.1160714285714282E0},
+  { 2, 7,                        0,     1.6071428571428572E0,    -2.3214285714285725E0,                        0},
+  { 2, 6,    -3.4999999999999982E0,                        0,                        0,    -2.0000000000000000E0},
+  { 2, 5,                        0,    -3.5000000000000000E0,     4.5000000000000009E0,                        0},
+  { 2, 4,     4.9999999999999991E0,                        0,                        0,     5.0000000000000000E0},
+  { 2, 3,                        0,    -10.000000000000000E0,     10.000000000000000E0,                        0},
+  { 1,20,   -0.20137964018358201E0,                        0,                        0, -4.8976933623984212E-002},
+  { 1,19,                        0, -5.4958095491486079E-002,    0.20320360874612978E0,                        0},
+  { 1,18,    0.21760828354779382E0,                        0,                        0,  5.8450137867646933E-002},
+  { 1,17,                        0,  6.6660333003393524E-002,   -0.22037281709558987E0,                        0},
+  { 1,16,   -0.23893855168269162E0,                        0,                        0, -7.1608323317307654E-002},
+  { 1,15,                        0, -8.3479020979021074E-002,    0.24338942307692288E0,                        0},
+  { 1,14,    0.26871175699300731E0,                        0,                        0,  9.0963723776223804E-002},
+  { 1,13,                        0,    0.10944784382284387E0,   -0.27649694055944096E0,                        0},
+  { 1,12,   -0.31415719696969729E0,                        0,                        0,   -0.12192234848484829E0},
+  { 1,11,                        0,   -0.15422077922077915E0,    0.32954545454545470E0,                        0},
+  { 1,10,    0.39434523809523792E0,                        0,                        0,    0.17857142857142863E0},
+  { 1, 9,                        0,    0.24801587301587291E0,   -0.43154761904761907E0,                        0},
+  { 1, 8,   -0.58035714285714313E0,                        0,                        0,   -0.31249999999999994E0},
+  { 1, 7,                        0,   -0.57142857142857140E0,    0.71428571428571408E0,                        0},
+  { 1, 6,     1.5000000000000002E0,                        0,                        0,     1.0000000000000000E0},
+  { 1, 5,                        0,     2.0000000000000000E0,    -2.9999999999999996E0,                        0},
+  { 1, 4,     5.0000000000000000E0,                        0,                        0,     5.0000000000000000E0},
+  { 0,21,                        0, -2.3322349344754387E-003,  9.1056885593464310E-003,                        0},
+  { 0,20,  1.0160180437306489E-002,                        0,                        0,  2.5940886222910265E-003},
+  { 0,19,                        0,  3.0763230456656281E-003, -1.0808702592879232E-002,                        0},
+  { 0,18, -1.2242934283088326E-002,                        0,                        0, -3.4693377050339274E-003},
+  { 0,17,                        0, -4.2122543127828035E-003,  1.3160394867081412E-002,                        0},
+  { 0,16,  1.5211838942307680E-002,                        0,                        0,  4.8384232954545511E-003},
+  { 0,15,                        0,  6.0642482517482537E-003, -1.6597465034965050E-002,                        0},
+  { 0,14, -1.9749781468531496E-002,                        0,                        0, -7.1478001165501265E-003},
+  { 0,13,                        0, -9.3786421911421763E-003,  2.2053467365967371E-002,                        0},
+  { 0,12,  2.7462121212121222E-002,                        0,                        0,  1.1498917748917746E-002},
+  { 0,11,                        0,  1.6233766233766239E-002, -3.1926406926406928E-002,                        0},
+  { 0,10, -4.3154761904761904E-002,                        0,                        0, -2.1329365079365083E-002},
+  { 0, 9,                        0, -3.4722222222222217E-002,  5.4563492063492106E-002,                        0},
+  { 0, 8,  8.9285714285714260E-002,                        0,                        0,  5.3571428571428575E-002},
+  { 0, 7,                        0,    0.14285714285714285E0,   -0.14285714285714285E0,                        0},
+  { 0, 6,   -0.49999999999999994E0,                        0,                        0,   -0.50000000000000000E0},
+  { 0, 5,                        0,     1.0000000000000000E0,    -1.0000000000000000E0,                        0},
+  {20, 1,                        0,                        0,   -0.99999999999999978E0,                        0},
+  {19, 2,    -9.9999999999999982E0,                        0,                        0,    -3.0000000000000027E0},
+  {19, 1,                        0,                        0,     1.0000000000000004E0,                        0},
+  {18, 3,                        0,    -19.000000000000018E0,     39.166666666666671E0,                        0},
+  {18, 2,     9.5000000000000036E0,                        0,                        0,     3.0000000000000013E0},
+  {18, 1,                        0,                        0,   -0.99999999999999967E0,                        0},
+  {17, 4,     176.25000000000003E0,                        0,                        0,     50.250000000000064E0},
+  {17, 3,                        0,     18.000000000000007E0,    -36.000000000000028E0,                        0},
+  {17, 2,    -8.9999999999999964E0,                        0,                        0,    -3.0000000000000000E0},
+  {17, 1,                        0,                        0,    0.99999999999999978E0,                        0},
+  {16, 5,                        0,     170.85000000000022E0,    -426.37500000000000E0,                        0},
+  {16, 4,    -153.00000000000011E0,                        0,                        0,    -45.750000000000028E0},
+  {16, 3,                        0,    -17.000000000000000E0,     32.999999999999986E0,                        0},
+  {16, 2,     8.4999999999999982E0,                        0,                        0,     2.9999999999999996E0},
+  {16, 1,                        0,                        0,   -0.99999999999999933E0,                        0},
+  {15, 6,    -1137.0000000000000E0,                        0,                        0,    -326.57500000000067E0},
+  {15, 5,                        0,    -146.40000000000009E0,     347.32500000000044E0,                        0},
+  {15, 4,     131.99999999999994E0,                        0,                        0,     41.500000000000000E0},
+  {15, 3,                        0,     15.999999999999998E0,    -30.166666666666661E0,                        0},
+  {15, 2,    -7.9999999999999947E0,                        0,                        0,    -2.9999999999999987E0},
+  {15, 1,                        0,                        0,     1.0000000000000004E0,                        0},
+  {14, 7,                        0,    -699.80357142857292E0,     1992.6339285714282E0,                        0},
+  {14, 6,     868.31250000000114E0,                        0,                        0,     261.37500000000017E0},
+  {14, 5,                        0,     124.50000000000001E0,    -280.12499999999989E0,                        0},
+  {14, 4,    -113.12499999999997E0,                        0,                        0,    -37.499999999999993E0},
+  {14, 3,                        0,    -14.999999999999993E0,     27.499999999999975E0,                        0},
+  {14, 2,     7.5000000000000036E0,                        0,                        0,     3.0000000000000000E0},
+  {14, 1,                        0,                        0,   -0.99999999999999956E0,                        0},
+  {13, 8,     3487.1093749999995E0,                        0,                        0,     1007.5781250000024E0},
+  {13, 7,                        0,     522.75000000000034E0,    -1416.8750000000020E0,                        0},
+  {13, 6,    -653.62499999999977E0,                        0,                        0,    -206.62500000000003E0},
+  {13, 5,                        0,    -104.99999999999997E0,     223.49999999999991E0,                        0},
+  {13, 4,     96.249999999999915E0,                        0,                        0,     33.749999999999972E0},
+  {13, 3,                        0,     14.000000000000000E0,    -25.000000000000021E0,                        0},
+  {13, 2,    -6.9999999999999964E0,                        0,                        0,    -2.9999999999999991E0},
+  {13, 1,                        0,                        0,    0.99999999999999989E0,                        0},
+  {12, 9,                        0,     1455.3906250000034E0,    -4376.0460069444434E0,                        0},
+  {12, 8,    -2302.4218750000032E0,                        0,                        0,    -697.73437500000057E0},
+  {12, 7,                        0,    -383.73214285714289E0,     987.49999999999966E0,                        0},
+  {12, 6,     484.24999999999983E0,                        0,                        0,     161.12500000000000E0},
+  {12, 5,                        0,     87.749999999999929E0,    -176.24999999999977E0,                        0},
+  {12, 4,    -81.250000000000071E0,                        0,                        0,    -30.250000000000000E0},
+  {12, 3,                        0,    -12.999999999999996E0,     22.666666666666650E0,                        0},
+  {12, 2,     6.4999999999999991E0,                        0,                        0,     2.9999999999999996E0},
+  {12, 1,                        0,                        0,    -1.0000000000000000E0,                        0},
+  {11,10,    -5251.2552083333321E0,                        0,                        0,    -1520.4921875000043E0},
+  {11, 9,                        0,    -930.31250000000068E0,     2664.8307291666720E0,                        0},
+  {11, 8,     1481.2499999999995E0,                        0,                        0,     471.83035714285722E0},
+  {11, 7,                        0,     276.21428571428572E0,    -672.94642857142833E0,                        0},
+  {11, 6,    -352.49999999999955E0,                        0,                        0,    -123.74999999999989E0},
+  {11, 5,                        0,    -72.599999999999994E0,     137.25000000000020E0,                        0},
+  {11, 4,     67.999999999999943E0,                        0,                        0,     26.999999999999989E0},
+  {11, 3,                        0,     11.999999999999998E0,    -20.499999999999996E0,                        0},
+  {11, 2,    -6.0000000000000000E0,                        0,                        0,    -3.0000000000000000E0},
+  {11, 1,                        0,                        0,    0.99999999999999989E0,                        0},
+  {10,11,                        0,    -1520.4921875000043E0,     4708.0820312499982E0,                        0},
+  {10,10,     2931.3138020833394E0,                        0,                        0,     890.39843750000080E0},
+  {10, 9,                        0,     576.68154761904771E0,    -1569.9348958333326E0,                        0},
+  {10, 8,    -925.30133928571399E0,                        0,                        0,    -310.55357142857133E0},
+  {10, 7,                        0,    -194.46428571428555E0,     447.08928571428498E0,                        0},
+  {10, 6,     251.62500000000034E0,                        0,                        0,     93.450000000000017E0},
+  {10, 5,                        0,     59.399999999999977E0,    -105.44999999999990E0,                        0},
+  {10, 4,    -56.374999999999993E0,                        0,                        0,    -24.000000000000000E0},
+  {10, 3,                        0,    -11.000000000000000E0,     18.500000000000007E0,                        0},
+  {10, 2,     5.4999999999999991E0,                        0,                        0,     3.0000000000000009E0},
+  {10, 1,                        0,                        0,   -0.99999999999999978E0,                        0},
+  { 9,12,     3923.4016927083321E0,                        0,                        0,     1137.2376302083367E0},
+  { 9,11,                        0,     809.45312500000068E0,    -2388.1406250000050E0,                        0},
+  { 9,10,    -1569.9348958333326E0,                        0,                        0,    -501.40438988095258E0},
+  { 9, 9,                        0,    -345.05952380952374E0,     890.44208829365039E0,                        0},
+  { 9, 8,     558.86160714285620E0,                        0,                        0,     198.14732142857116E0},
+  { 9, 7,                        0,     133.50000000000000E0,    -288.57142857142901E0,                        0},
+  { 9, 6,    -175.74999999999986E0,                        0,                        0,    -69.249999999999972E0},
+  { 9, 5,                        0,    -48.000000000000000E0,     79.874999999999986E0,                        0},
+  { 9, 4,     46.250000000000014E0,                        0,                        0,     21.250000000000000E0},
+  { 9, 3,                        0,     10.000000000000002E0,    -16.666666666666664E0,                        0},
+  { 9, 2,    -4.9999999999999991E0,                        0,                        0,    -3.0000000000000000E0},
+  { 9, 1,                        0,                        0,    0.99999999999999978E0,                        0},
+  { 8,13,                        0,     787.31835937500239E0,    -2483.8720703124986E0,                        0},
+  { 8,12,    -1791.1054687500039E0,                        0,                        0,    -544.70507812500068E0},
+  { 8,11,                        0,    -410.23995535714300E0,     1150.5234374999995E0,                        0},
+  { 8,10,     801.39787946428532E0,                        0,                        0,     269.78236607142856E0},
+  { 8, 9,                        0,     198.14732142857116E0,    -483.28683035714192E0,                        0},
+  { 8, 8,    -324.64285714285762E0,                        0,                        0,    -121.94196428571429E0},
+  { 8, 7,                        0,    -89.035714285714249E0,     180.17857142857125E0,                        0},
+  { 8, 6,     119.81249999999999E0,                        0,                        0,     50.249999999999993E0},
+  { 8, 5,                        0,     38.250000000000000E0,    -59.625000000000028E0,                        0},
+  { 8, 4,    -37.499999999999993E0,                        0,                        0,    -18.750000000000004E0},
+  { 8, 3,                        0,    -9.0000000000000000E0,     14.999999999999996E0,                        0},
+  { 8, 2,     4.4999999999999991E0,                        0,                        0,     3.0000000000000000E0},
+  { 8, 1,                        0,                        0,   -0.99999999999999967E0,                        0},
+  { 7,14,    -1419.3554687499993E0,                        0,                        0,    -411.68847656250125E0},
+  { 7,13,                        0,    -335.20312500000040E0,     1007.6669921875022E0,                        0},
+  { 7,12,     767.01562499999977E0,                        0,                        0,     245.29520089285725E0},
+  { 7,11,                        0,     196.20535714285714E0,    -521.72042410714266E0,                        0},
+  { 7,10,    -386.62946428571354E0,                        0,                        0,    -137.56138392857125E0},
+  { 7, 9,                        0,    -108.39285714285715E0,     249.06808035714334E0,                        0},
+  { 7, 8,     180.17857142857125E0,                        0,                        0,     71.919642857142833E0},
+  { 7, 7,                        0,     57.428571428571423E0,    -108.25892857142856E0,                        0},
+  { 7, 6,    -79.500000000000043E0,                        0,                        0,    -35.625000000000000E0},
+  { 7, 5,                        0,    -30.000000000000004E0,     43.874999999999993E0,                        0},
+  { 7, 4,     29.999999999999993E0,                        0,                        0,     16.500000000000000E0},
+  { 7, 3,                        0,     8.0000000000000000E0,    -13.500000000000000E0,                        0},
+  { 7, 2,    -3.9999999999999987E0,                        0,                        0,    -2.9999999999999991E0},
+  { 7, 1,                        0,                        0,     1.0000000000000002E0,                        0},
+  { 6,15,                        0,    -192.12128906250058E0,     614.03792317708292E0,                        0},
+  { 6,14,     503.83349609375108E0,                        0,                        0,     153.33691406250020E0},
+  { 6,13,                        0,     132.08203125000006E0,    -377.45785757211524E0,                        0},
+  { 6,12,    -304.33691406249989E0,                        0,                        0,    -102.60546875000000E0},
+  { 6,11,                        0,    -87.539062499999886E0,     220.07066761363586E0,                        0},
+  { 6,10,     174.34765625000034E0,                        0,                        0,     65.757812500000014E0},
+  { 6, 9,                        0,     55.937499999999979E0,    -120.65538194444430E0,                        0},
+  { 6, 8,    -94.726562499999986E0,                        0,                        0,    -40.312499999999986E0},
+  { 6, 7,                        0,    -35.625000000000000E0,     62.187500000000050E0,                        0},
+  { 6, 6,     51.187499999999993E0,                        0,                        0,     24.625000000000004E0},
+  { 6, 5,                        0,     23.099999999999998E0,    -31.874999999999993E0,                        0},
+  { 6, 4,    -23.625000000000000E0,                        0,                        0,    -14.500000000000002E0},
+  { 6, 3,                        0,    -6.9999999999999982E0,     12.166666666666663E0,                        0},
+  { 6, 2,     3.5000000000000009E0,                        0,                        0,     3.0000000000000000E0},
+  { 6, 1,                        0,                        0,    -1.0000000000000000E0,                        0},
+  { 6, 0,     1.0000000000000000E0,                        0,                        0,     1.0000000000000000E0},
+  { 5,16,     230.26422119140608E0,                        0,                        0,     66.819177246093972E0},
+  { 5,15,                        0,     61.334765625000081E0,    -186.79433593750048E0,                        0},
+  { 5,14,    -161.76765324519224E0,                        0,                        0,    -51.776367187500028E0},
+  { 5,13,                        0,    -47.356370192307693E0,     128.32316706730765E0,                        0},
+  { 5,12,     110.03533380681793E0,                        0,                        0,     39.216796874999943E0},
+  { 5,11,                        0,     35.867897727272734E0,    -84.982244318182040E0,                        0},
+  { 5,10,    -72.393229166666586E0,                        0,                        0,    -29.039062499999982E0},
+  { 5, 9,                        0,    -26.874999999999993E0,     54.192708333333314E0,                        0},
+  { 5, 8,     46.640625000000036E0,                        0,                        0,     21.234374999999996E0},
+  { 5, 7,                        0,     21.107142857142861E0,    -33.875000000000000E0,                        0},
+  { 5, 6,    -31.874999999999993E0,                        0,                        0,    -16.574999999999999E0},
+  { 5, 5,                        0,    -17.400000000000002E0,     22.949999999999999E0,                        0},
+  { 5, 4,     18.249999999999993E0,                        0,                        0,     12.750000000000000E0},
+  { 5, 3,                        0,     6.0000000000000000E0,    -11.000000000000000E0,                        0},
+  { 5, 2,    -3.0000000000000000E0,                        0,                        0,    -3.0000000000000000E0},
+  { 5, 1,                        0,     6.0000000000000000E0,    -6.0000000000000000E0,                        0},
+  { 4,17,                        0,     19.652699190027640E0,    -63.415347828584515E0,                        0},
+  { 4,16,    -58.373229980468899E0,                        0,                        0,    -17.774230957031275E0},
+  { 4,15,                        0,    -17.258789062500007E0,     49.967998798076906E0,                        0},
+  { 4,14,     45.829702524038453E0,                        0,                        0,     15.465369591346160E0},
+  { 4,13,                        0,     15.083383413461515E0,    -38.645514641608287E0,                        0},
+  { 4,12,    -35.409268465909179E0,                        0,                        0,    -13.381214488636370E0},
+  { 4,11,                        0,    -13.199573863636356E0,     29.370738636363601E0,                        0},
+  { 4,10,     27.096354166666657E0,                        0,                        0,     11.601562499999998E0},
+  { 4, 9,                        0,     11.796874999999998E0,    -22.135416666666682E0,                        0},
+  { 4, 8,    -21.171875000000000E0,                        0,                        0,    -10.345982142857142E0},
+  { 4, 7,                        0,    -11.839285714285715E0,     17.321428571428569E0,                        0},
+  { 4, 6,     19.125000000000000E0,                        0,                        0,     10.875000000000002E0},
+  { 4, 5,                        0,     12.750000000000000E0,    -16.499999999999996E0,                        0},
+  { 4, 4,    -13.750000000000000E0,                        0,                        0,    -11.250000000000000E0},
+  { 4, 3,                        0,    -5.0000000000000000E0,     10.000000000000000E0,                        0},
+  { 4, 2,    -15.000000000000000E0,                        0,                        0,    -15.000000000000000E0},
+  { 3,18,    -14.092299517463225E0,                        0,                        0,    -4.0907197840073666E0},
+  { 3,17,                        0,    -4.1821719898897118E0,     12.859173943014742E0,                        0},
+  { 3,16,     12.491999699519226E0,                        0,                        0,     4.0004882812500018E0},
+  { 3,15,                        0,     4.1240985576923093E0,    -11.322015224358974E0,                        0},
+  { 3,14,    -11.041575611888081E0,                        0,                        0,    -3.9393028846153779E0},
+  { 3,13,                        0,    -4.1172967657342676E0,     9.9431818181818432E0,                        0},
+  { 3,12,     9.7902462121212004E0,                        0,                        0,     3.9360795454545423E0},
+  { 3,11,                        0,     4.2187499999999991E0,    -8.7812499999999964E0,                        0},
+  { 3,10,    -8.8541666666666732E0,                        0,                        0,    -4.0624999999999991E0},
+  { 3, 9,                        0,    -4.5982142857142856E0,     7.9861111111111116E0,                        0},
+  { 3, 8,     8.6607142857142847E0,                        0,                        0,     4.5535714285714297E0},
+  { 3, 7,                        0,     6.2142857142857153E0,    -8.2142857142857153E0,                        0},
+  { 3, 6,    -10.999999999999998E0,                        0,                        0,    -6.9999999999999991E0},
+  { 3, 5,                        0,    -9.0000000000000000E0,     12.000000000000000E0,                        0},
+  { 3, 4,     10.000000000000000E0,                        0,                        0,     10.000000000000000E0},
+  { 3, 3,                        0,    -20.000000000000000E0,     20.000000000000000E0,                        0},
+  { 2,19,                        0,   -0.64590312379063686E0,     2.0995489067337441E0,                        0},
+  { 2,18,     2.1431956571691235E0,                        0,                        0,    0.65282485064338303E0},
+  { 2,17,                        0,    0.70596852022058854E0,    -2.0635903474971720E0,                        0},
+  { 2,16,    -2.1228778545673075E0,                        0,                        0,   -0.71681565504807732E0},
+  { 2,15,                        0,   -0.78786057692307554E0,     2.0451813811188742E0,                        0},
+  { 2,14,     2.1306818181818237E0,                        0,                        0,    0.80613527097902138E0},
+  { 2,13,                        0,    0.90832604895104829E0,    -2.0604057400932363E0,                        0},
+  { 2,12,    -2.1953124999999991E0,                        0,                        0,   -0.94247159090909072E0},
+  { 2,11,                        0,    -1.1079545454545454E0,     2.1477272727272743E0,                        0},
+  { 2,10,     2.3958333333333335E0,                        0,                        0,     1.1830357142857144E0},
+  { 2, 9,                        0,     1.5178571428571432E0,    -2.4255952380952381E0,                        0},
+  { 2, 8,    -3.0803571428571432E0,                        0,                        0,    -1.7410714285714288E0},
+  { 2, 7,                        0,    -2.9999999999999996E0,     3.5714285714285698E0,                        0},
+  { 2, 6,     6.0000000000000000E0,                        0,                        0,     4.5000000000000000E0},
+  { 2, 5,                        0,     6.0000000000000000E0,    -9.0000000000000000E0,                        0},
+  { 2, 4,     15.000000000000000E0,                        0,                        0,     15.000000000000000E0},
+  { 1,20,    0.20995489067337439E0,                        0,                        0,  6.0961082623839161E-002},
+  { 1,19,                        0,  6.8718405330882429E-002,   -0.21284829721362286E0,                        0},
+  { 1,18,   -0.22928781638857465E0,                        0,                        0, -7.3457605698529396E-002},
+  { 1,17,                        0, -8.4331253535067915E-002,    0.23374531603506782E0,                        0},
+  { 1,16,    0.25564767263985927E0,                        0,                        0,  9.1271033653845965E-002},
+  { 1,15,                        0,    0.10748470279720285E0,   -0.26300262237762312E0,                        0},
+  { 1,14,   -0.29434367715617660E0,                        0,                        0,   -0.11849868881118869E0},
+  { 1,13,                        0,   -0.14499562937062935E0,    0.30772872960372943E0,                        0},
+  { 1,12,    0.35795454545454575E0,                        0,                        0,    0.16477272727272729E0},
+  { 1,11,                        0,    0.21509740259740262E0,   -0.38636363636363635E0,                        0},
+  { 1,10,   -0.48511904761904767E0,                        0,                        0,   -0.25892857142857134E0},
+  { 1, 9,                        0,   -0.38690476190476197E0,    0.56547619047619058E0,                        0},
+  { 1, 8,    0.89285714285714246E0,                        0,                        0,    0.53571428571428559E0},
+  { 1, 7,                        0,     1.2857142857142858E0,    -1.4285714285714288E0,                        0},
+  { 1, 6,    -3.0000000000000000E0,                        0,                        0,    -3.0000000000000000E0},
+  { 1, 5,                        0,     6.0000000000000000E0,    -6.0000000000000000E0,                        0},
+  { 0,21,                        0,  2.9029086963732933E-003, -9.4910702767949176E-003,                        0},
+  { 0,20, -1.0642414860681144E-002,                        0,                        0, -3.2426107778637863E-003},
+  { 0,19,                        0, -3.8661897736068105E-003,  1.1384313973565135E-002,                        0},
+  { 0,18,  1.2985850890837100E-002,                        0,                        0,  4.3867982890271520E-003},
+  { 0,17,                        0,  5.3688843325791743E-003, -1.4071176984779872E-002,                        0},
+  { 0,16, -1.6437663898601445E-002,                        0,                        0, -6.2240493881118904E-003},
+  { 0,15,                        0, -7.8999125874125789E-003,  1.8157536907536864E-002,                        0},
+  { 0,14,  2.1980623543123530E-002,                        0,                        0,  9.4514860139860123E-003},
+  { 0,13,                        0,  1.2674825174825176E-002, -2.5058275058275081E-002,                        0},
+  { 0,12, -3.2196969696969696E-002,                        0,                        0, -1.5963203463203457E-002},
+  { 0,11,                        0, -2.3538961038961033E-002,  3.8961038961038960E-002,                        0},
+  { 0,10,  5.6547619047619055E-002,                        0,                        0,  3.2738095238095254E-002},
+  { 0, 9,                        0,  5.9523809523809507E-002, -7.9365079365079333E-002,                        0},
+  { 0, 8,   -0.17857142857142860E0,                        0,                        0,   -0.10714285714285716E0},
+  { 0, 7,                        0,   -0.42857142857142855E0,    0.57142857142857140E0,                        0},
+  { 0, 6,    -1.0000000000000000E0,                        0,                        0,    -1.0000000000000000E0},
+  {20, 1,                        0,                        0,     1.0000000000000004E0,                        0},
+  {19, 2,     10.000000000000004E0,                        0,                        0,     3.4999999999999991E0},
+  {19, 1,                        0,                        0,    -1.0000000000000000E0,                        0},
+  {18, 3,                        0,     22.166666666666661E0,    -42.166666666666693E0,                        0},
+  {18, 2,    -9.5000000000000000E0,                        0,                        0,    -3.5000000000000000E0},
+  {18, 1,                        0,                        0,    0.99999999999999978E0,                        0},
+  {17, 4,    -189.75000000000011E0,                        0,                        0,    -62.999999999999972E0},
+  {17, 3,                        0,    -21.000000000000000E0,     39.000000000000000E0,                        0},
+  {17, 2,     8.9999999999999982E0,                        0,                        0,     3.5000000000000022E0},
+  {17, 1,                        0,                        0,    -1.0000000000000000E0,                        0},
+  {16, 5,                        0,    -214.19999999999990E0,     456.82500000000044E0,                        0},
+  {16, 4,     165.75000000000000E0,                        0,                        0,     57.750000000000000E0},
+  {16, 3,                        0,     19.833333333333346E0,    -35.999999999999993E0,                        0},
+  {16, 2,    -8.5000000000000000E0,                        0,                        0,    -3.5000000000000009E0},
+  {16, 1,                        0,                        0,     1.0000000000000004E0,                        0},
+  {15, 6,     1218.2000000000012E0,                        0,                        0,     405.21249999999975E0},
+  {15, 5,                        0,     184.80000000000001E0,    -375.22500000000002E0,                        0},
+  {15, 4,    -143.99999999999997E0,                        0,                        0,    -52.791666666666700E0},
+  {15, 3,                        0,    -18.666666666666671E0,     33.166666666666671E0,                        0},
+  {15, 2,     8.0000000000000036E0,                        0,                        0,     3.5000000000000018E0},
+  {15, 1,                        0,                        0,    -1.0000000000000004E0,                        0},
+  {14, 7,                        0,     868.31249999999955E0,    -2114.2946428571454E0,                        0},
+  {14, 6,    -938.06250000000011E0,                        0,                        0,    -326.81250000000000E0},
+  {14, 5,                        0,    -158.37500000000011E0,     305.62499999999989E0,                        0},
+  {14, 4,     124.37500000000001E0,                        0,                        0,     48.125000000000014E0},
+  {14, 3,                        0,     17.500000000000007E0,    -30.500000000000011E0,                        0},
+  {14, 2,    -7.5000000000000036E0,                        0,                        0,    -3.4999999999999996E0},
+  {14, 1,                        0,                        0,    0.99999999999999956E0,                        0},
+  {13, 8,    -3700.0156250000045E0,                        0,                        0,    -1239.7656249999991E0},
+  {13, 7,                        0,    -653.62500000000000E0,     1514.0000000000000E0,                        0},
+  {13, 6,     713.12499999999977E0,                        0,                        0,     260.75000000000023E0},
+  {13, 5,                        0,     134.75000000000006E0,    -246.75000000000000E0,                        0},
+  {13, 4,    -106.75000000000004E0,                        0,                        0,    -43.750000000000036E0},
+  {13, 3,                        0,    -16.333333333333332E0,     28.000000000000021E0,                        0},
+  {13, 2,     6.9999999999999964E0,                        0,                        0,     3.4999999999999982E0},
+  {13, 1,                        0,                        0,   -0.99999999999999956E0,                        0},
+  {12, 9,                        0,    -1790.7725694444430E0,     4626.2282986111168E0,                        0},
+  {12, 8,     2460.2500000000000E0,                        0,                        0,     864.06249999999989E0},
+  {12, 7,                        0,     484.25000000000034E0,    -1064.1249999999995E0,                        0},
+  {12, 6,    -534.62500000000000E0,                        0,                        0,    -205.62500000000011E0},
+  {12, 5,                        0,    -113.75000000000009E0,     197.40000000000012E0,                        0},
+  {12, 4,     91.000000000000071E0,                        0,                        0,     39.666666666666671E0},
+  {12, 3,                        0,     15.166666666666659E0,    -25.666666666666657E0,                        0},
+  {12, 2,    -6.4999999999999973E0,                        0,                        0,    -3.4999999999999991E0},
+  {12, 1,                        0,                        0,    0.99999999999999978E0,                        0},
+  {11,10,     5551.4739583333403E0,                        0,                        0,     1865.3815104166647E0},
+  {11, 9,                        0,     1152.0833333333330E0,    -2835.4557291666661E0,                        0},
+  {11, 8,    -1596.1874999999993E0,                        0,                        0,    -588.82812500000057E0},
+  {11, 7,                        0,    -352.50000000000017E0,     732.62500000000011E0,                        0},
+  {11, 6,     394.80000000000024E0,                        0,                        0,     160.12500000000023E0},
+  {11, 5,                        0,     95.200000000000003E0,    -156.45000000000016E0,                        0},
+  {11, 4,    -76.999999999999972E0,                        0,                        0,    -35.874999999999979E0},
+  {11, 3,                        0,    -13.999999999999996E0,     23.499999999999993E0,                        0},
+  {11, 2,     5.9999999999999982E0,                        0,                        0,     3.5000000000000009E0},
+  {11, 1,                        0,                        0,    -1.0000000000000002E0,                        0},
+  {10,11,                        0,     1865.3815104166647E0,    -4968.3867187500073E0,                        0},
+  {10,10,    -3119.0013020833330E0,                        0,                        0,    -1098.9544270833333E0},
+  {10, 9,                        0,    -719.67881944444514E0,     1683.3723958333330E0,                        0},
+  {10, 8,     1007.3593750000001E0,                        0,                        0,     391.20312500000023E0},
+  {10, 7,                        0,     251.62500000000034E0,    -492.92500000000041E0,                        0},
+  {10, 6,    -286.82500000000033E0,                        0,                        0,    -123.02500000000002E0},
+  {10, 5,                        0,    -78.924999999999955E0,     122.84999999999997E0,                        0},
+  {10, 4,     64.624999999999986E0,                        0,                        0,     32.374999999999986E0},
+  {10, 3,                        0,     12.833333333333336E0,    -21.499999999999996E0,                        0},
+  {10, 2,    -5.5000000000000009E0,                        0,                        0,    -3.5000000000000009E0},
+  {10, 1,                        0,                        0,    0.99999999999999956E0,                        0},
+  { 9,12,    -4140.3222656250064E0,                        0,                        0,    -1393.0820312499982E0},
+  { 9,11,                        0,    -999.04947916666652E0,     2535.9140624999995E0,                        0},
+  { 9,10,     1683.3723958333330E0,                        0,                        0,     623.30946180555623E0},
+  { 9, 9,                        0,     434.67013888888914E0,    -963.69357638888891E0,                        0},
+  { 9, 8,    -616.15625000000045E0,                        0,                        0,    -252.50000000000040E0},
+  { 9, 7,                        0,    -175.75000000000003E0,     323.25000000000045E0,                        0},
+  { 9, 6,     204.74999999999994E0,                        0,                        0,     93.187499999999929E0},
+  { 9, 5,                        0,     64.749999999999972E0,    -95.624999999999972E0,                        0},
+  { 9, 4,    -53.749999999999993E0,                        0,                        0,    -29.166666666666675E0},
+  { 9, 3,                        0,    -11.666666666666670E0,     19.666666666666671E0,                        0},
+  { 9, 2,     4.9999999999999982E0,                        0,                        0,     3.4999999999999982E0},
+  { 9, 1,                        0,                        0,   -0.99999999999999967E0,                        0},
+  { 8,13,                        0,    -964.44140624999875E0,     2618.3623046875045E0,                        0},
+  { 8,12,     1901.9355468749998E0,                        0,                        0,     671.13867187499977E0},
+  { 8,11,                        0,     509.98046875000057E0,    -1230.7968749999993E0,                        0},
+  { 8,10,    -867.32421875000000E0,                        0,                        0,    -338.30078125000017E0},
+  { 8, 9,                        0,    -252.50000000000040E0,     529.02343750000045E0,                        0},
+  { 8, 8,     363.65625000000051E0,                        0,                        0,     157.65625000000003E0},
+  { 8, 7,                        0,     119.81249999999990E0,    -205.99999999999989E0,                        0},
+  { 8, 6,    -143.43749999999994E0,                        0,                        0,    -69.562499999999972E0},
+  { 8, 5,                        0,    -52.500000000000014E0,     73.874999999999986E0,                        0},
+  { 8, 4,     44.250000000000014E0,                        0,                        0,     26.250000000000004E0},
+  { 8, 3,                        0,     10.499999999999995E0,    -18.000000000000000E0,                        0},
+  { 8, 2,    -4.4999999999999982E0,                        0,                        0,    -3.5000000000000009E0},
+  { 8, 1,                        0,                        0,     1.0000000000000000E0,                        0},
+  { 7,14,     1496.2070312500025E0,                        0,                        0,     503.83349609374926E0},
+  { 7,13,                        0,     413.00841346153834E0,    -1068.7099609375000E0,                        0},
+  { 7,12,    -820.53124999999955E0,                        0,                        0,    -304.33691406250034E0},
+  { 7,11,                        0,    -246.03693181818193E0,     563.12109374999989E0,                        0},
+  { 7,10,     423.21875000000040E0,                        0,                        0,     174.34765625000037E0},
+  { 7, 9,                        0,     140.13888888888891E0,    -276.52343750000045E0,                        0},
+  { 7, 8,    -205.99999999999989E0,                        0,                        0,    -94.726562499999901E0},
+  { 7, 7,                        0,    -79.499999999999972E0,     127.16964285714278E0,                        0},
+  { 7, 6,     98.499999999999986E0,                        0,                        0,     51.187500000000021E0},
+  { 7, 5,                        0,     42.000000000000007E0,    -56.775000000000013E0,                        0},
+  { 7, 4,    -36.000000000000000E0,                        0,                        0,    -23.624999999999993E0},
+  { 7, 3,                        0,    -9.3333333333333357E0,     16.499999999999993E0,                        0},
+  { 7, 2,     4.0000000000000000E0,                        0,                        0,     3.5000000000000009E0},
+  { 7, 1,                        0,                        0,    -1.0000000000000000E0,                        0},
+  { 7, 0,     1.0000000000000000E0,                        0,                        0,     1.0000000000000000E0},
+  { 6,15,                        0,     235.12229817708300E0,    -646.81077473958453E0,                        0},
+  { 6,14,    -534.35498046875000E0,                        0,                        0,    -188.72892878605762E0},
+  { 6,13,                        0,    -163.87372295673094E0,     403.23039362980739E0,                        0},
+  { 6,12,     328.48730468749994E0,                        0,                        0,     128.37455610795459E0},
+  { 6,11,                        0,     110.94850852272751E0,    -240.13529829545473E0,                        0},
+  { 6,10,    -193.56640625000031E0,                        0,                        0,    -84.458767361111128E0},
+  { 6, 9,                        0,    -73.676215277777700E0,     136.38454861111103E0,                        0},
+  { 6, 8,     111.27343749999993E0,                        0,                        0,     54.414062499999972E0},
+  { 6, 7,                        0,     51.187500000000021E0,    -75.812499999999986E0,                        0},
+  { 6, 6,    -66.237500000000011E0,                        0,                        0,    -37.187500000000021E0},
+  { 6, 5,                        0,    -33.074999999999989E0,     43.574999999999996E0,                        0},
+  { 6, 4,     28.874999999999986E0,                        0,                        0,     21.291666666666668E0},
+  { 6, 3,                        0,     8.1666666666666679E0,    -15.166666666666668E0,                        0},
+  { 6, 2,    -3.5000000000000000E0,                        0,                        0,    -3.4999999999999996E0},
+  { 6, 1,                        0,     7.0000000000000000E0,    -7.0000000000000000E0,                        0},
+  { 5,16,    -242.55404052734420E0,                        0,                        0,    -81.722521972656125E0},
+  { 5,15,                        0,    -75.491571514423057E0,     197.94648437500001E0,                        0},
+  { 5,14,     172.81302584134602E0,                        0,                        0,     64.161583533653925E0},
+  { 5,13,                        0,     59.249795126748268E0,    -138.28365384615381E0,                        0},
+  { 5,12,    -120.06764914772737E0,                        0,                        0,    -49.572975852272840E0},
+  { 5,11,                        0,    -46.068418560606077E0,     93.992897727272918E0,                        0},
+  { 5,10,     81.830729166666629E0,                        0,                        0,     37.934895833333279E0},
+  { 5, 9,                        0,     36.276041666666643E0,    -62.708333333333300E0,                        0},
+  { 5, 8,    -56.859374999999986E0,                        0,                        0,    -29.640625000000018E0},
+  { 5, 7,                        0,    -31.875000000000014E0,     43.550000000000011E0,                        0},
+  { 5, 6,     43.574999999999996E0,                        0,                        0,     26.774999999999984E0},
+  { 5, 5,                        0,     25.550000000000004E0,    -33.599999999999994E0,                        0},
+  { 5, 4,    -22.750000000000000E0,                        0,                        0,    -19.250000000000004E0},
+  { 5, 3,                        0,    -6.9999999999999991E0,     14.000000000000000E0,                        0},
+  { 5, 2,    -21.000000000000000E0,                        0,                        0,    -21.000000000000000E0},
+  { 4,17,                        0,    -24.036035874310624E0,     66.764594582950508E0,                        0},
+  { 4,16,     61.858276367187500E0,                        0,                        0,     21.860999474158646E0},
+  { 4,15,                        0,     21.387194511217977E0,    -53.329702524038424E0,                        0},
+  { 4,14,    -49.387019230769212E0,                        0,                        0,    -19.322757320804197E0},
+  { 4,13,                        0,    -19.066529173951093E0,     42.089966673951082E0,                        0},
+  { 4,12,     39.163707386363711E0,                        0,                        0,     17.132930871212125E0},
+  { 4,11,                        0,     17.243134469696948E0,    -33.046164772727259E0,                        0},
+  { 4,10,    -31.354166666666650E0,                        0,                        0,    -15.494791666666655E0},
+  { 4, 9,                        0,    -16.467013888888900E0,     26.432291666666661E0,                        0},
+  { 4, 8,     27.218750000000007E0,                        0,                        0,     15.156250000000007E0},
+  { 4, 7,                        0,     19.124999999999989E0,    -24.125000000000000E0,                        0},
+  { 4, 6,    -27.999999999999993E0,                        0,                        0,    -19.250000000000004E0},
+  { 4, 5,                        0,    -19.250000000000004E0,     26.250000000000000E0,                        0},
+  { 4, 4,     17.500000000000000E0,                        0,                        0,     17.500000000000000E0},
+  { 4, 3,                        0,    -35.000000000000000E0,     35.000000000000000E0,                        0},
+  { 3,18,     14.836576573989003E0,                        0,                        0,     5.0007898667279340E0},
+  { 3,17,                        0,     5.1437645821549758E0,    -13.618781594669116E0,                        0},
+  { 3,16,    -13.332425631009606E0,                        0,                        0,    -4.9533816606570564E0},
+  { 3,15,                        0,    -5.1527352855477861E0,     12.187700320512816E0,                        0},
+  { 3,14,     12.025704763986024E0,                        0,                        0,     4.9715909090909207E0},
+  { 3,13,                        0,     5.2716710372960387E0,    -10.973065996503523E0,                        0},
+  { 3,12,    -11.015388257575752E0,                        0,                        0,    -5.1223958333333259E0},
+  { 3,11,                        0,    -5.6344696969696928E0,     10.102272727272720E0,                        0},
+  { 3,10,     10.572916666666664E0,                        0,                        0,     5.5902777777777803E0},
+  { 3, 9,                        0,     6.7361111111111143E0,    -9.9652777777777839E0,                        0},
+  { 3, 8,    -12.062500000000000E0,                        0,                        0,    -7.1874999999999929E0},
+  { 3, 7,                        0,    -11.000000000000002E0,     12.999999999999995E0,                        0},
+  { 3, 6,     17.500000000000000E0,                        0,                        0,     14.000000000000000E0},
+  { 3, 5,                        0,     14.000000000000000E0,    -20.999999999999996E0,                        0},
+  { 3, 4,     35.000000000000000E0,                        0,                        0,     35.000000000000000E0},
+  { 2,19,                        0,    0.78959840000967374E0,    -2.2095482415828229E0,                        0},
+  { 2,18,    -2.2697969324448524E0,                        0,                        0,   -0.80250735736001100E0},
+  { 2,17,                        0,   -0.87412617541006876E0,     2.2009343626272608E0,                        0},
+  { 2,16,     2.2851938100961529E0,                        0,                        0,    0.89476685423951052E0},
+  { 2,15,                        0,    0.99431818181818410E0,    -2.2246831293706308E0,                        0},
+  { 2,14,    -2.3513712849650408E0,                        0,                        0,    -1.0302028700466204E0},
+  { 2,13,                        0,    -1.1820913461538445E0,     2.3120447261072243E0,                        0},
+  { 2,12,     2.5255681818181799E0,                        0,                        0,     1.2528409090909078E0},
+  { 2,11,                        0,     1.5246212121212128E0,    -2.5454545454545441E0,                        0},
+  { 2,10,    -2.9895833333333348E0,                        0,                        0,    -1.6979166666666683E0},
+  { 2, 9,                        0,    -2.3958333333333308E0,     3.2291666666666661E0,                        0},
+  { 2, 8,     4.8749999999999982E0,                        0,                        0,     3.1250000000000004E0},
+  { 2, 7,                        0,     6.0000000000000000E0,    -7.0000000000000000E0,                        0},
+  { 2, 6,    -10.499999999999998E0,                        0,                        0,    -10.500000000000000E0},
+  { 2, 5,                        0,     21.000000000000000E0,    -21.000000000000000E0,                        0},
+  { 1,20,   -0.22095482415828230E0,                        0,                        0, -7.4496904024767746E-002},
+  { 1,19,                        0, -8.4474458669474839E-002,    0.22531987712848295E0,                        0},
+  { 1,18,    0.24454826251414008E0,                        0,                        0,  9.0900956235859767E-002},
+  { 1,17,                        0,    0.10526668873406006E0,   -0.25142286481900439E0,                        0},
+  { 1,16,   -0.27808539117132886E0,                        0,                        0,   -0.11506364729021014E0},
+  { 1,15,                        0,   -0.13736038267288272E0,    0.28981643356643427E0,                        0},
+  { 1,14,    0.33029210372960349E0,                        0,                        0,    0.15386436480186458E0},
+  { 1,13,                        0,    0.19274475524475507E0,   -0.35285547785547766E0,                        0},
+  { 1,12,   -0.42424242424242398E0,                        0,                        0,   -0.22537878787878790E0},
+  { 1,11,                        0,   -0.30871212121212149E0,    0.47727272727272751E0,                        0},
+  { 1,10,    0.64583333333333326E0,                        0,                        0,    0.39583333333333298E0},
+  { 1, 9,                        0,    0.69444444444444453E0,   -0.83333333333333304E0,                        0},
+  { 1, 8,    -1.7500000000000000E0,                        0,                        0,    -1.2500000000000000E0},
+  { 1, 7,                        0,    -3.0000000000000000E0,     4.0000000000000000E0,                        0},
+  { 1, 6,    -7.0000000000000000E0,                        0,                        0,    -7.0000000000000000E0},
+  { 0,21,                        0, -3.5474716202270355E-003,  9.9851823953265827E-003,                        0},
+  { 0,20,  1.1265993856424147E-002,                        0,                        0,  3.9845098907477974E-003},
+  { 0,19,                        0,  4.7842608545189350E-003, -1.2135806609460580E-002,                        0},
+  { 0,18, -1.3967936934389132E-002,                        0,                        0, -5.4721243829699779E-003},
+  { 0,17,                        0, -6.7684498406005962E-003,  1.5292462592554510E-002,                        0},
+  { 0,16,  1.8113527097902142E-002,                        0,                        0,  7.9439223970473993E-003},
+  { 0,15,                        0,  1.0257624320124305E-002, -2.0339209401709388E-002,                        0},
+  { 0,14, -2.5203962703962690E-002,                        0,                        0, -1.2529137529137516E-002},
+  { 0,13,                        0, -1.7336829836829840E-002,  2.9574592074592052E-002,                        0},
+  { 0,12,  3.9772727272727293E-002,                        0,                        0,  2.2727272727272731E-002},
+  { 0,11,                        0,  3.5984848484848453E-002, -5.1136363636363653E-002,                        0},
+  { 0,10, -8.3333333333333301E-002,                        0,                        0, -5.5555555555555566E-002},
+  { 0, 9,                        0,   -0.13888888888888890E0,    0.13888888888888890E0,                        0},
+  { 0, 8,    0.50000000000000000E0,                        0,                        0,    0.50000000000000000E0},
+  { 0, 7,                        0,    -1.0000000000000000E0,     1.0000000000000000E0,                        0},
+  {20, 1,                        0,                        0,   -0.99999999999999956E0,                        0},
+  {19, 2,    -9.9999999999999964E0,                        0,                        0,    -4.0000000000000036E0},
+  {19, 1,                        0,                        0,     1.0000000000000004E0,                        0},
+  {18, 3,                        0,    -25.333333333333353E0,     45.666666666666643E0,                        0},
+  {18, 2,     9.5000000000000036E0,                        0,                        0,     4.0000000000000009E0},
+  {18, 1,                        0,                        0,   -0.99999999999999967E0,                        0},
+  {17, 4,     205.49999999999989E0,                        0,                        0,     78.000000000000071E0},
+  {17, 3,                        0,     24.000000000000007E0,    -42.500000000000028E0,                        0},
+  {17, 2,    -8.9999999999999964E0,                        0,                        0,    -4.0000000000000000E0},
+  {17, 1,                        0,                        0,     1.0000000000000004E0,                        0},
+  {16, 5,                        0,     265.20000000000022E0,    -496.72499999999962E0,                        0},
+  {16, 4,    -180.62500000000011E0,                        0,                        0,    -72.000000000000028E0},
+  {16, 3,                        0,    -22.666666666666664E0,     39.499999999999986E0,                        0},
+  {16, 2,     8.5000000000000036E0,                        0,                        0,     4.0000000000000000E0},
+  {16, 1,                        0,                        0,   -0.99999999999999956E0,                        0},
+  {15, 6,    -1324.5999999999990E0,                        0,                        0,    -500.30000000000064E0},
+  {15, 5,                        0,    -230.40000000000009E0,     412.15000000000043E0,                        0},
+  {15, 4,     157.99999999999994E0,                        0,                        0,     66.333333333333329E0},
+  {15, 3,                        0,     21.333333333333336E0,    -36.666666666666686E0,                        0},
+  {15, 2,    -7.9999999999999964E0,                        0,                        0,    -3.9999999999999978E0},
+  {15, 1,                        0,                        0,     1.0000000000000000E0,                        0},
+  {14, 7,                        0,    -1072.0714285714298E0,     2273.1071428571399E0,                        0},
+  {14, 6,     1030.3750000000009E0,                        0,                        0,     407.50000000000017E0},
+  {14, 5,                        0,     199.00000000000000E0,    -339.74999999999977E0,                        0},
+  {14, 4,    -137.50000000000006E0,                        0,                        0,    -61.000000000000000E0},
+  {14, 3,                        0,    -19.999999999999989E0,     33.999999999999979E0,                        0},
+  {14, 2,     7.5000000000000000E0,                        0,                        0,     4.0000000000000000E0},
+  {14, 1,                        0,                        0,    -1.0000000000000007E0,                        0},
+  {13, 8,     3977.9374999999950E0,                        0,                        0,     1514.0000000000023E0},
+  {13, 7,                        0,     815.00000000000034E0,    -1642.6250000000020E0,                        0},
+  {13, 6,    -792.74999999999943E0,                        0,                        0,    -329.00000000000000E0},
+  {13, 5,                        0,    -170.79999999999998E0,     278.25000000000023E0,                        0},
+  {13, 4,     118.99999999999993E0,                        0,                        0,     55.999999999999972E0},
+  {13, 3,                        0,     18.666666666666668E0,    -31.500000000000000E0,                        0},
+  {13, 2,    -7.0000000000000044E0,                        0,                        0,    -4.0000000000000000E0},
+  {13, 1,                        0,                        0,     1.0000000000000004E0,                        0},
+  {12, 9,                        0,     2186.8888888888923E0,    -4947.6085069444371E0,                        0},
+  {12, 8,    -2669.2656250000032E0,                        0,                        0,    -1064.1250000000007E0},
+  {12, 7,                        0,    -611.00000000000000E0,     1167.3749999999989E0,                        0},
+  {12, 6,     602.87500000000045E0,                        0,                        0,     263.19999999999999E0},
+  {12, 5,                        0,     145.59999999999991E0,    -226.44999999999976E0,                        0},
+  {12, 4,    -102.37500000000000E0,                        0,                        0,    -51.333333333333329E0},
+  {12, 3,                        0,    -17.333333333333336E0,     29.166666666666679E0,                        0},
+  {12, 2,     6.5000000000000027E0,                        0,                        0,     4.0000000000000000E0},
+  {12, 1,                        0,                        0,    -1.0000000000000002E0,                        0},
+  {11,10,    -5937.1302083333248E0,                        0,                        0,    -2268.3645833333376E0},
+  {11, 9,                        0,    -1418.8333333333342E0,     3057.3046875000045E0,                        0},
+  {11, 8,     1751.0624999999982E0,                        0,                        0,     732.62500000000000E0},
+  {11, 7,                        0,     451.20000000000005E0,    -814.75000000000102E0,                        0},
+  {11, 6,    -452.89999999999952E0,                        0,                        0,    -208.59999999999982E0},
+  {11, 5,                        0,    -123.19999999999999E0,     183.22499999999999E0,                        0},
+  {11, 4,     87.500000000000028E0,                        0,                        0,     47.000000000000014E0},
+  {11, 3,                        0,     16.000000000000000E0,    -27.000000000000014E0,                        0},
+  {11, 2,    -6.0000000000000018E0,                        0,                        0,    -4.0000000000000000E0},
+  {11, 1,                        0,                        0,    0.99999999999999978E0,                        0},
+  {10,11,                        0,    -2268.3645833333376E0,     5300.9140624999909E0,                        0},
+  {10,10,     3363.0351562500050E0,                        0,                        0,     1346.6979166666679E0},
+  {10, 9,                        0,     895.43055555555543E0,    -1833.0338541666649E0,                        0},
+  {10, 8,    -1120.2812500000014E0,                        0,                        0,    -492.92500000000001E0},
+  {10, 7,                        0,    -327.79999999999973E0,     557.64999999999918E0,                        0},
+  {10, 6,     335.91249999999997E0,                        0,                        0,     163.79999999999995E0},
+  {10, 5,                        0,     103.40000000000002E0,    -147.52500000000009E0,                        0},
+  {10, 4,    -74.250000000000043E0,                        0,                        0,    -43.000000000000007E0},
+  {10, 3,                        0,    -14.666666666666666E0,     25.000000000000007E0,                        0},
+  {10, 2,     5.4999999999999991E0,                        0,                        0,     3.9999999999999991E0},
+  {10, 1,                        0,                        0,   -0.99999999999999978E0,                        0},
+  { 9,12,     4417.4283854166597E0,                        0,                        0,     1690.6093750000034E0},
+  { 9,11,                        0,     1224.2708333333344E0,    -2726.8190104166715E0,                        0},
+  { 9,10,    -1833.0338541666649E0,                        0,                        0,    -770.95486111111109E0},
+  { 9, 9,                        0,    -547.69444444444446E0,     1062.0789930555570E0,                        0},
+  { 9, 8,     697.06249999999898E0,                        0,                        0,     323.24999999999966E0},
+  { 9, 7,                        0,     233.99999999999991E0,    -373.81249999999994E0,                        0},
+  { 9, 6,    -245.87500000000011E0,                        0,                        0,    -127.50000000000000E0},
+  { 9, 5,                        0,    -86.000000000000014E0,     118.37500000000006E0,                        0},
+  { 9, 4,     62.500000000000014E0,                        0,                        0,     39.333333333333329E0},
+  { 9, 3,                        0,     13.333333333333330E0,    -23.166666666666668E0,                        0},
+  { 9, 2,    -4.9999999999999991E0,                        0,                        0,    -3.9999999999999991E0},
+  { 9, 1,                        0,                        0,     1.0000000000000000E0,                        0},
+  { 8,13,                        0,     1170.4218750000023E0,    -2789.6940354567259E0,                        0},
+  { 8,12,    -2045.1142578125036E0,                        0,                        0,    -820.53125000000068E0},
+  { 8,11,                        0,    -630.78125000000000E0,     1335.9087357954527E0,                        0},
+  { 8,10,     955.87109375000125E0,                        0,                        0,     423.21875000000011E0},
+  { 8, 9,                        0,     323.24999999999966E0,    -591.83593749999898E0,                        0},
+  { 8, 8,    -420.53906249999994E0,                        0,                        0,    -205.99999999999994E0},
+  { 8, 7,                        0,    -163.92857142857144E0,     245.18750000000009E0,                        0},
+  { 8, 6,     177.56250000000009E0,                        0,                        0,     98.500000000000028E0},
+  { 8, 5,                        0,     70.799999999999997E0,    -94.875000000000014E0,                        0},
+  { 8, 4,    -52.125000000000000E0,                        0,                        0,    -35.999999999999993E0},
+  { 8, 3,                        0,    -11.999999999999996E0,     21.500000000000000E0,                        0},
+  { 8, 2,     4.5000000000000000E0,                        0,                        0,     4.0000000000000000E0},
+  { 8, 1,                        0,                        0,    -1.0000000000000000E0,                        0},
+  { 8, 0,     1.0000000000000000E0,                        0,                        0,     1.0000000000000000E0},
+  { 7,14,    -1594.1108774038435E0,                        0,                        0,    -610.69140625000136E0},
+  { 7,13,                        0,    -504.94230769230813E0,     1147.3227163461561E0,                        0},
+  { 7,12,     890.60582386363512E0,                        0,                        0,     375.41406250000006E0},
+  { 7,11,                        0,     307.79545454545462E0,    -618.23011363636465E0,                        0},
+  { 7,10,    -473.46874999999915E0,                        0,                        0,    -221.21874999999974E0},
+  { 7, 9,                        0,    -183.11111111111106E0,     315.31249999999994E0,                        0},
+  { 7, 8,     245.18750000000009E0,                        0,                        0,     127.16964285714288E0},
+  { 7, 7,                        0,     112.57142857142861E0,    -157.35714285714295E0,                        0},
+  { 7, 6,    -126.50000000000001E0,                        0,                        0,    -75.700000000000003E0},
+  { 7, 5,                        0,    -57.599999999999987E0,     76.199999999999989E0,                        0},
+  { 7, 4,     43.000000000000000E0,                        0,                        0,     33.000000000000000E0},
+  { 7, 3,                        0,     10.666666666666666E0,    -20.000000000000000E0,                        0},
+  { 7, 2,    -4.0000000000000000E0,                        0,                        0,    -4.0000000000000000E0},
+  { 7, 1,                        0,     8.0000000000000000E0,    -8.0000000000000000E0,                        0},
+  { 6,15,                        0,    -284.98932291666728E0,     688.49090544871660E0,                        0},
+  { 6,14,     573.66135817307804E0,                        0,                        0,     230.41736778846177E0},
+  { 6,13,                        0,     202.14603365384616E0,    -436.85598776223719E0,                        0},
+  { 6,12,    -360.63423295454606E0,                        0,                        0,    -160.09019886363643E0},
+  { 6,11,                        0,    -140.77556818181802E0,     267.39204545454487E0,                        0},
+  { 6,10,     220.71874999999994E0,                        0,                        0,     109.10763888888883E0},
+  { 6, 9,                        0,     98.909722222222243E0,    -159.44444444444457E0,                        0},
+  { 6, 8,    -137.68750000000009E0,                        0,                        0,    -75.812500000000043E0},
+  { 6, 7,                        0,    -75.700000000000003E0,     99.000000000000014E0,                        0},
+  { 6, 6,     88.899999999999991E0,                        0,                        0,     58.099999999999980E0},
+  { 6, 5,                        0,     46.199999999999996E0,    -61.599999999999980E0,                        0},
+  { 6, 4,    -35.000000000000000E0,                        0,                        0,    -30.333333333333332E0},
+  { 6, 3,                        0,    -9.3333333333333321E0,     18.666666666666671E0,                        0},
+  { 6, 2,    -28.000000000000000E0,                        0,                        0,    -27.999999999999996E0},
+  { 5,16,     258.18408954326873E0,                        0,                        0,     98.973242187500205E0},
+  { 5,15,                        0,     92.166947115384701E0,    -212.28112980769279E0,                        0},
+  { 5,14,    -187.22399475524452E0,                        0,                        0,    -79.019230769230788E0},
+  { 5,13,                        0,    -73.887784090909122E0,     151.48666958041989E0,                        0},
+  { 5,12,     133.69602272727244E0,                        0,                        0,     62.661931818181742E0},
+  { 5,11,                        0,     59.513257575757549E0,    -106.55113636363632E0,                        0},
+  { 5,10,    -95.666666666666742E0,                        0,                        0,    -50.166666666666679E0},
+  { 5, 9,                        0,    -50.541666666666700E0,     75.833333333333371E0,                        0},
+  { 5, 8,     74.250000000000014E0,                        0,                        0,     43.550000000000004E0},
+  { 5, 7,                        0,     49.799999999999983E0,    -61.399999999999999E0,                        0},
+  { 5, 6,    -61.599999999999980E0,                        0,                        0,    -44.800000000000004E0},
+  { 5, 5,                        0,    -36.399999999999999E0,     50.399999999999991E0,                        0},
+  { 5, 4,     28.000000000000007E0,                        0,                        0,     28.000000000000004E0},
+  { 5, 3,                        0,    -55.999999999999993E0,     56.000000000000000E0,                        0},
+  { 4,17,                        0,     29.109777113970647E0,    -71.019263910491901E0,                        0},
+  { 4,16,    -66.337853064903996E0,                        0,                        0,    -26.664851262019255E0},
+  { 4,15,                        0,    -26.339743589743595E0,     57.706184440559340E0,                        0},
+  { 4,14,     54.102381993007100E0,                        0,                        0,     24.051409527972037E0},
+  { 4,13,                        0,     24.100743006992978E0,    -46.745957167832067E0,                        0},
+  { 4,12,    -44.396306818181799E0,                        0,                        0,    -22.030776515151505E0},
+  { 4,11,                        0,    -22.803030303030308E0,     38.340909090909108E0,                        0},
+  { 4,10,     37.916666666666686E0,                        0,                        0,     21.145833333333350E0},
+  { 4, 9,                        0,     24.194444444444446E0,    -33.541666666666679E0,                        0},
+  { 4, 8,    -38.375000000000000E0,                        0,                        0,    -24.124999999999989E0},
+  { 4, 7,                        0,    -32.000000000000000E0,     37.999999999999993E0,                        0},
+  { 4, 6,     41.999999999999993E0,                        0,                        0,     35.000000000000000E0},
+  { 4, 5,                        0,     28.000000000000004E0,    -42.000000000000000E0,                        0},
+  { 4, 4,     70.000000000000000E0,                        0,                        0,     70.000000000000000E0},
+  { 3,18,    -15.782058646775978E0,                        0,                        0,    -6.0527918198529553E0},
+  { 3,17,                        0,    -6.2740826498868838E0,     14.593900240384651E0,                        0},
+  { 3,16,     14.426546110139835E0,                        0,                        0,     6.0938501602564106E0},
+  { 3,15,                        0,     6.4137092074592097E0,    -13.332313519813550E0,                        0},
+  { 3,14,    -13.355987762237733E0,                        0,                        0,    -6.2703234265734169E0},
+  { 3,13,                        0,    -6.7787004662004628E0,     12.399912587412580E0,                        0},
+  { 3,12,     12.780303030303035E0,                        0,                        0,     6.7348484848484853E0},
+  { 3,11,                        0,     7.6893939393939457E0,    -12.090909090909099E0,                        0},
+  { 3,10,    -13.416666666666671E0,                        0,                        0,    -7.9722222222222241E0},
+  { 3, 9,                        0,    -10.722222222222218E0,     13.611111111111109E0,                        0},
+  { 3, 8,     18.999999999999996E0,                        0,                        0,     13.000000000000000E0},
+  { 3, 7,                        0,     20.000000000000000E0,    -24.000000000000000E0,                        0},
+  { 3, 6,    -28.000000000000000E0,                        0,                        0,    -28.000000000000000E0},
+  { 3, 5,                        0,     56.000000000000000E0,    -55.999999999999993E0,                        0},
+  { 2,19,                        0,   -0.95570397155572984E0,     2.3491688869373601E0,                        0},
+  { 2,18,     2.4323167067307749E0,                        0,                        0,    0.97819305005656232E0},
+  { 2,17,                        0,     1.0753853223981902E0,    -2.3794750745577899E0,                        0},
+  { 2,16,    -2.4998087849650403E0,                        0,                        0,    -1.1123415646853154E0},
+  { 2,15,                        0,    -1.2540646853146833E0,     2.4666083916083856E0,                        0},
+  { 2,14,     2.6571241258741241E0,                        0,                        0,     1.3211684149184137E0},
+  { 2,13,                        0,     1.5541958041958042E0,    -2.6719114219114233E0,                        0},
+  { 2,12,    -3.0227272727272747E0,                        0,                        0,    -1.6969696969696986E0},
+  { 2,11,                        0,    -2.1742424242424248E0,     3.1818181818181830E0,                        0},
+  { 2,10,     4.0833333333333330E0,                        0,                        0,     2.5833333333333321E0},
+  { 2, 9,                        0,     4.3333333333333330E0,    -4.9999999999999991E0,                        0},
+  { 2, 8,    -9.0000000000000000E0,                        0,                        0,    -6.9999999999999991E0},
+  { 2, 7,                        0,    -12.000000000000000E0,     16.000000000000000E0,                        0},
+  { 2, 6,    -27.999999999999996E0,                        0,                        0,    -28.000000000000000E0},
+  { 1,20,    0.23491688869373600E0,                        0,                        0,  9.0127950851393385E-002},
+  { 1,19,                        0,    0.10296768947963814E0,   -0.24131489640390638E0,                        0},
+  { 1,18,   -0.26438611939530998E0,                        0,                        0,   -0.11174349547511309E0},
+  { 1,17,                        0,   -0.13086371349239004E0,    0.27475672305635618E0,                        0},
+  { 1,16,    0.30832604895104820E0,                        0,                        0,    0.14490821678321664E0},
+  { 1,15,                        0,    0.17615578865578849E0,   -0.32683566433566402E0,                        0},
+  { 1,14,   -0.38170163170163190E0,                        0,                        0,   -0.20163170163170166E0},
+  { 1,13,                        0,   -0.26107226107226134E0,    0.42016317016317056E0,                        0},
+  { 1,12,    0.53030303030303050E0,                        0,                        0,    0.31818181818181829E0},
+  { 1,11,                        0,    0.46969696969696950E0,   -0.63636363636363646E0,                        0},
+  { 1,10,   -0.99999999999999978E0,                        0,                        0,   -0.66666666666666674E0},
+  { 1, 9,                        0,    -1.5555555555555554E0,     1.6666666666666670E0,                        0},
+  { 1, 8,     4.0000000000000000E0,                        0,                        0,     4.0000000000000000E0},
+  { 1, 7,                        0,    -8.0000000000000000E0,     8.0000000000000000E0,                        0},
+  { 0,21,                        0,  4.2918071833996851E-003, -1.0611959232073387E-002,                        0},
+  { 0,20, -1.2065744820195319E-002,                        0,                        0, -4.8543226437842389E-003},
+  { 0,19,                        0, -5.8812366039533203E-003,  1.3111676684383700E-002,                        0},
+  { 0,18,  1.5264262392019789E-002,                        0,                        0,  6.7966500411353360E-003},
+  { 0,17,                        0,  8.5240127519539202E-003, -1.6935224701768774E-002,                        0},
+  { 0,16, -2.0427229020979001E-002,                        0,                        0, -1.0169604700854687E-002},
+  { 0,15,                        0, -1.3442113442113443E-002,  2.3445998445998463E-002,                        0},
+  { 0,14,  3.0011655011655040E-002,                        0,                        0,  1.6899766899766914E-002},
+  { 0,13,                        0,  2.4475524475524483E-002, -3.6713286713286705E-002,                        0},
+  { 0,12, -5.3030303030303039E-002,                        0,                        0, -3.4090909090909075E-002},
+  { 0,11,                        0, -6.0606060606060608E-002,  7.5757575757575732E-002,                        0},
+  { 0,10,    0.16666666666666669E0,                        0,                        0,    0.11111111111111113E0},
+  { 0, 9,                        0,    0.44444444444444442E0,   -0.55555555555555558E0,                        0},
+  { 0, 8,     1.0000000000000000E0,                        0,                        0,     1.0000000000000000E0},
+  {20, 1,                        0,                        0,     1.0000000000000013E0,                        0},
+  {19, 2,     10.000000000000014E0,                        0,                        0,     4.5000000000000000E0},
+  {19, 1,                        0,                        0,   -0.99999999999999989E0,                        0},
+  {18, 3,                        0,     28.500000000000000E0,    -49.666666666666757E0,                        0},
+  {18, 2,    -9.4999999999999982E0,                        0,                        0,    -4.5000000000000009E0},
+  {18, 1,                        0,                        0,    0.99999999999999978E0,                        0},
+  {17, 4,    -223.50000000000040E0,                        0,                        0,    -95.625000000000000E0},
+  {17, 3,                        0,    -27.000000000000004E0,     46.500000000000000E0,                        0},
+  {17, 2,     8.9999999999999982E0,                        0,                        0,     4.5000000000000018E0},
+  {17, 1,                        0,                        0,    -1.0000000000000000E0,                        0},
+  {16, 5,                        0,    -325.12500000000000E0,     548.32500000000130E0,                        0},
+  {16, 4,     197.62500000000000E0,                        0,                        0,     88.875000000000028E0},
+  {16, 3,                        0,     25.500000000000011E0,    -43.500000000000000E0,                        0},
+  {16, 2,    -8.5000000000000000E0,                        0,                        0,    -4.4999999999999991E0},
+  {16, 1,                        0,                        0,    0.99999999999999989E0,                        0},
+  {15, 6,     1462.2000000000035E0,                        0,                        0,     618.22500000000002E0},
+  {15, 5,                        0,     284.40000000000009E0,    -460.35000000000002E0,                        0},
+  {15, 4,    -174.00000000000000E0,                        0,                        0,    -82.500000000000071E0},
+  {15, 3,                        0,    -23.999999999999996E0,     40.666666666666657E0,                        0},
+  {15, 2,     7.9999999999999991E0,                        0,                        0,     4.4999999999999964E0},
+  {15, 1,                        0,                        0,   -0.99999999999999989E0,                        0},
+  {14, 7,                        0,     1324.7678571428573E0,    -2481.7500000000073E0,                        0},
+  {14, 6,    -1150.8750000000002E0,                        0,                        0,    -509.62500000000023E0},
+  {14, 5,                        0,    -247.50000000000023E0,     384.74999999999989E0,                        0},
+  {14, 4,     152.49999999999997E0,                        0,                        0,     76.500000000000000E0},
+  {14, 3,                        0,     22.499999999999982E0,    -38.000000000000000E0,                        0},
+  {14, 2,    -7.4999999999999991E0,                        0,                        0,    -4.5000000000000018E0},
+  {14, 1,                        0,                        0,     1.0000000000000000E0,                        0},
+  {13, 8,    -4343.0625000000127E0,                        0,                        0,    -1847.9531250000000E0},
+  {13, 7,                        0,    -1019.2500000000005E0,     1814.6250000000002E0,                        0},
+  {13, 6,     897.74999999999977E0,                        0,                        0,     417.37500000000040E0},
+  {13, 5,                        0,     214.20000000000002E0,    -320.25000000000000E0,                        0},
+  {13, 4,    -133.00000000000000E0,                        0,                        0,    -70.874999999999957E0},
+  {13, 3,                        0,    -21.000000000000007E0,     35.500000000000000E0,                        0},
+  {13, 2,     7.0000000000000000E0,                        0,                        0,     4.5000000000000000E0},
+  {13, 1,                        0,                        0,   -0.99999999999999956E0,                        0},
+  {12, 9,                        0,    -2669.2656250000000E0,     5361.9140625000191E0,                        0},
+  {12, 8,     2948.7656250000005E0,                        0,                        0,     1313.2968750000005E0},
+  {12, 7,                        0,     775.12500000000068E0,    -1308.3750000000000E0,                        0},
+  {12, 6,    -693.87500000000000E0,                        0,                        0,    -339.67500000000001E0},
+  {12, 5,                        0,    -184.27499999999989E0,     265.64999999999998E0,                        0},
+  {12, 4,     115.37500000000000E0,                        0,                        0,     65.625000000000028E0},
+  {12, 3,                        0,     19.500000000000000E0,    -33.166666666666671E0,                        0},
+  {12, 2,    -6.4999999999999973E0,                        0,                        0,    -4.4999999999999991E0},
+  {12, 1,                        0,                        0,     1.0000000000000000E0,                        0},
+  {11,10,     6434.2968750000236E0,                        0,                        0,     2751.5742187500000E0},
+  {11, 9,                        0,     1751.0625000000007E0,    -3347.9296875000005E0,                        0},
+  {11, 8,    -1962.5625000000000E0,                        0,                        0,    -916.59375000000102E0},
+  {11, 7,                        0,    -582.29999999999995E0,     929.74999999999989E0,                        0},
+  {11, 6,     531.29999999999995E0,                        0,                        0,     274.83749999999975E0},
+  {11, 5,                        0,     157.50000000000009E0,    -219.82500000000002E0,                        0},
+  {11, 4,    -99.500000000000014E0,                        0,                        0,    -60.750000000000000E0},
+  {11, 3,                        0,    -17.999999999999996E0,     30.999999999999996E0,                        0},
+  {11, 2,     6.0000000000000000E0,                        0,                        0,     4.4999999999999982E0},
+  {11, 1,                        0,                        0,   -0.99999999999999922E0,                        0},
+  {10,11,                        0,     2751.5742187500000E0,    -5725.9453125000236E0,                        0},
+  {10,10,    -3682.7226562500005E0,                        0,                        0,    -1649.7304687500009E0},
+  {10, 9,                        0,    -1120.2812500000014E0,     2032.9921875000002E0,                        0},
+  {10, 8,     1278.4062499999998E0,                        0,                        0,     627.35624999999993E0},
+  {10, 7,                        0,     431.88749999999959E0,    -651.04999999999984E0,                        0},
+  {10, 6,    -403.01250000000005E0,                        0,                        0,    -221.28750000000014E0},
+  {10, 5,                        0,    -133.65000000000001E0,     181.72500000000005E0,                        0},
+  {10, 4,     85.249999999999986E0,                        0,                        0,     56.250000000000000E0},
+  {10, 3,                        0,     16.499999999999996E0,    -29.000000000000004E0,                        0},
+  {10, 2,    -5.4999999999999956E0,                        0,                        0,    -4.5000000000000000E0},
+  {10, 1,                        0,                        0,     1.0000000000000007E0,                        0},
+  { 9,12,    -4771.6210937500191E0,                        0,                        0,    -2045.1142578124995E0},
+  { 9,11,                        0,    -1499.7549715909099E0,     2974.3710937500000E0,                        0},
+  { 9,10,     2032.9921875000002E0,                        0,                        0,     955.87109375000125E0},
+  { 9, 9,                        0,     697.06250000000000E0,    -1196.8012152777778E0,                        0},
+  { 9, 8,    -813.81249999999977E0,                        0,                        0,    -420.53906249999949E0},
+  { 9, 7,                        0,    -316.12500000000017E0,     449.45535714285711E0,                        0},
+  { 9, 6,     302.87500000000011E0,                        0,                        0,     177.56250000000000E0},
+  { 9, 5,                        0,     112.50000000000000E0,    -150.37499999999994E0,                        0},
+  { 9, 4,    -72.500000000000014E0,                        0,                        0,    -52.124999999999993E0},
+  { 9, 3,                        0,    -15.000000000000000E0,     27.166666666666650E0,                        0},
+  { 9, 2,     5.0000000000000036E0,                        0,                        0,     4.5000000000000000E0},
+  { 9, 1,                        0,                        0,    -1.0000000000000000E0,                        0},
+  { 9, 0,     1.0000000000000000E0,                        0,                        0,     1.0000000000000000E0},
+  { 8,13,                        0,    -1415.8483323317305E0,     3007.8635066105894E0,                        0},
+  { 8,12,     2230.7783203125000E0,                        0,                        0,     1001.9315518465914E0},
+  { 8,11,                        0,     782.07634943181915E0,    -1474.6161221590910E0,                        0},
+  { 8,10,    -1077.1210937500000E0,                        0,                        0,    -532.65234375000000E0},
+  { 8, 9,                        0,    -420.53906249999949E0,     680.58593749999989E0,                        0},
+  { 8, 8,     505.63727678571422E0,                        0,                        0,     275.83593750000023E0},
+  { 8, 7,                        0,     228.29464285714289E0,    -306.40178571428578E0,                        0},
+  { 8, 6,    -225.56249999999994E0,                        0,                        0,    -142.31250000000003E0},
+  { 8, 5,                        0,    -93.824999999999989E0,     124.87500000000003E0,                        0},
+  { 8, 4,     61.124999999999964E0,                        0,                        0,     48.375000000000000E0},
+  { 8, 3,                        0,     13.500000000000000E0,    -25.500000000000007E0,                        0},
+  { 8, 2,    -4.5000000000000000E0,                        0,                        0,    -4.5000000000000000E0},
+  { 8, 1,                        0,     9.0000000000000000E0,    -9.0000000000000000E0,                        0},
+  { 7,14,     1718.7791466346225E0,                        0,                        0,     737.56460336538441E0},
+  { 7,13,                        0,     616.57326267482551E0,    -1248.8185096153848E0,                        0},
+  { 7,12,    -983.07741477272725E0,                        0,                        0,    -463.67258522727354E0},
+  { 7,11,                        0,    -387.38352272727275E0,     692.53977272727263E0,                        0},
+  { 7,10,     544.46874999999989E0,                        0,                        0,     283.78124999999960E0},
+  { 7, 9,                        0,     245.18750000000020E0,    -372.41071428571422E0,                        0},
+  { 7, 8,    -306.40178571428578E0,                        0,                        0,    -177.02678571428575E0},
+  { 7, 7,                        0,    -162.64285714285717E0,     206.99999999999994E0,                        0},
+  { 7, 6,     166.50000000000003E0,                        0,                        0,     114.29999999999998E0},
+  { 7, 5,                        0,     77.400000000000006E0,    -104.39999999999992E0,                        0},
+  { 7, 4,    -51.000000000000014E0,                        0,                        0,    -45.000000000000007E0},
+  { 7, 3,                        0,    -12.000000000000000E0,     24.000000000000000E0,                        0},
+  { 7, 2,    -36.000000000000000E0,                        0,                        0,    -36.000000000000000E0},
+  { 6,15,                        0,     344.19681490384608E0,    -741.44705528846498E0,                        0},
+  { 6,14,    -624.40925480769238E0,                        0,                        0,    -280.83599213286732E0},
+  { 6,13,                        0,    -249.66985358391653E0,     481.00256774475520E0,                        0},
+  { 6,12,     403.98153409090901E0,                        0,                        0,     200.54403409090915E0},
+  { 6,11,                        0,     180.58806818181793E0,    -305.15624999999989E0,                        0},
+  { 6,10,    -260.68749999999994E0,                        0,                        0,    -143.50000000000014E0},
+  { 6, 9,                        0,    -137.68750000000003E0,     195.31250000000006E0,                        0},
+  { 6, 8,     181.12499999999994E0,                        0,                        0,     111.37500000000003E0},
+  { 6, 7,                        0,     114.29999999999998E0,    -139.50000000000003E0,                        0},
+  { 6, 6,    -121.79999999999991E0,                        0,                        0,    -92.400000000000006E0},
+  { 6, 5,                        0,    -63.000000000000014E0,     88.200000000000017E0,                        0},
+  { 6, 4,     42.000000000000000E0,                        0,                        0,     42.000000000000000E0},
+  { 6, 3,                        0,    -84.000000000000000E0,     84.000000000000000E0,                        0},
+  { 5,16,    -278.04264573317437E0,                        0,                        0,    -119.40813551682686E0},
+  { 5,15,                        0,    -112.33439685314693E0,     230.74110576923078E0,                        0},
+  { 5,14,     206.14395760489509E0,                        0,                        0,     97.384287587412771E0},
+  { 5,13,                        0,     92.558784965034988E0,    -169.18170891608392E0,                        0},
+  { 5,12,    -152.57812499999994E0,                        0,                        0,    -79.913352272727138E0},
+  { 5,11,                        0,    -78.272727272727337E0,     124.56818181818181E0,                        0},
+  { 5,10,     117.18750000000004E0,                        0,                        0,     68.250000000000000E0},
+  { 5, 9,                        0,     74.250000000000028E0,    -97.874999999999943E0,                        0},
+  { 5, 8,    -104.62500000000003E0,                        0,                        0,    -69.074999999999989E0},
+  { 5, 7,                        0,    -79.200000000000003E0,     94.799999999999940E0,                        0},
+  { 5, 6,     88.200000000000017E0,                        0,                        0,     75.600000000000023E0},
+  { 5, 5,                        0,     50.400000000000006E0,    -75.600000000000009E0,                        0},
+  { 5, 4,     126.00000000000000E0,                        0,                        0,     126.00000000000001E0},
+  { 4,17,                        0,    -35.120039857890255E0,     76.416941370899707E0,                        0},
+  { 4,16,     72.106595552884613E0,                        0,                        0,     32.459728747814694E0},
+  { 4,15,                        0,     32.461429195804257E0,    -63.434986888111879E0,                        0},
+  { 4,14,    -60.422038898601400E0,                        0,                        0,    -30.050972465034974E0},
+  { 4,13,                        0,    -30.735904720279667E0,     53.149366258741253E0,                        0},
+  { 4,12,     51.903409090909093E0,                        0,                        0,     28.755681818181849E0},
+  { 4,11,                        0,     31.022727272727273E0,    -46.295454545454575E0,                        0},
+  { 4,10,    -48.937499999999972E0,                        0,                        0,    -30.187500000000007E0},
+  { 4, 9,                        0,    -38.374999999999993E0,     46.875000000000007E0,                        0},
+  { 4, 8,     59.249999999999964E0,                        0,                        0,     42.750000000000000E0},
+  { 4, 7,                        0,     54.000000000000014E0,    -66.000000000000014E0,                        0},
+  { 4, 6,    -63.000000000000007E0,                        0,                        0,    -63.000000000000000E0},
+  { 4, 5,                        0,     126.00000000000001E0,    -126.00000000000000E0,                        0},
+  { 3,18,     16.981542526866601E0,                        0,                        0,     7.2969501201923030E0},
+  { 3,17,                        0,     7.6375832347799282E0,    -15.847514847285069E0,                        0},
+  { 3,16,    -15.858746722027970E0,                        0,                        0,    -7.4994263548951201E0},
+  { 3,15,                        0,    -8.0135926573426595E0,     14.861013986013983E0,                        0},
+  { 3,14,     15.185533216783215E0,                        0,                        0,     7.9713723776223624E0},
+  { 3,13,                        0,     8.8479020979021072E0,    -14.428321678321677E0,                        0},
+  { 3,12,    -15.431818181818192E0,                        0,                        0,    -9.0681818181818201E0},
+  { 3,11,                        0,    -10.977272727272730E0,     15.272727272727263E0,                        0},
+  { 3,10,     18.750000000000004E0,                        0,                        0,     12.249999999999996E0},
+  { 3, 9,                        0,     19.000000000000000E0,    -21.666666666666647E0,                        0},
+  { 3, 8,    -33.000000000000007E0,                        0,                        0,    -27.000000000000000E0},
+  { 3, 7,                        0,    -36.000000000000000E0,     48.000000000000000E0,                        0},
+  { 3, 6,    -84.000000000000000E0,                        0,                        0,    -84.000000000000000E0},
+  { 2,19,                        0,     1.1521500189777321E0,    -2.5261094996576694E0,                        0},
+  { 2,18,    -2.6412524745475112E0,                        0,                        0,    -1.1897375372788983E0},
+  { 2,17,                        0,    -1.3234281802756094E0,     2.6127268870835043E0,                        0},
+  { 2,16,     2.7864401223776216E0,                        0,                        0,     1.3874672202797209E0},
+  { 2,15,                        0,     1.5942744755244724E0,    -2.7979458041958036E0,                        0},
+  { 2,14,    -3.0917832167832162E0,                        0,                        0,    -1.7176573426573447E0},
+  { 2,13,                        0,    -2.0926573426573434E0,     3.2062937062937085E0,                        0},
+  { 2,12,     3.8181818181818157E0,                        0,                        0,     2.3863636363636367E0},
+  { 2,11,                        0,     3.3409090909090899E0,    -4.2954545454545476E0,                        0},
+  { 2,10,    -6.4999999999999947E0,                        0,                        0,    -4.4999999999999991E0},
+  { 2, 9,                        0,    -9.0000000000000000E0,     10.000000000000004E0,                        0},
+  { 2, 8,     18.000000000000000E0,                        0,                        0,     18.000000000000000E0},
+  { 2, 7,                        0,    -36.000000000000000E0,     36.000000000000000E0,                        0},
+  { 1,20,   -0.25261094996576694E0,                        0,                        0,   -0.10859170338175740E0},
+  { 1,19,                        0,   -0.12523553023988404E0,    0.26185317560728771E0,                        0},
+  { 1,18,    0.29030298745372268E0,                        0,                        0,    0.13737836152817795E0},
+  { 1,17,                        0,    0.16323143767996717E0,   -0.30584925185108996E0,                        0},
+  { 1,16,   -0.34974322552447545E0,                        0,                        0,   -0.18384506118881083E0},
+  { 1,15,                        0,   -0.22902097902097929E0,    0.37919580419580412E0,                        0},
+  { 1,14,    0.45804195804195835E0,                        0,                        0,    0.27010489510489516E0},
+  { 1,13,                        0,    0.36713286713286719E0,   -0.52622377622377592E0,                        0},
+  { 1,12,   -0.71590909090909127E0,                        0,                        0,   -0.47727272727272718E0},
+  { 1,11,                        0,   -0.81818181818181801E0,    0.95454545454545348E0,                        0},
+  { 1,10,     2.0000000000000009E0,                        0,                        0,     1.5000000000000000E0},
+  { 1, 9,                        0,     4.0000000000000000E0,    -5.0000000000000000E0,                        0},
+  { 1, 8,     9.0000000000000000E0,                        0,                        0,     9.0000000000000000E0},
+  { 0,21,                        0, -5.1710334943693998E-003,  1.1405632913590601E-002,                        0},
+  { 0,20,  1.3092658780364384E-002,                        0,                        0,  5.9002545079726880E-003},
+  { 0,19,                        0,  7.2304400804304178E-003, -1.4384808544783377E-002,                        0},
+  { 0,18, -1.6991625102838331E-002,                        0,                        0, -8.4676123508844112E-003},
+  { 0,17,                        0, -1.0814415364047696E-002,  1.9179028691896326E-002,                        0},
+  { 0,16,  2.3699737762237758E-002,                        0,                        0,  1.3188374125874144E-002},
+  { 0,15,                        0,  1.8006993006993009E-002, -2.8030303030303075E-002,                        0},
+  { 0,14, -3.7587412587412564E-002,                        0,                        0, -2.3601398601398597E-002},
+  { 0,13,                        0, -3.6713286713286705E-002,  4.8951048951049000E-002,                        0},
+  { 0,12,  7.9545454545454461E-002,                        0,                        0,  5.6818181818181809E-002},
+  { 0,11,                        0,    0.13636363636363635E0,   -0.13636363636363638E0,                        0},
+  { 0,10,   -0.50000000000000000E0,                        0,                        0,   -0.50000000000000000E0},
+  { 0, 9,                        0,     1.0000000000000000E0,    -1.0000000000000000E0,                        0},
+  {20, 1,                        0,                        0,    -1.0000000000000000E0,                        0},
+  {19, 2,    -10.000000000000000E0,                        0,                        0,    -5.0000000000000000E0},
+  {19, 1,                        0,                        0,    0.99999999999999933E0,                        0},
+  {18, 3,                        0,    -31.666666666666668E0,     54.166666666666671E0,                        0},
+  {18, 2,     9.4999999999999929E0,                        0,                        0,     4.9999999999999982E0},
+  {18, 1,                        0,                        0,   -0.99999999999999967E0,                        0},
+  {17, 4,     243.75000000000003E0,                        0,                        0,     116.25000000000003E0},
+  {17, 3,                        0,     29.999999999999989E0,    -50.999999999999957E0,                        0},
+  {17, 2,    -8.9999999999999964E0,                        0,                        0,    -5.0000000000000000E0},
+  {17, 1,                        0,                        0,     1.0000000000000000E0,                        0},
+  {16, 5,                        0,     395.25000000000011E0,    -614.25000000000023E0,                        0},
+  {16, 4,    -216.74999999999983E0,                        0,                        0,    -108.74999999999994E0},
+  {16, 3,                        0,    -28.333333333333336E0,     47.999999999999972E0,                        0},
+  {16, 2,     8.5000000000000000E0,                        0,                        0,     4.9999999999999982E0},
+  {16, 1,                        0,                        0,   -0.99999999999999967E0,                        0},
+  {15, 6,    -1638.0000000000005E0,                        0,                        0,    -767.25000000000023E0},
+  {15, 5,                        0,    -347.99999999999983E0,     522.44999999999948E0,                        0},
+  {15, 4,     191.99999999999989E0,                        0,                        0,     101.66666666666669E0},
+  {15, 3,                        0,     26.666666666666657E0,    -45.166666666666664E0,                        0},
+  {15, 2,    -7.9999999999999973E0,                        0,                        0,    -5.0000000000000009E0},
+  {15, 1,                        0,                        0,     1.0000000000000007E0,                        0},
+  {14, 7,                        0,    -1644.1071428571433E0,     2758.6607142857156E0,                        0},
+  {14, 6,     1306.1249999999989E0,                        0,                        0,     641.24999999999955E0},
+  {14, 5,                        0,     305.00000000000006E0,    -443.24999999999977E0,                        0},
+  {14, 4,    -169.37500000000000E0,                        0,                        0,    -94.999999999999986E0},
+  {14, 3,                        0,    -25.000000000000004E0,     42.499999999999986E0,                        0},
+  {14, 2,     7.5000000000000053E0,                        0,                        0,     5.0000000000000018E0},
+  {14, 1,                        0,                        0,    -1.0000000000000002E0,                        0},
+  {13, 8,     4827.6562500000018E0,                        0,                        0,     2268.2812500000009E0},
+  {13, 7,                        0,     1282.4999999999991E0,    -2047.4999999999975E0,                        0},
+  {13, 6,    -1034.2499999999993E0,                        0,                        0,    -533.75000000000000E0},
+  {13, 5,                        0,    -265.99999999999994E0,     375.37500000000000E0,                        0},
+  {13, 4,     148.74999999999994E0,                        0,                        0,     88.750000000000014E0},
+  {13, 3,                        0,     23.333333333333343E0,    -40.000000000000021E0,                        0},
+  {13, 2,    -7.0000000000000018E0,                        0,                        0,    -5.0000000000000009E0},
+  {13, 1,                        0,                        0,    0.99999999999999967E0,                        0},
+  {12, 9,                        0,     3276.4062500000014E0,    -5902.9296875000045E0,                        0},
+  {12, 8,    -3327.1874999999959E0,                        0,                        0,    -1635.4687499999986E0},
+  {12, 7,                        0,    -991.25000000000000E0,     1503.7499999999989E0,                        0},
+  {12, 6,     813.31250000000000E0,                        0,                        0,     442.74999999999989E0},
+  {12, 5,                        0,     230.75000000000006E0,    -317.62499999999989E0,                        0},
+  {12, 4,    -130.00000000000006E0,                        0,                        0,    -82.916666666666686E0},
+  {12, 3,                        0,    -21.666666666666671E0,     37.666666666666671E0,                        0},
+  {12, 2,     6.4999999999999982E0,                        0,                        0,     5.0000000000000009E0},
+  {12, 1,                        0,                        0,    -1.0000000000000000E0,                        0},
+  {11,10,    -7083.5156250000055E0,                        0,                        0,    -3347.9296875000023E0},
+  {11, 9,                        0,    -2180.6249999999982E0,     3735.5859374999950E0,                        0},
+  {11, 8,     2255.6249999999982E0,                        0,                        0,     1162.1875000000000E0},
+  {11, 7,                        0,     758.99999999999977E0,    -1093.4374999999998E0,                        0},
+  {11, 6,    -635.24999999999977E0,                        0,                        0,    -366.37500000000006E0},
+  {11, 5,                        0,    -199.00000000000003E0,     268.87500000000023E0,                        0},
+  {11, 4,     113.00000000000001E0,                        0,                        0,     77.500000000000000E0},
+  {11, 3,                        0,     20.000000000000004E0,    -35.499999999999986E0,                        0},
+  {11, 2,    -6.0000000000000000E0,                        0,                        0,    -5.0000000000000009E0},
+  {11, 1,                        0,                        0,     1.0000000000000000E0,                        0},
+  {10,11,                        0,    -3347.9296875000023E0,     6273.8320312500055E0,                        0},
+  {10,10,     4109.1445312499945E0,                        0,                        0,     2032.9921874999982E0},
+  {10, 9,                        0,     1420.4513888888891E0,    -2306.8359374999982E0,                        0},
+  {10, 8,    -1503.4765624999998E0,                        0,                        0,    -813.81249999999977E0},
+  {10, 7,                        0,    -575.73214285714289E0,     788.18749999999966E0,                        0},
+  {10, 6,     492.93750000000040E0,                        0,                        0,     302.87500000000006E0},
+  {10, 5,                        0,     170.50000000000000E0,    -228.07500000000002E0,                        0},
+  {10, 4,    -97.624999999999957E0,                        0,                        0,    -72.500000000000000E0},
+  {10, 3,                        0,    -18.333333333333336E0,     33.500000000000000E0,                        0},
+  {10, 2,     5.5000000000000000E0,                        0,                        0,     5.0000000000000000E0},
+  {10, 1,                        0,                        0,    -1.0000000000000000E0,                        0},
+  {10, 0,     1.0000000000000000E0,                        0,                        0,     1.0000000000000000E0},
+  { 9,12,     5228.1933593750045E0,                        0,                        0,     2478.6425781250018E0},
+  { 9,11,                        0,     1848.1747159090892E0,    -3299.4609374999945E0,                        0},
+  { 9,10,    -2306.8359374999982E0,                        0,                        0,    -1196.8012152777778E0},
+  { 9, 9,                        0,    -904.23611111111086E0,     1387.5434027777778E0,                        0},
+  { 9, 8,     985.23437499999955E0,                        0,                        0,     561.81919642857144E0},
+  { 9, 7,                        0,     432.67857142857156E0,    -564.55357142857190E0,                        0},
+  { 9, 6,    -380.12500000000000E0,                        0,                        0,    -250.62500000000000E0},
+  { 9, 5,                        0,    -145.00000000000000E0,     194.24999999999994E0,                        0},
+  { 9, 4,     83.750000000000000E0,                        0,                        0,     67.916666666666657E0},
+  { 9, 3,                        0,     16.666666666666664E0,    -31.666666666666661E0,                        0},
+  { 9, 2,    -5.0000000000000000E0,                        0,                        0,    -5.0000000000000009E0},
+  { 9, 1,                        0,     10.000000000000000E0,    -10.000000000000000E0,                        0},
+  { 8,13,                        0,     1715.9833233173090E0,    -3287.5916466346189E0,                        0},
+  { 8,12,    -2474.5957031249959E0,                        0,                        0,    -1228.8467684659079E0},
+  { 8,11,                        0,    -979.20099431818198E0,     1660.9985795454527E0,                        0},
+  { 8,10,     1248.7890625000000E0,                        0,                        0,     680.58593749999966E0},
+  { 8, 9,                        0,     561.81919642857144E0,    -811.71874999999955E0,                        0},
+  { 8, 8,    -635.12276785714334E0,                        0,                        0,    -383.00223214285717E0},
+  { 8, 7,                        0,    -322.23214285714289E0,     403.39285714285722E0,                        0},
+  { 8, 6,     291.37499999999994E0,                        0,                        0,     208.12500000000000E0},
+  { 8, 5,                        0,     122.24999999999999E0,    -166.50000000000000E0,                        0},
+  { 8, 4,    -71.249999999999986E0,                        0,                        0,    -63.750000000000000E0},
+  { 8, 3,                        0,    -15.000000000000004E0,     30.000000000000000E0,                        0},
+  { 8, 2,    -45.000000000000000E0,                        0,                        0,    -45.000000000000000E0},
+  { 7,14,    -1878.6237980769251E0,                        0,                        0,    -892.01322115384687E0},
+  { 7,13,                        0,    -756.21339597902022E0,     1381.2548076923051E0,                        0},
+  { 7,12,     1107.3323863636351E0,                        0,                        0,     577.11647727272737E0},
+  { 7,11,                        0,     494.97159090909065E0,    -795.32386363636351E0,                        0},
+  { 7,10,    -649.37499999999966E0,                        0,                        0,    -372.41071428571433E0},
+  { 7, 9,                        0,    -340.44642857142861E0,     461.60714285714340E0,                        0},
+  { 7, 8,     403.39285714285722E0,                        0,                        0,     258.75000000000006E0},
+  { 7, 7,                        0,     237.85714285714286E0,    -289.28571428571422E0,                        0},
+  { 7, 6,    -222.00000000000000E0,                        0,                        0,    -174.00000000000000E0},
+  { 7, 5,                        0,    -102.00000000000000E0,     144.00000000000000E0,                        0},
+  { 7, 4,     60.000000000000000E0,                        0,                        0,     60.000000000000007E0},
+  { 7, 3,                        0,    -120.00000000000000E0,     120.00000000000000E0,                        0},
+  { 6,15,                        0,    -416.27283653846189E0,     809.14302884615495E0,                        0},
+  { 6,14,     690.62740384615256E0,                        0,                        0,     343.57326267482478E0},
+  { 6,13,                        0,     310.75502622377627E0,    -539.86199737762172E0,                        0},
+  { 6,12,    -463.93892045454538E0,                        0,                        0,    -254.29687499999991E0},
+  { 6,11,                        0,    -236.98863636363637E0,     359.38636363636334E0,                        0},
+  { 6,10,     323.12500000000040E0,                        0,                        0,     195.31250000000006E0},
+  { 6, 9,                        0,     201.25000000000003E0,    -255.62500000000006E0,                        0},
+  { 6, 8,    -253.12499999999994E0,                        0,                        0,    -174.37500000000003E0},
+  { 6, 7,                        0,    -174.00000000000000E0,     210.00000000000000E0,                        0},
+  { 6, 6,     168.00000000000000E0,                        0,                        0,     147.00000000000000E0},
+  { 6, 5,                        0,     84.000000000000014E0,    -126.00000000000000E0,                        0},
+  { 6, 4,     210.00000000000000E0,                        0,                        0,     210.00000000000000E0},
+  { 5,16,     303.42863581730808E0,                        0,                        0,     144.21319110576940E0},
+  { 5,15,                        0,     137.42930506992991E0,    -254.74471153846110E0,                        0},
+  { 5,14,    -231.36942744755220E0,                        0,                        0,    -120.84407779720283E0},
+  { 5,13,                        0,    -117.36778846153842E0,     193.41936188811184E0,                        0},
+  { 5,12,     179.69318181818167E0,                        0,                        0,     103.80681818181822E0},
+  { 5,11,                        0,     106.53409090909093E0,    -151.77272727272748E0,                        0},
+  { 5,10,    -153.37500000000006E0,                        0,                        0,    -97.875000000000028E0},
+  { 5, 9,                        0,    -116.25000000000003E0,     138.74999999999991E0,                        0},
+  { 5, 8,     157.50000000000000E0,                        0,                        0,     118.50000000000001E0},
+  { 5, 7,                        0,     126.00000000000000E0,    -156.00000000000000E0,                        0},
+  { 5, 6,    -126.00000000000000E0,                        0,                        0,    -126.00000000000000E0},
+  { 5, 5,                        0,     252.00000000000000E0,    -252.00000000000000E0,                        0},
+  { 4,17,                        0,     42.415644442873351E0,    -83.303609304298760E0,                        0},
+  { 4,16,    -79.607722355769098E0,                        0,                        0,    -39.646866805069884E0},
+  { 4,15,                        0,    -40.281359265734274E0,     71.041520979020902E0,                        0},
+  { 4,14,     69.078343531468519E0,                        0,                        0,     37.963833041958026E0},
+  { 4,13,                        0,     39.925699300699314E0,    -62.229020979020902E0,                        0},
+  { 4,12,    -63.238636363636459E0,                        0,                        0,    -38.579545454545467E0},
+  { 4,11,                        0,    -44.488636363636374E0,     59.181818181818223E0,                        0},
+  { 4,10,     69.374999999999957E0,                        0,                        0,     46.875000000000014E0},
+  { 4, 9,                        0,     65.833333333333343E0,    -75.000000000000000E0,                        0},
+  { 4, 8,    -97.500000000000000E0,                        0,                        0,    -82.500000000000000E0},
+  { 4, 7,                        0,    -90.000000000000000E0,     120.00000000000000E0,                        0},
+  { 4, 6,    -210.00000000000000E0,                        0,                        0,    -210.00000000000000E0},
+  { 3,18,    -18.511913178733057E0,                        0,                        0,    -8.8041749151583826E0},
+  { 3,17,                        0,    -9.3286745423693844E0,     17.473928874434353E0,                        0},
+  { 3,16,     17.760380244755225E0,                        0,                        0,     9.2881337412587435E0},
+  { 3,15,                        0,     10.123688811188806E0,    -16.944493006993003E0,                        0},
+  { 3,14,    -17.779720279720259E0,                        0,                        0,    -10.305944055944057E0},
+  { 3,13,                        0,    -11.870629370629374E0,     17.438811188811211E0,                        0},
+  { 3,12,     19.727272727272741E0,                        0,                        0,     12.727272727272730E0},
+  { 3,11,                        0,     17.045454545454550E0,    -20.999999999999986E0,                        0},
+  { 3,10,    -30.000000000000000E0,                        0,                        0,    -21.666666666666671E0},
+  { 3, 9,                        0,    -36.666666666666664E0,     41.666666666666657E0,                        0},
+  { 3, 8,     60.000000000000000E0,                        0,                        0,     60.000000000000000E0},
+  { 3, 7,                        0,    -120.00000000000000E0,     120.00000000000000E0,                        0},
+  { 2,19,                        0,    -1.3901328813407972E0,     2.7515503133186514E0,                        0},
+  { 2,18,     2.9123214790723924E0,                        0,                        0,     1.4515149372686111E0},
+  { 2,17,                        0,     1.6390824249280136E0,    -2.9216130836075656E0,                        0},
+  { 2,16,    -3.1770924388111883E0,                        0,                        0,    -1.7487161276223770E0},
+  { 2,15,                        0,    -2.0611888111888113E0,     3.2648601398601360E0,                        0},
+  { 2,14,     3.7368881118881165E0,                        0,                        0,     2.2902097902097909E0},
+  { 2,13,                        0,     2.9370629370629375E0,    -4.0506993006993035E0,                        0},
+  { 2,12,    -5.2499999999999964E0,                        0,                        0,    -3.5795454545454555E0},
+  { 2,11,                        0,    -5.9090909090909101E0,     6.6818181818181825E0,                        0},
+  { 2,10,     12.499999999999998E0,                        0,                        0,     10.000000000000000E0},
+  { 2, 9,                        0,     20.000000000000000E0,    -25.000000000000000E0,                        0},
+  { 2, 8,     45.000000000000000E0,                        0,                        0,     45.000000000000000E0},
+  { 1,20,    0.27515503133186514E0,                        0,                        0,    0.13092658780364397E0},
+  { 1,19,                        0,    0.15279104602827487E0,   -0.28845688705644157E0,                        0},
+  { 1,18,   -0.32462367595639618E0,                        0,                        0,   -0.16991625102838348E0},
+  { 1,17,                        0,   -0.20573130913204435E0,    0.34809170608802970E0,                        0},
+  { 1,16,    0.40810751748251700E0,                        0,                        0,    0.23699737762237760E0},
+  { 1,15,                        0,    0.30536130536130546E0,   -0.45629370629370680E0,                        0},
+  { 1,14,   -0.57867132867132909E0,                        0,                        0,   -0.37587412587412600E0},
+  { 1,13,                        0,   -0.55069930069930084E0,    0.70979020979020913E0,                        0},
+  { 1,12,     1.1136363636363638E0,                        0,                        0,    0.79545454545454564E0},
+  { 1,11,                        0,     1.8181818181818183E0,    -1.9090909090909092E0,                        0},
+  { 1,10,    -5.0000000000000000E0,                        0,                        0,    -5.0000000000000000E0},
+  { 1, 9,                        0,     10.000000000000000E0,    -10.000000000000000E0,                        0},
+  { 0,21,                        0,  6.2345994192211408E-003, -1.2415818427573447E-002,                        0},
+  { 0,20, -1.4422844352822079E-002,                        0,                        0, -7.1924042723916747E-003},
+  { 0,19,                        0, -8.9429605804412365E-003,  1.6067644623178667E-002,                        0},
+  { 0,18,  1.9338428116001651E-002,                        0,                        0,  1.0655015939942402E-002},
+  { 0,17,                        0,  1.3941022213081036E-002, -2.2328774167009437E-002,                        0},
+  { 0,16, -2.8518356643356675E-002,                        0,                        0, -1.7518939393939406E-002},
+  { 0,15,                        0, -2.5058275058275067E-002,  3.5198135198135236E-002,                        0},
+  { 0,14,  5.0699300699300648E-002,                        0,                        0,  3.4965034965034968E-002},
+  { 0,13,                        0,  6.1188811188811205E-002, -7.3426573426573424E-002,                        0},
+  { 0,12,   -0.15909090909090909E0,                        0,                        0,   -0.11363636363636362E0},
+  { 0,11,                        0,   -0.45454545454545459E0,    0.54545454545454541E0,                        0},
+  { 0,10,    -1.0000000000000000E0,                        0,                        0,    -1.0000000000000000E0},
+  {20, 1,                        0,                        0,    0.99999999999999911E0,                        0},
+  {19, 2,     9.9999999999999911E0,                        0,                        0,     5.5000000000000027E0},
+  {19, 1,                        0,                        0,   -0.99999999999999967E0,                        0},
+  {18, 3,                        0,     34.833333333333350E0,    -59.166666666666600E0,                        0},
+  {18, 2,    -9.4999999999999964E0,                        0,                        0,    -5.5000000000000000E0},
+  {18, 1,                        0,                        0,    0.99999999999999944E0,                        0},
+  {17, 4,    -266.24999999999972E0,                        0,                        0,    -140.25000000000009E0},
+  {17, 3,                        0,    -33.000000000000000E0,     55.999999999999986E0,                        0},
+  {17, 2,     8.9999999999999947E0,                        0,                        0,     5.5000000000000000E0},
+  {17, 1,                        0,                        0,   -0.99999999999999889E0,                        0},
+  {16, 5,                        0,    -476.85000000000025E0,     697.49999999999898E0,                        0},
+  {16, 4,     237.99999999999994E0,                        0,                        0,     132.00000000000000E0},
+  {16, 3,                        0,     31.166666666666668E0,    -52.999999999999964E0,                        0},
+  {16, 2,    -8.4999999999999911E0,                        0,                        0,    -5.5000000000000018E0},
+  {16, 1,                        0,                        0,     1.0000000000000004E0,                        0},
+  {15, 6,     1859.9999999999973E0,                        0,                        0,     957.82500000000073E0},
+  {15, 5,                        0,     422.39999999999998E0,    -601.44999999999982E0,                        0},
+  {15, 4,    -211.99999999999986E0,                        0,                        0,    -124.20833333333334E0},
+  {15, 3,                        0,    -29.333333333333343E0,     50.166666666666629E0,                        0},
+  {15, 2,     8.0000000000000036E0,                        0,                        0,     5.4999999999999973E0},
+  {15, 1,                        0,                        0,   -0.99999999999999989E0,                        0},
+  {14, 7,                        0,     2052.4821428571445E0,    -3129.9107142857092E0,                        0},
+  {14, 6,    -1503.6249999999998E0,                        0,                        0,    -812.62500000000000E0},
+  {14, 5,                        0,    -372.62500000000000E0,     518.24999999999955E0,                        0},
+  {14, 4,     188.12499999999986E0,                        0,                        0,     116.87500000000001E0},
+  {14, 3,                        0,     27.499999999999986E0,    -47.500000000000000E0,                        0},
+  {14, 2,    -7.4999999999999991E0,                        0,                        0,    -5.5000000000000000E0},
+  {14, 1,                        0,                        0,     1.0000000000000002E0,                        0},
+  {13, 8,    -5477.3437499999909E0,                        0,                        0,    -2815.3125000000027E0},
+  {13, 7,                        0,    -1625.2500000000000E0,     2366.2499999999991E0,                        0},
+  {13, 6,     1209.2499999999991E0,                        0,                        0,     688.18750000000000E0},
+  {13, 5,                        0,     327.25000000000006E0,    -446.62499999999949E0,                        0},
+  {13, 4,    -166.25000000000000E0,                        0,                        0,    -109.99999999999994E0},
+  {13, 3,                        0,    -25.666666666666668E0,     44.999999999999993E0,                        0},
+  {13, 2,     7.0000000000000018E0,                        0,                        0,     5.5000000000000018E0},
+  {13, 1,                        0,                        0,   -0.99999999999999978E0,                        0},
+  {12, 9,                        0,    -4066.5625000000036E0,     6624.3359374999873E0,                        0},
+  {12, 8,     3845.1562499999986E0,                        0,                        0,     2067.6562500000000E0},
+  {12, 7,                        0,     1278.0625000000000E0,    -1777.4999999999984E0,                        0},
+  {12, 6,    -967.68749999999886E0,                        0,                        0,    -582.31250000000023E0},
+  {12, 5,                        0,    -285.99999999999989E0,     385.37500000000000E0,                        0},
+  {12, 4,     146.24999999999997E0,                        0,                        0,     103.58333333333334E0},
+  {12, 3,                        0,     23.833333333333343E0,    -42.666666666666664E0,                        0},
+  {12, 2,    -6.4999999999999982E0,                        0,                        0,    -5.5000000000000000E0},
+  {12, 1,                        0,                        0,     1.0000000000000000E0,                        0},
+  {11,10,     7949.2031249999854E0,                        0,                        0,     4109.1445312500055E0},
+  {11, 9,                        0,     2756.8750000000000E0,    -4266.7317708333321E0,                        0},
+  {11, 8,    -2666.2499999999977E0,                        0,                        0,    -1503.4765625000000E0},
+  {11, 7,                        0,    -998.25000000000034E0,     1328.8839285714266E0,                        0},
+  {11, 6,     770.75000000000000E0,                        0,                        0,     492.93749999999972E0},
+  {11, 5,                        0,     248.60000000000002E0,    -333.37499999999989E0,                        0},
+  {11, 4,    -128.00000000000000E0,                        0,                        0,    -97.625000000000014E0},
+  {11, 3,                        0,    -22.000000000000000E0,     40.500000000000000E0,                        0},
+  {11, 2,     6.0000000000000000E0,                        0,                        0,     5.5000000000000018E0},
+  {11, 1,                        0,                        0,    -1.0000000000000000E0,                        0},
+  {11, 0,     1.0000000000000000E0,                        0,                        0,     1.0000000000000000E0},
+  {10,11,                        0,     4109.1445312500055E0,    -6991.8867187499854E0,                        0},
+  {10,10,    -4693.4049479166661E0,                        0,                        0,    -2537.5195312499995E0},
+  {10, 9,                        0,    -1837.5824652777778E0,     2694.8567708333308E0,                        0},
+  {10, 8,     1827.2154017857115E0,                        0,                        0,     1083.7578125000005E0},
+  {10, 7,                        0,     774.61607142857099E0,    -991.27678571428589E0,                        0},
+  {10, 6,    -611.18749999999989E0,                        0,                        0,    -418.13750000000005E0},
+  {10, 5,                        0,    -214.77500000000003E0,     289.57500000000005E0,                        0},
+  {10, 4,     111.37500000000000E0,                        0,                        0,     92.125000000000000E0},
+  {10, 3,                        0,     20.166666666666671E0,    -38.500000000000000E0,                        0},
+  {10, 2,    -5.5000000000000000E0,                        0,                        0,    -5.4999999999999991E0},
+  {10, 1,                        0,     11.000000000000000E0,    -11.000000000000000E0,                        0},
+  { 9,12,    -5826.5722656249873E0,                        0,                        0,    -3024.5058593750032E0},
+  { 9,11,                        0,    -2306.8359374999995E0,     3736.0885416666665E0,                        0},
+  { 9,10,     2694.8567708333308E0,                        0,                        0,     1526.2977430555554E0},
+  { 9, 9,                        0,     1204.1753472222226E0,    -1669.3700396825373E0,                        0},
+  { 9, 8,    -1239.0959821428573E0,                        0,                        0,    -776.26116071428510E0},
+  { 9, 7,                        0,    -597.33928571428578E0,     740.53571428571411E0,                        0},
+  { 9, 6,     482.62500000000000E0,                        0,                        0,     356.12500000000000E0},
+  { 9, 5,                        0,     184.25000000000000E0,    -253.00000000000003E0,                        0},
+  { 9, 4,    -96.250000000000000E0,                        0,                        0,    -87.083333333333343E0},
+  { 9, 3,                        0,    -18.333333333333329E0,     36.666666666666664E0,                        0},
+  { 9, 2,    -55.000000000000000E0,                        0,                        0,    -55.000000000000000E0},
+  { 8,13,                        0,    -2093.8886718750023E0,     3651.1951622596071E0,                        0},
+  { 8,12,     2802.0664062500000E0,                        0,                        0,     1522.5820312500000E0},
+  { 8,11,                        0,     1248.7890625000000E0,    -1919.2265624999982E0,                        0},
+  { 8,10,    -1502.4330357142835E0,                        0,                        0,    -892.89062500000045E0},
+  { 8, 9,                        0,    -776.26116071428510E0,     1015.9040178571431E0,                        0},
+  { 8, 8,     833.10267857142833E0,                        0,                        0,     554.66517857142867E0},
+  { 8, 7,                        0,     457.87500000000000E0,    -556.87500000000011E0,                        0},
+  { 8, 6,    -379.50000000000006E0,                        0,                        0,    -305.25000000000000E0},
+  { 8, 5,                        0,    -156.75000000000000E0,     222.74999999999994E0,                        0},
+  { 8, 4,     82.500000000000000E0,                        0,                        0,     82.500000000000000E0},
+  { 8, 3,                        0,    -165.00000000000000E0,     165.00000000000000E0,                        0},
+  { 7,14,     2086.3972355769183E0,                        0,                        0,     1085.2716346153861E0},
+  { 7,13,                        0,     936.97355769230762E0,    -1557.3064903846155E0,                        0},
+  { 7,12,    -1279.4843749999989E0,                        0,                        0,    -729.04687499999977E0},
+  { 7,11,                        0,    -649.37500000000034E0,     943.60714285714096E0,                        0},
+  { 7,10,     812.72321428571445E0,                        0,                        0,     507.76785714285666E0},
+  { 7, 9,                        0,     493.03571428571439E0,    -609.91071428571399E0,                        0},
+  { 7, 8,    -556.87500000000011E0,                        0,                        0,    -397.76785714285722E0},
+  { 7, 7,                        0,    -348.85714285714289E0,     424.28571428571428E0,                        0},
+  { 7, 6,     296.99999999999994E0,                        0,                        0,     264.00000000000000E0},
+  { 7, 5,                        0,     132.00000000000000E0,    -198.00000000000000E0,                        0},
+  { 7, 4,     330.00000000000000E0,                        0,                        0,     330.00000000000000E0},
+  { 6,15,                        0,     506.46009615384685E0,    -896.77764423076701E0,                        0},
+  { 6,14,    -778.65324519230774E0,                        0,                        0,    -424.17728365384613E0},
+  { 6,13,                        0,    -392.56370192307679E0,     620.33293269230717E0,                        0},
+  { 6,12,     550.43749999999886E0,                        0,                        0,     329.43750000000028E0},
+  { 6,11,                        0,     323.12499999999972E0,    -442.00000000000011E0,                        0},
+  { 6,10,    -426.93749999999983E0,                        0,                        0,    -281.18750000000006E0},
+  { 6, 9,                        0,    -309.37500000000011E0,     364.37500000000006E0,                        0},
+  { 6, 8,     371.25000000000000E0,                        0,                        0,     288.75000000000000E0},
+  { 6, 7,                        0,     264.00000000000000E0,    -329.99999999999994E0,                        0},
+  { 6, 6,    -231.00000000000000E0,                        0,                        0,    -231.00000000000000E0},
+  { 6, 5,                        0,     462.00000000000000E0,    -462.00000000000000E0,                        0},
+  { 5,16,    -336.29161658653766E0,                        0,                        0,    -175.13698918269256E0},
+  { 5,15,                        0,    -169.67091346153845E0,     286.49711538461543E0,                        0},
+  { 5,14,     265.85697115384596E0,                        0,                        0,     151.97235576923075E0},
+  { 5,13,                        0,     152.04807692307705E0,    -227.76923076923029E0,                        0},
+  { 5,12,    -221.00000000000006E0,                        0,                        0,    -139.12499999999980E0},
+  { 5,11,                        0,    -153.37500000000003E0,     196.49999999999991E0,                        0},
+  { 5,10,     218.62500000000006E0,                        0,                        0,     152.62500000000003E0},
+  { 5, 9,                        0,     192.50000000000000E0,    -220.00000000000000E0,                        0},
+  { 5, 8,    -247.49999999999994E0,                        0,                        0,    -214.50000000000003E0},
+  { 5, 7,                        0,    -198.00000000000000E0,     264.00000000000000E0,                        0},
+  { 5, 6,    -462.00000000000000E0,                        0,                        0,    -462.00000000000000E0},
+  { 4,17,                        0,    -51.510879171380168E0,     92.195674844456775E0,                        0},
+  { 4,16,     89.530348557692321E0,                        0,                        0,     48.841045673076913E0},
+  { 4,15,                        0,     50.657451923076913E0,    -81.378605769230703E0,                        0},
+  { 4,14,    -81.346153846153669E0,                        0,                        0,    -48.894230769230823E0},
+  { 4,13,                        0,    -53.509615384615316E0,     75.721153846153896E0,                        0},
+  { 4,12,     81.874999999999972E0,                        0,                        0,     54.250000000000014E0},
+  { 4,11,                        0,     69.375000000000014E0,    -82.875000000000028E0,                        0},
+  { 4,10,    -110.00000000000000E0,                        0,                        0,    -82.500000000000000E0},
+  { 4, 9,                        0,    -119.16666666666669E0,     137.50000000000000E0,                        0},
+  { 4, 8,     165.00000000000000E0,                        0,                        0,     165.00000000000000E0},
+  { 4, 7,                        0,    -330.00000000000000E0,     330.00000000000000E0,                        0},
+  { 3,18,     20.487927743212616E0,                        0,                        0,     10.678512089932145E0},
+  { 3,17,                        0,     11.492010746606333E0,    -19.618831306561088E0,                        0},
+  { 3,16,    -20.344651442307676E0,                        0,                        0,    -11.649338942307688E0},
+  { 3,15,                        0,    -13.038461538461553E0,     19.874999999999950E0,                        0},
+  { 3,14,     21.634615384615397E0,                        0,                        0,     13.701923076923059E0},
+  { 3,13,                        0,     16.692307692307697E0,    -22.211538461538453E0,                        0},
+  { 3,12,    -27.625000000000007E0,                        0,                        0,    -19.250000000000007E0},
+  { 3,11,                        0,    -30.000000000000000E0,     33.500000000000000E0,                        0},
+  { 3,10,     55.000000000000000E0,                        0,                        0,     45.833333333333336E0},
+  { 3, 9,                        0,     73.333333333333329E0,    -91.666666666666657E0,                        0},
+  { 3, 8,     165.00000000000000E0,                        0,                        0,     165.00000000000000E0},
+  { 2,19,                        0,     1.6860808563050755E0,    -3.0421189382888696E0,                        0},
+  { 2,18,    -3.2698052177601813E0,                        0,                        0,    -1.7854302177601804E0},
+  { 2,17,                        0,    -2.0557656957013566E0,     3.3398437499999982E0,                        0},
+  { 2,16,     3.7265624999999907E0,                        0,                        0,     2.2445913461538489E0},
+  { 2,15,                        0,     2.7403846153846114E0,    -3.9519230769230793E0,                        0},
+  { 2,14,    -4.7596153846153824E0,                        0,                        0,    -3.1826923076923088E0},
+  { 2,13,                        0,    -4.4423076923076934E0,     5.5192307692307718E0,                        0},
+  { 2,12,     8.3750000000000000E0,                        0,                        0,     6.1250000000000000E0},
+  { 2,11,                        0,     12.500000000000000E0,    -13.500000000000000E0,                        0},
+  { 2,10,    -27.500000000000000E0,                        0,                        0,    -27.500000000000000E0},
+  { 2, 9,                        0,     55.000000000000000E0,    -55.000000000000000E0,                        0},
+  { 1,20,   -0.30421189382888697E0,                        0,                        0,   -0.15865128788104338E0},
+  { 1,19,                        0,   -0.18794002292212425E0,    0.32346801321743285E0,                        0},
+  { 1,18,    0.37109374999999978E0,                        0,                        0,    0.21272270927601789E0},
+  { 1,17,                        0,    0.26406957013574694E0,   -0.40723981900452366E0,                        0},
+  { 1,16,   -0.49399038461538491E0,                        0,                        0,   -0.31370192307692268E0},
+  { 1,15,                        0,   -0.42435897435897452E0,    0.57692307692307665E0,                        0},
+  { 1,14,    0.78846153846153877E0,                        0,                        0,    0.55769230769230804E0},
+  { 1,13,                        0,    0.94230769230769229E0,    -1.0769230769230769E0,                        0},
+  { 1,12,    -2.2500000000000000E0,                        0,                        0,    -1.7500000000000002E0},
+  { 1,11,                        0,    -5.0000000000000000E0,     6.0000000000000000E0,                        0},
+  { 1,10,    -11.000000000000000E0,                        0,                        0,    -11.000000000000000E0},
+  { 0,21,                        0, -7.5548232324306368E-003,  1.3716118722286444E-002,                        0},
+  { 0,20,  1.6173400660871643E-002,                        0,                        0,  8.8372045427482660E-003},
+  { 0,19,                        0,  1.1195932067158836E-002, -1.8340490295308411E-002,                        0},
+  { 0,18, -2.2624434389140205E-002,                        0,                        0, -1.3645361990950249E-002},
+  { 0,17,                        0, -1.8453054298642510E-002,  2.6937217194570158E-002,                        0},
+  { 0,16,  3.6057692307692291E-002,                        0,                        0,  2.4198717948717943E-002},
+  { 0,15,                        0,  3.7179487179487200E-002, -4.7435897435897462E-002,                        0},
+  { 0,14, -7.6923076923076913E-002,                        0,                        0, -5.7692307692307689E-002},
+  { 0,13,                        0,   -0.13461538461538464E0,    0.13461538461538464E0,                        0},
+  { 0,12,    0.50000000000000000E0,                        0,                        0,    0.50000000000000000E0},
+  { 0,11,                        0,    -1.0000000000000000E0,     1.0000000000000000E0,                        0},
+  {20, 1,                        0,                        0,    -1.0000000000000004E0,                        0},
+  {19, 2,    -10.000000000000004E0,                        0,                        0,    -5.9999999999999982E0},
+  {19, 1,                        0,                        0,    0.99999999999999956E0,                        0},
+  {18, 3,                        0,    -37.999999999999993E0,     64.666666666666700E0,                        0},
+  {18, 2,     9.4999999999999964E0,                        0,                        0,     5.9999999999999964E0},
+  {18, 1,                        0,                        0,   -0.99999999999999944E0,                        0},
+  {17, 4,     291.00000000000017E0,                        0,                        0,     168.00000000000000E0},
+  {17, 3,                        0,     35.999999999999979E0,    -61.499999999999972E0,                        0},
+  {17, 2,    -8.9999999999999947E0,                        0,                        0,    -6.0000000000000018E0},
+  {17, 1,                        0,                        0,     1.0000000000000000E0,                        0},
+  {16, 5,                        0,     571.20000000000005E0,    -801.45000000000061E0,                        0},
+  {16, 4,    -261.37499999999989E0,                        0,                        0,    -158.99999999999994E0},
+  {16, 3,                        0,    -34.000000000000007E0,     58.499999999999979E0,                        0},
+  {16, 2,     8.5000000000000000E0,                        0,                        0,     5.9999999999999982E0},
+  {16, 1,                        0,                        0,    -1.0000000000000000E0,                        0},
+  {15, 6,    -2137.2000000000016E0,                        0,                        0,    -1202.9000000000001E0},
+  {15, 5,                        0,    -508.79999999999984E0,     700.72499999999980E0,                        0},
+  {15, 4,     233.99999999999991E0,                        0,                        0,     150.50000000000000E0},
+  {15, 3,                        0,     31.999999999999993E0,    -55.666666666666679E0,                        0},
+  {15, 2,    -8.0000000000000000E0,                        0,                        0,    -6.0000000000000027E0},
+  {15, 1,                        0,                        0,     1.0000000000000000E0,                        0},
+  {14, 7,                        0,    -2577.6428571428573E0,     3631.3928571428601E0,                        0},
+  {14, 6,     1751.8124999999995E0,                        0,                        0,     1036.4999999999995E0},
+  {14, 5,                        0,     451.50000000000000E0,    -613.12499999999966E0,                        0},
+  {14, 4,    -208.75000000000006E0,                        0,                        0,    -142.49999999999997E0},
+  {14, 3,                        0,    -30.000000000000014E0,     52.999999999999993E0,                        0},
+  {14, 2,     7.5000000000000000E0,                        0,                        0,     5.9999999999999973E0},
+  {14, 1,                        0,                        0,   -0.99999999999999911E0,                        0},
+  {13, 8,     6354.9375000000055E0,                        0,                        0,     3549.3750000000005E0},
+  {13, 7,                        0,     2072.9999999999991E0,    -2805.5624999999986E0,                        0},
+  {13, 6,    -1430.6249999999991E0,                        0,                        0,    -893.25000000000011E0},
+  {13, 5,                        0,    -398.99999999999989E0,     537.37500000000011E0,                        0},
+  {13, 4,     185.49999999999997E0,                        0,                        0,     135.00000000000003E0},
+  {13, 3,                        0,     27.999999999999986E0,    -50.500000000000014E0,                        0},
+  {13, 2,    -6.9999999999999938E0,                        0,                        0,    -5.9999999999999973E0},
+  {13, 1,                        0,                        0,    0.99999999999999956E0,                        0},
+  {12, 9,                        0,     5126.8750000000009E0,    -7612.0442708333412E0,                        0},
+  {12, 8,    -4559.0390624999982E0,                        0,                        0,    -2666.2499999999986E0},
+  {12, 7,                        0,    -1658.8928571428573E0,     2163.1874999999986E0,                        0},
+  {12, 6,     1164.3125000000002E0,                        0,                        0,     770.74999999999977E0},
+  {12, 5,                        0,     351.00000000000011E0,    -472.27499999999998E0,                        0},
+  {12, 4,    -164.12500000000006E0,                        0,                        0,    -127.99999999999997E0},
+  {12, 3,                        0,    -25.999999999999989E0,     48.166666666666643E0,                        0},
+  {12, 2,     6.4999999999999973E0,                        0,                        0,     6.0000000000000000E0},
+  {12, 1,                        0,                        0,    -1.0000000000000004E0,                        0},
+  {12, 0,     1.0000000000000000E0,                        0,                        0,     1.0000000000000000E0},
+  {11,10,    -9134.4531250000109E0,                        0,                        0,    -5120.0781250000018E0},
+  {11, 9,                        0,    -3554.9999999999982E0,     5017.9687499999982E0,                        0},
+  {11, 8,     3244.7812499999982E0,                        0,                        0,     1993.3258928571431E0},
+  {11, 7,                        0,     1321.2857142857140E0,    -1668.6071428571431E0,                        0},
+  {11, 6,    -944.54999999999995E0,                        0,                        0,    -666.75000000000023E0},
+  {11, 5,                        0,    -307.19999999999993E0,     416.70000000000010E0,                        0},
+  {11, 4,     144.49999999999994E0,                        0,                        0,     121.49999999999997E0},
+  {11, 3,                        0,     24.000000000000000E0,    -46.000000000000000E0,                        0},
+  {11, 2,    -6.0000000000000027E0,                        0,                        0,    -6.0000000000000000E0},
+  {11, 1,                        0,     12.000000000000000E0,    -12.000000000000000E0,                        0},
+  {10,11,                        0,    -5120.0781250000018E0,     7957.7812500000109E0,                        0},
+  {10,10,     5519.7656249999973E0,                        0,                        0,     3233.8281249999973E0},
+  {10, 9,                        0,     2436.2872023809527E0,    -3265.6249999999977E0,                        0},
+  {10, 8,    -2294.3348214285716E0,                        0,                        0,    -1486.9151785714280E0},
+  {10, 7,                        0,    -1047.7500000000002E0,     1291.8714285714282E0,                        0},
+  {10, 6,     763.95000000000016E0,                        0,                        0,     579.14999999999998E0},
+  {10, 5,                        0,     267.29999999999995E0,    -369.59999999999991E0,                        0},
+  {10, 4,    -126.50000000000000E0,                        0,                        0,    -115.50000000000000E0},
+  {10, 3,                        0,    -22.000000000000000E0,     44.000000000000014E0,                        0},
+  {10, 2,    -66.000000000000000E0,                        0,                        0,    -66.000000000000000E0},
+  { 9,12,     6631.4843750000091E0,                        0,                        0,     3736.0885416666679E0},
+  { 9,11,                        0,     2939.8437499999977E0,    -4343.0937499999973E0,                        0},
+  { 9,10,    -3265.6249999999977E0,                        0,                        0,    -2003.2440476190477E0},
+  { 9, 9,                        0,    -1652.1279761904757E0,     2103.9682539682544E0,                        0},
+  { 9, 8,     1614.8392857142853E0,                        0,                        0,     1110.8035714285718E0},
+  { 9, 7,                        0,     827.35714285714278E0,    -1008.0714285714290E0,                        0},
+  { 9, 6,    -615.99999999999989E0,                        0,                        0,    -505.99999999999983E0},
+  { 9, 5,                        0,    -231.00000000000000E0,     330.00000000000000E0,                        0},
+  { 9, 4,     110.00000000000003E0,                        0,                        0,     110.00000000000000E0},
+  { 9, 3,                        0,    -220.00000000000000E0,     220.00000000000000E0,                        0},
+  { 8,13,                        0,     2586.5228365384623E0,    -4133.9837740384673E0,                        0},
+  { 8,12,    -3257.3203124999982E0,                        0,                        0,    -1919.2265624999986E0},
+  { 8,11,                        0,    -1639.0178571428571E0,     2293.8749999999982E0,                        0},
+  { 8,10,     1893.5714285714291E0,                        0,                        0,     1219.0848214285711E0},
+  { 8, 9,                        0,     1110.8035714285718E0,    -1348.9732142857142E0,                        0},
+  { 8, 8,    -1134.0803571428576E0,                        0,                        0,    -835.31249999999989E0},
+  { 8, 7,                        0,    -650.57142857142833E0,     796.71428571428532E0,                        0},
+  { 8, 6,     495.00000000000000E0,                        0,                        0,     445.50000000000000E0},
+  { 8, 5,                        0,     198.00000000000000E0,    -297.00000000000006E0,                        0},
+  { 8, 4,     495.00000000000000E0,                        0,                        0,     495.00000000000000E0},
+  { 7,14,    -2362.2764423076956E0,                        0,                        0,    -1334.8341346153852E0},
+  { 7,13,                        0,    -1181.0624999999991E0,     1798.0240384615377E0,                        0},
+  { 7,12,     1529.2499999999986E0,                        0,                        0,     943.60714285714300E0},
+  { 7,11,                        0,     886.60714285714266E0,    -1171.2857142857142E0,                        0},
+  { 7,10,    -1079.1785714285713E0,                        0,                        0,    -731.89285714285757E0},
+  { 7, 9,                        0,    -742.49999999999989E0,     868.21428571428612E0,                        0},
+  { 7, 8,     796.71428571428532E0,                        0,                        0,     636.42857142857110E0},
+  { 7, 7,                        0,     509.14285714285717E0,    -641.14285714285711E0,                        0},
+  { 7, 6,    -396.00000000000006E0,                        0,                        0,    -396.00000000000006E0},
+  { 7, 5,                        0,     792.00000000000000E0,    -792.00000000000000E0,                        0},
+  { 6,15,                        0,    -622.92259615384648E0,     1012.4442307692325E0,                        0},
+  { 6,14,     899.01201923076883E0,                        0,                        0,     531.71394230769181E0},
+  { 6,13,                        0,     508.09615384615392E0,    -734.59615384615302E0,                        0},
+  { 6,12,    -683.25000000000000E0,                        0,                        0,    -441.99999999999983E0},
+  { 6,11,                        0,    -465.75000000000023E0,     578.99999999999966E0,                        0},
+  { 6,10,     607.75000000000023E0,                        0,                        0,     437.24999999999994E0},
+  { 6, 9,                        0,     494.99999999999977E0,    -568.33333333333303E0,                        0},
+  { 6, 8,    -561.00000000000000E0,                        0,                        0,    -495.00000000000006E0},
+  { 6, 7,                        0,    -396.00000000000006E0,     528.00000000000000E0,                        0},
+  { 6, 6,    -924.00000000000000E0,                        0,                        0,    -924.00000000000000E0},
+  { 5,16,     379.66658653846218E0,                        0,                        0,     214.87283653846166E0},
+  { 5,15,                        0,     212.68557692307672E0,    -329.58749999999981E0,                        0},
+  { 5,14,    -314.82692307692275E0,                        0,                        0,    -195.23076923076928E0},
+  { 5,13,                        0,    -203.99999999999991E0,     279.05769230769232E0,                        0},
+  { 5,12,     289.49999999999983E0,                        0,                        0,     196.50000000000009E0},
+  { 5,11,                        0,     238.49999999999994E0,    -279.00000000000017E0,                        0},
+  { 5,10,    -340.99999999999983E0,                        0,                        0,    -263.99999999999989E0},
+  { 5, 9,                        0,    -330.00000000000006E0,     384.99999999999994E0,                        0},
+  { 5, 8,     396.00000000000000E0,                        0,                        0,     396.00000000000000E0},
+  { 5, 7,                        0,    -792.00000000000000E0,     792.00000000000000E0,                        0},
+  { 4,17,                        0,     63.197893099547542E0,    -103.89085477941195E0,                        0},
+  { 4,16,    -102.99609374999994E0,                        0,                        0,    -61.033954326923009E0},
+  { 4,15,                        0,    -65.076923076923094E0,     95.913461538461434E0,                        0},
+  { 4,14,     99.663461538461547E0,                        0,                        0,     64.903846153846118E0},
+  { 4,13,                        0,     75.576923076923109E0,    -97.326923076923052E0,                        0},
+  { 4,12,    -116.25000000000007E0,                        0,                        0,    -82.874999999999972E0},
+  { 4,11,                        0,    -119.99999999999994E0,     133.49999999999994E0,                        0},
+  { 4,10,     192.49999999999997E0,                        0,                        0,     165.00000000000000E0},
+  { 4, 9,                        0,     220.00000000000000E0,    -275.00000000000006E0,                        0},
+  { 4, 8,     495.00000000000000E0,                        0,                        0,     495.00000000000000E0},
+  { 3,18,    -23.086856617647101E0,                        0,                        0,    -13.079220871040732E0},
+  { 3,17,                        0,    -14.360930429864238E0,     22.517180429864244E0,                        0},
+  { 3,16,     23.978365384615358E0,                        0,                        0,     14.906250000000004E0},
+  { 3,15,                        0,     17.307692307692299E0,    -24.192307692307693E0,                        0},
+  { 3,14,    -27.807692307692299E0,                        0,                        0,    -19.038461538461547E0},
+  { 3,13,                        0,    -25.499999999999993E0,     30.692307692307715E0,                        0},
+  { 3,12,     44.499999999999979E0,                        0,                        0,     33.499999999999979E0},
+  { 3,11,                        0,     60.000000000000000E0,    -65.999999999999986E0,                        0},
+  { 3,10,    -110.00000000000001E0,                        0,                        0,    -110.00000000000000E0},
+  { 3, 9,                        0,     220.00000000000000E0,    -220.00000000000000E0,                        0},
+  { 2,19,                        0,    -2.0651401375327474E0,     3.4233783341271806E0,                        0},
+  { 2,18,     3.7528634049773739E0,                        0,                        0,     2.2265624999999973E0},
+  { 2,17,                        0,     2.6305147058823537E0,    -3.9247737556561031E0,                        0},
+  { 2,16,    -4.5360576923076925E0,                        0,                        0,    -2.9639423076923066E0},
+  { 2,15,                        0,    -3.8076923076923093E0,     5.0307692307692280E0,                        0},
+  { 2,14,     6.5769230769230820E0,                        0,                        0,     4.7307692307692308E0},
+  { 2,13,                        0,     7.7307692307692264E0,    -8.6153846153846114E0,                        0},
+  { 2,12,    -16.499999999999996E0,                        0,                        0,    -13.500000000000002E0},
+  { 2,11,                        0,    -30.000000000000000E0,     36.000000000000000E0,                        0},
+  { 2,10,    -66.000000000000000E0,                        0,                        0,    -66.000000000000000E0},
+  { 1,20,    0.34233783341271806E0,                        0,                        0,    0.19408080793045979E0},
+  { 1,19,                        0,    0.23437499999999972E0,   -0.37064256370564408E0,                        0},
+  { 1,18,   -0.43608597285067813E0,                        0,                        0,   -0.27149321266968324E0},
+  { 1,17,                        0,   -0.34869909502262431E0,    0.49377828054298645E0,                        0},
+  { 1,16,    0.62884615384615350E0,                        0,                        0,    0.43269230769230815E0},
+  { 1,15,                        0,    0.63076923076923075E0,   -0.78461538461538538E0,                        0},
+  { 1,14,    -1.2307692307692302E0,                        0,                        0,   -0.92307692307692246E0},
+  { 1,13,                        0,    -2.0769230769230771E0,     2.1538461538461537E0,                        0},
+  { 1,12,     6.0000000000000000E0,                        0,                        0,     6.0000000000000000E0},
+  { 1,11,                        0,    -12.000000000000000E0,     12.000000000000000E0,                        0},
+  { 0,21,                        0,  9.2419432347837990E-003, -1.5419319296544555E-002,                        0},
+  { 0,20, -1.8532128185282205E-002,                        0,                        0, -1.1004294177185018E-002},
+  { 0,19,                        0, -1.4289116456299118E-002,  2.1508097165991912E-002,                        0},
+  { 0,18,  2.7432126696832579E-002,                        0,                        0,  1.7958144796380100E-002},
+  { 0,17,                        0,  2.5452488687782833E-002, -3.4106334841628942E-002,                        0},
+  { 0,16, -4.9038461538461586E-002,                        0,                        0, -3.5576923076923055E-002},
+  { 0,15,                        0, -6.1538461538461500E-002,  7.1794871794871762E-002,                        0},
+  { 0,14,    0.15384615384615383E0,                        0,                        0,    0.11538461538461538E0},
+  { 0,13,                        0,    0.46153846153846156E0,   -0.53846153846153855E0,                        0},
+  { 0,12,     1.0000000000000000E0,                        0,                        0,     1.0000000000000000E0},
+  {20, 1,                        0,                        0,     1.0000000000000000E0,                        0},
+  {19, 2,     10.000000000000000E0,                        0,                        0,     6.5000000000000000E0},
+  {19, 1,                        0,                        0,   -0.99999999999999900E0,                        0},
+  {18, 3,                        0,     41.166666666666664E0,    -70.666666666666671E0,                        0},
+  {18, 2,    -9.4999999999999911E0,                        0,                        0,    -6.5000000000000000E0},
+  {18, 1,                        0,                        0,     1.0000000000000000E0,                        0},
+  {17, 4,    -318.00000000000000E0,                        0,                        0,    -199.87499999999997E0},
+  {17, 3,                        0,    -39.000000000000000E0,     67.499999999999957E0,                        0},
+  {17, 2,     9.0000000000000000E0,                        0,                        0,     6.4999999999999947E0},
+  {17, 1,                        0,                        0,   -0.99999999999999978E0,                        0},
+  {16, 5,                        0,    -679.57499999999993E0,     929.85000000000014E0,                        0},
+  {16, 4,     286.87499999999983E0,                        0,                        0,     190.12500000000000E0},
+  {16, 3,                        0,     36.833333333333300E0,    -64.499999999999986E0,                        0},
+  {16, 2,    -8.4999999999999982E0,                        0,                        0,    -6.5000000000000000E0},
+  {16, 1,                        0,                        0,    0.99999999999999933E0,                        0},
+  {15, 6,     2479.6000000000004E0,                        0,                        0,     1518.2374999999995E0},
+  {15, 5,                        0,     608.39999999999998E0,    -824.02499999999941E0,                        0},
+  {15, 4,    -257.99999999999994E0,                        0,                        0,    -180.91666666666654E0},
+  {15, 3,                        0,    -34.666666666666664E0,     61.666666666666664E0,                        0},
+  {15, 2,     7.9999999999999947E0,                        0,                        0,     6.5000000000000009E0},
+  {15, 1,                        0,                        0,   -0.99999999999999956E0,                        0},
+  {14, 7,                        0,     3253.3660714285706E0,    -4311.3214285714303E0,                        0},
+  {14, 6,    -2060.0624999999982E0,                        0,                        0,    -1328.4375000000000E0},
+  {14, 5,                        0,    -542.74999999999966E0,     731.62499999999977E0,                        0},
+  {14, 4,     231.25000000000000E0,                        0,                        0,     172.25000000000000E0},
+  {14, 3,                        0,     32.500000000000007E0,    -58.999999999999986E0,                        0},
+  {14, 2,    -7.4999999999999964E0,                        0,                        0,    -6.5000000000000053E0},
+  {14, 1,                        0,                        0,     1.0000000000000004E0,                        0},
+  {13, 8,    -7544.8125000000027E0,                        0,                        0,    -4559.0390624999991E0},
+  {13, 7,                        0,    -2656.8750000000000E0,     3412.3124999999973E0,                        0},
+  {13, 6,     1707.1249999999995E0,                        0,                        0,     1164.3124999999993E0},
+  {13, 5,                        0,     482.30000000000007E0,    -651.37500000000000E0,                        0},
+  {13, 4,    -206.49999999999994E0,                        0,                        0,    -164.12500000000000E0},
+  {13, 3,                        0,    -30.333333333333357E0,     56.499999999999993E0,                        0},
+  {13, 2,     7.0000000000000036E0,                        0,                        0,     6.5000000000000036E0},
+  {13, 1,                        0,                        0,    -1.0000000000000000E0,                        0},
+  {13, 0,     1.0000000000000000E0,                        0,                        0,     1.0000000000000000E0},
+  {12, 9,                        0,    -6585.2786458333312E0,     9002.6692708333376E0,                        0},
+  {12, 8,     5545.0078124999955E0,                        0,                        0,     3515.1796875000005E0},
+  {12, 7,                        0,     2162.2946428571418E0,    -2706.4375000000000E0,                        0},
+  {12, 6,    -1411.3125000000000E0,                        0,                        0,    -1023.2624999999999E0},
+  {12, 5,                        0,    -426.72500000000002E0,     582.07499999999982E0,                        0},
+  {12, 4,     183.62499999999997E0,                        0,                        0,     156.54166666666671E0},
+  {12, 3,                        0,     28.166666666666682E0,    -54.166666666666671E0,                        0},
+  {12, 2,    -6.5000000000000000E0,                        0,                        0,    -6.4999999999999982E0},
+  {12, 1,                        0,     13.000000000000000E0,    -13.000000000000000E0,                        0},
+  {11,10,     10803.203125000005E0,                        0,                        0,     6523.3593749999991E0},
+  {11, 9,                        0,     4686.9062500000000E0,    -6114.0624999999945E0,                        0},
+  {11, 8,    -4059.6562500000000E0,                        0,                        0,    -2711.4866071428546E0},
+  {11, 7,                        0,    -1754.1642857142856E0,     2157.0714285714284E0,                        0},
+  {11, 6,     1164.1499999999996E0,                        0,                        0,     902.85000000000002E0},
+  {11, 5,                        0,     375.70000000000016E0,    -522.59999999999991E0,                        0},
+  {11, 4,    -162.50000000000000E0,                        0,                        0,    -149.50000000000003E0},
+  {11, 3,                        0,    -25.999999999999993E0,     52.000000000000000E0,                        0},
+  {11, 2,    -78.000000000000000E0,                        0,                        0,    -78.000000000000000E0},
+  {10,11,                        0,     6523.3593749999991E0,    -9305.3593750000036E0,                        0},
+  {10,10,    -6725.4687499999936E0,                        0,                        0,    -4245.3125000000009E0},
+  {10, 9,                        0,    -3314.0391865079337E0,     4133.5937500000000E0,                        0},
+  {10, 8,     2965.9732142857142E0,                        0,                        0,     2099.2910714285713E0},
+  {10, 7,                        0,     1418.7642857142857E0,    -1733.3642857142854E0,                        0},
+  {10, 6,    -958.09999999999991E0,                        0,                        0,    -800.80000000000018E0},
+  {10, 5,                        0,    -328.90000000000009E0,     471.89999999999998E0,                        0},
+  {10, 4,     143.00000000000000E0,                        0,                        0,     142.99999999999997E0},
+  {10, 3,                        0,    -286.00000000000000E0,     286.00000000000000E0,                        0},
+  { 9,12,    -7754.4661458333376E0,                        0,                        0,    -4705.0182291666652E0},
+  { 9,11,                        0,    -3859.3750000000005E0,     5227.6249999999945E0,                        0},
+  { 9,10,     4133.5937500000000E0,                        0,                        0,     2735.1587301587274E0},
+  { 9, 9,                        0,     2332.5456349206347E0,    -2796.8700396825398E0,                        0},
+  { 9, 8,    -2166.7053571428569E0,                        0,                        0,    -1638.1160714285713E0},
+  { 9, 7,                        0,    -1144.0000000000005E0,     1409.5714285714284E0,                        0},
+  { 9, 6,     786.49999999999989E0,                        0,                        0,     715.00000000000000E0},
+  { 9, 5,                        0,     285.99999999999994E0,    -429.00000000000000E0,                        0},
+  { 9, 4,     715.00000000000000E0,                        0,                        0,     715.00000000000000E0},
+  { 8,13,                        0,    -3257.3203124999991E0,     4795.3828125000036E0,                        0},
+  { 8,12,     3920.7187499999955E0,                        0,                        0,     2485.0312500000009E0},
+  { 8,11,                        0,     2237.8571428571404E0,    -2871.3750000000000E0,                        0},
+  { 8,10,    -2517.1830357142858E0,                        0,                        0,    -1753.6651785714284E0},
+  { 8, 9,                        0,    -1638.1160714285713E0,     1908.7946428571424E0,                        0},
+  { 8, 8,     1585.7678571428569E0,                        0,                        0,     1294.6607142857147E0},
+  { 8, 7,                        0,     919.28571428571422E0,    -1164.4285714285716E0,                        0},
+  { 8, 6,    -643.50000000000000E0,                        0,                        0,    -643.49999999999989E0},
+  { 8, 5,                        0,     1287.0000000000000E0,    -1287.0000000000000E0,                        0},
+  { 7,14,     2740.2187500000023E0,                        0,                        0,     1669.5937499999995E0},
+  { 7,13,                        0,     1529.2500000000005E0,    -2141.2499999999968E0,                        0},
+  { 7,12,    -1914.2500000000000E0,                        0,                        0,    -1268.8928571428557E0},
+  { 7,11,                        0,    -1275.3928571428571E0,     1548.8571428571427E0,                        0},
+  { 7,10,     1527.0357142857140E0,                        0,                        0,     1128.6785714285716E0},
+  { 7, 9,                        0,     1150.8095238095241E0,    -1327.8571428571427E0,                        0},
+  { 7, 8,    -1164.4285714285716E0,                        0,                        0,    -1041.8571428571429E0},
+  { 7, 7,                        0,    -735.42857142857133E0,     980.57142857142856E0,                        0},
+  { 7, 6,    -1716.0000000000000E0,                        0,                        0,    -1716.0000000000000E0},
+  { 6,15,                        0,     779.14374999999984E0,    -1169.3687500000010E0,                        0},
+  { 6,14,    -1070.6249999999984E0,                        0,                        0,    -682.12500000000034E0},
+  { 6,13,                        0,    -683.24999999999920E0,     906.49999999999977E0,                        0},
+  { 6,12,     903.49999999999989E0,                        0,                        0,     627.24999999999977E0},
+  { 6,11,                        0,     718.25000000000000E0,    -828.74999999999966E0,                        0},
+  { 6,10,    -929.50000000000000E0,                        0,                        0,    -738.83333333333371E0},
+  { 6, 9,                        0,    -810.33333333333326E0,     953.33333333333326E0,                        0},
+  { 6, 8,     858.00000000000000E0,                        0,                        0,     858.00000000000000E0},
+  { 6, 7,                        0,    -1716.0000000000000E0,     1716.0000000000000E0,                        0},
+  { 5,16,    -438.51328125000038E0,                        0,                        0,    -267.78984374999993E0},
+  { 5,15,                        0,    -272.85000000000014E0,     390.22499999999945E0,                        0},
+  { 5,14,     388.49999999999989E0,                        0,                        0,     259.12499999999966E0},
+  { 5,13,                        0,     289.49999999999989E0,    -362.25000000000000E0,                        0},
+  { 5,12,    -414.37499999999983E0,                        0,                        0,    -302.25000000000000E0},
+  { 5,11,                        0,    -403.00000000000023E0,     448.50000000000000E0,                        0},
+  { 5,10,     572.00000000000000E0,                        0,                        0,     500.50000000000000E0},
+  { 5, 9,                        0,     572.00000000000000E0,    -715.00000000000000E0,                        0},
+  { 5, 8,     1287.0000000000000E0,                        0,                        0,     1287.0000000000000E0},
+  { 4,17,                        0,    -78.761718749999986E0,     119.67807904411778E0,                        0},
+  { 4,16,     121.94531249999983E0,                        0,                        0,     77.929687500000028E0},
+  { 4,15,                        0,     86.374999999999886E0,    -117.37499999999997E0,                        0},
+  { 4,14,    -129.37500000000000E0,                        0,                        0,    -90.374999999999972E0},
+  { 4,13,                        0,    -116.25000000000000E0,     136.49999999999994E0,                        0},
+  { 4,12,     186.87500000000000E0,                        0,                        0,     144.62500000000006E0},
+  { 4,11,                        0,     227.50000000000000E0,    -253.50000000000000E0,                        0},
+  { 4,10,    -357.50000000000000E0,                        0,                        0,    -357.50000000000000E0},
+  { 4, 9,                        0,     715.00000000000000E0,    -715.00000000000000E0,                        0},
+  { 3,18,     26.595128676470619E0,                        0,                        0,     16.262408088235290E0},
+  { 3,17,                        0,     18.336397058823536E0,    -26.569852941176428E0,                        0},
+  { 3,16,    -29.343749999999993E0,                        0,                        0,    -19.656249999999961E0},
+  { 3,15,                        0,    -24.099999999999994E0,     31.000000000000004E0,                        0},
+  { 3,14,     38.999999999999986E0,                        0,                        0,     28.499999999999986E0},
+  { 3,13,                        0,     44.500000000000014E0,    -48.999999999999993E0,                        0},
+  { 3,12,    -84.500000000000000E0,                        0,                        0,    -71.500000000000000E0},
+  { 3,11,                        0,    -130.00000000000000E0,     156.00000000000000E0,                        0},
+  { 3,10,    -286.00000000000000E0,                        0,                        0,    -286.00000000000000E0},
+  { 2,19,                        0,     2.5677486455108349E0,    -3.9363631965944332E0,                        0},
+  { 2,18,    -4.4283088235294050E0,                        0,                        0,    -2.8345588235294135E0},
+  { 2,17,                        0,    -3.4687499999999933E0,     4.7812500000000000E0,                        0},
+  { 2,16,     5.8125000000000009E0,                        0,                        0,     4.0875000000000004E0},
+  { 2,15,                        0,     5.6999999999999975E0,    -6.8999999999999959E0,                        0},
+  { 2,14,    -10.499999999999998E0,                        0,                        0,    -8.0000000000000053E0},
+  { 2,13,                        0,    -16.500000000000000E0,     17.500000000000000E0,                        0},
+  { 2,12,     39.000000000000000E0,                        0,                        0,     39.000000000000000E0},
+  { 2,11,                        0,    -78.000000000000000E0,     78.000000000000000E0,                        0},
+  { 1,20,   -0.39363631965944335E0,                        0,                        0,   -0.24091766640866874E0},
+  { 1,19,                        0,   -0.29837461300309615E0,    0.43633900928792468E0,                        0},
+  { 1,18,    0.53125000000000000E0,                        0,                        0,    0.35661764705882293E0},
+  { 1,17,                        0,    0.48088235294117648E0,   -0.62867647058823550E0,                        0},
+  { 1,16,   -0.86249999999999949E0,                        0,                        0,   -0.63749999999999984E0},
+  { 1,15,                        0,    -1.0666666666666673E0,     1.2000000000000002E0,                        0},
+  { 1,14,     2.5000000000000000E0,                        0,                        0,     2.0000000000000000E0},
+  { 1,13,                        0,     6.0000000000000000E0,    -7.0000000000000000E0,                        0},
+  { 1,12,     13.000000000000000E0,                        0,                        0,     13.000000000000000E0},
+  { 0,21,                        0, -1.1472269828984225E-002,  1.7705684247383221E-002,                        0},
+  { 0,20,  2.1816950464396235E-002,                        0,                        0,  1.3980263157894727E-002},
+  { 0,19,                        0,  1.8769349845201205E-002, -2.6122291021671819E-002,                        0},
+  { 0,18, -3.4926470588235309E-002,                        0,                        0, -2.4632352941176442E-002},
+  { 0,17,                        0, -3.7499999999999992E-002,  4.6323529411764666E-002,                        0},
+  { 0,16,  7.5000000000000011E-002,                        0,                        0,  5.8333333333333376E-002},
+  { 0,15,                        0,    0.13333333333333333E0,   -0.13333333333333333E0,                        0},
+  { 0,14,   -0.50000000000000000E0,                        0,                        0,   -0.50000000000000000E0},
+  { 0,13,                        0,     1.0000000000000000E0,    -1.0000000000000000E0,                        0},
+  {20, 1,                        0,                        0,   -0.99999999999999956E0,                        0},
+  {19, 2,    -9.9999999999999964E0,                        0,                        0,    -6.9999999999999991E0},
+  {19, 1,                        0,                        0,     1.0000000000000009E0,                        0},
+  {18, 3,                        0,    -44.333333333333329E0,     77.166666666666629E0,                        0},
+  {18, 2,     9.5000000000000089E0,                        0,                        0,     6.9999999999999991E0},
+  {18, 1,                        0,                        0,    -1.0000000000000004E0,                        0},
+  {17, 4,     347.24999999999983E0,                        0,                        0,     236.25000000000000E0},
+  {17, 3,                        0,     41.999999999999993E0,    -74.000000000000071E0,                        0},
+  {17, 2,    -9.0000000000000036E0,                        0,                        0,    -7.0000000000000018E0},
+  {17, 1,                        0,                        0,    0.99999999999999944E0,                        0},
+  {16, 5,                        0,     803.25000000000000E0,    -1086.8249999999994E0,                        0},
+  {16, 4,    -314.50000000000028E0,                        0,                        0,    -225.75000000000000E0},
+  {16, 3,                        0,    -39.666666666666679E0,     71.000000000000057E0,                        0},
+  {16, 2,     8.4999999999999947E0,                        0,                        0,     7.0000000000000044E0},
+  {16, 1,                        0,                        0,   -0.99999999999999956E0,                        0},
+  {15, 6,    -2898.1999999999980E0,                        0,                        0,    -1922.7249999999997E0},
+  {15, 5,                        0,    -722.39999999999998E0,     975.47500000000082E0,                        0},
+  {15, 4,     284.00000000000023E0,                        0,                        0,     215.83333333333340E0},
+  {15, 3,                        0,     37.333333333333357E0,    -68.166666666666657E0,                        0},
+  {15, 2,    -7.9999999999999964E0,                        0,                        0,    -6.9999999999999991E0},
+  {15, 1,                        0,                        0,    0.99999999999999956E0,                        0},
+  {14, 7,                        0,    -4120.1249999999991E0,     5233.0446428571395E0,                        0},
+  {14, 6,     2438.6875000000018E0,                        0,                        0,     1707.1249999999995E0},
+  {14, 5,                        0,     647.50000000000023E0,    -877.87500000000068E0,                        0},
+  {14, 4,    -255.62499999999997E0,                        0,                        0,    -206.50000000000011E0},
+  {14, 3,                        0,    -34.999999999999993E0,     65.499999999999986E0,                        0},
+  {14, 2,     7.4999999999999964E0,                        0,                        0,     7.0000000000000018E0},
+  {14, 1,                        0,                        0,    -1.0000000000000000E0,                        0},
+  {14, 0,     1.0000000000000000E0,                        0,                        0,     1.0000000000000000E0},
+  {13, 8,     9157.8281249999945E0,                        0,                        0,     5971.5468749999991E0},
+  {13, 7,                        0,     3414.2499999999991E0,    -4248.3750000000045E0,                        0},
+  {13, 6,    -2048.3750000000018E0,                        0,                        0,    -1519.8750000000000E0},
+  {13, 5,                        0,    -578.20000000000039E0,     792.74999999999966E0,                        0},
+  {13, 4,     229.24999999999994E0,                        0,                        0,     197.75000000000000E0},
+  {13, 3,                        0,     32.666666666666671E0,    -62.999999999999979E0,                        0},
+  {13, 2,    -7.0000000000000000E0,                        0,                        0,    -6.9999999999999991E0},
+  {13, 1,                        0,     14.000000000000000E0,    -14.000000000000000E0,                        0},
+  {12, 9,                        0,     8625.5677083333321E0,    -11010.052083333323E0,                        0},
+  {12, 8,    -6903.6093750000073E0,                        0,                        0,    -4736.2656249999991E0},
+  {12, 7,                        0,    -2822.6250000000000E0,     3467.7500000000023E0,                        0},
+  {12, 6,     1717.6249999999993E0,                        0,                        0,     1358.1750000000006E0},
+  {12, 5,                        0,     514.14999999999998E0,    -718.89999999999975E0,                        0},
+  {12, 4,    -204.74999999999994E0,                        0,                        0,    -189.58333333333331E0},
+  {12, 3,                        0,    -30.333333333333329E0,     60.666666666666664E0,                        0},
+  {12, 2,    -91.000000000000000E0,                        0,                        0,    -91.000000000000000E0},
+  {11,10,    -13212.062499999989E0,                        0,                        0,    -8559.6875000000000E0},
+  {11, 9,                        0,    -6315.0208333333321E0,     7753.9583333333412E0,                        0},
+  {11, 8,     5201.6250000000036E0,                        0,                        0,     3774.8750000000000E0},
+  {11, 7,                        0,     2328.3000000000011E0,    -2853.4999999999986E0,                        0},
+  {11, 6,    -1437.7999999999995E0,                        0,                        0,    -1219.3999999999999E0},
+  {11, 5,                        0,    -455.00000000000000E0,     655.20000000000005E0,                        0},
+  {11, 4,     182.00000000000000E0,                        0,                        0,     182.00000000000003E0},
+  {11, 3,                        0,    -364.00000000000000E0,     364.00000000000000E0,                        0},
+  {10,11,                        0,    -8559.6875000000000E0,     11272.624999999987E0,                        0},
+  {10,10,     8529.3541666666752E0,                        0,                        0,     5787.0312499999991E0},
+  {10, 9,                        0,     4613.7361111111113E0,    -5484.6458333333394E0,                        0},
+  {10, 8,    -3923.5624999999982E0,                        0,                        0,    -3033.3875000000016E0},
+  {10, 7,                        0,    -1916.1999999999998E0,     2373.7999999999997E0,                        0},
+  {10, 6,     1201.2000000000000E0,                        0,                        0,     1101.0999999999999E0},
+  {10, 5,                        0,     400.40000000000009E0,    -600.59999999999991E0,                        0},
+  {10, 4,     1001.0000000000000E0,                        0,                        0,     1001.0000000000000E0},
+  { 9,12,     9393.8541666666570E0,                        0,                        0,     6098.8958333333321E0},
+  { 9,11,                        0,     5260.9374999999991E0,    -6589.9166666666742E0,                        0},
+  { 9,10,    -5484.6458333333394E0,                        0,                        0,    -3915.6180555555557E0},
+  { 9, 9,                        0,    -3370.4305555555575E0,     3922.5694444444434E0,                        0},
+  { 9, 8,     2967.2499999999995E0,                        0,                        0,     2466.7500000000000E0},
+  { 9, 7,                        0,     1572.9999999999998E0,    -2001.9999999999998E0,                        0},
+  { 9, 6,    -1001.0000000000000E0,                        0,                        0,    -1001.0000000000000E0},
+  { 9, 5,                        0,     2002.0000000000000E0,    -2002.0000000000000E0,                        0},
+  { 8,13,                        0,     4222.3124999999991E0,    -5743.4999999999909E0,                        0},
+  { 8,12,    -4942.4375000000055E0,                        0,                        0,    -3349.9374999999986E0},
+  { 8,11,                        0,    -3203.6875000000000E0,     3822.0000000000041E0,                        0},
+  { 8,10,     3530.3124999999991E0,                        0,                        0,     2672.3125000000018E0},
+  { 8, 9,                        0,     2466.7500000000000E0,    -2859.9999999999995E0,                        0},
+  { 8, 8,    -2252.2499999999995E0,                        0,                        0,    -2037.7500000000000E0},
+  { 8, 7,                        0,    -1287.0000000000000E0,     1716.0000000000000E0,                        0},
+  { 8, 6,    -3003.0000000000000E0,                        0,                        0,    -3003.0000000000000E0},
+  { 7,14,    -3281.9999999999950E0,                        0,                        0,    -2141.2499999999991E0},
+  { 7,13,                        0,    -2061.4999999999991E0,     2661.7500000000032E0,                        0},
+  { 7,12,     2548.0000000000027E0,                        0,                        0,     1806.9999999999995E0},
+  { 7,11,                        0,     1943.5000000000014E0,    -2222.9999999999991E0,                        0},
+  { 7,10,    -2287.9999999999995E0,                        0,                        0,    -1859.0000000000000E0},
+  { 7, 9,                        0,    -1811.3333333333333E0,     2144.9999999999995E0,                        0},
+  { 7, 8,     1716.0000000000000E0,                        0,                        0,     1716.0000000000002E0},
+  { 7, 7,                        0,    -3432.0000000000000E0,     3432.0000000000000E0,                        0},
+  { 6,15,                        0,    -999.24999999999955E0,     1390.6749999999975E0,                        0},
+  { 6,14,     1330.8750000000016E0,                        0,                        0,     906.49999999999966E0},
+  { 6,13,                        0,     972.99999999999977E0,    -1188.2500000000016E0,                        0},
+  { 6,12,    -1296.7499999999995E0,                        0,                        0,    -966.87500000000057E0},
+  { 6,11,                        0,    -1183.0000000000000E0,     1319.4999999999995E0,                        0},
+  { 6,10,     1501.4999999999998E0,                        0,                        0,     1334.6666666666665E0},
+  { 6, 9,                        0,     1334.6666666666667E0,    -1668.3333333333335E0,                        0},
+  { 6, 8,     3003.0000000000000E0,                        0,                        0,     3003.0000000000000E0},
+  { 5,16,     521.50312499999905E0,                        0,                        0,     341.44687500000003E0},
+  { 5,15,                        0,     362.59999999999985E0,    -480.15000000000066E0,                        0},
+  { 5,14,    -509.25000000000068E0,                        0,                        0,    -362.25000000000000E0},
+  { 5,13,                        0,    -446.25000000000023E0,     514.49999999999977E0,                        0},
+  { 5,12,     659.74999999999977E0,                        0,                        0,     523.25000000000000E0},
+  { 5,11,                        0,     728.00000000000000E0,    -819.00000000000000E0,                        0},
+  { 5,10,    -1001.0000000000000E0,                        0,                        0,    -1001.0000000000000E0},
+  { 5, 9,                        0,     2002.0000000000000E0,    -2002.0000000000000E0,                        0},
+  { 4,17,                        0,     100.42555147058823E0,    -141.76654411764679E0,                        0},
+  { 4,16,    -150.04687500000020E0,                        0,                        0,    -102.70312499999993E0},
+  { 4,15,                        0,    -120.75000000000000E0,     151.50000000000028E0,                        0},
+  { 4,14,     183.74999999999994E0,                        0,                        0,     136.50000000000011E0},
+  { 4,13,                        0,     201.25000000000000E0,    -220.49999999999994E0,                        0},
+  { 4,12,    -341.25000000000000E0,                        0,                        0,    -295.75000000000000E0},
+  { 4,11,                        0,    -455.00000000000000E0,     546.00000000000000E0,                        0},
+  { 4,10,    -1001.0000000000000E0,                        0,                        0,    -1001.0000000000000E0},
+  { 3,18,    -31.503676470588175E0,                        0,                        0,    -20.665441176470583E0},
+  { 3,17,                        0,    -24.165441176470573E0,     32.514705882352978E0,                        0},
+  { 3,16,     37.875000000000071E0,                        0,                        0,     27.124999999999986E0},
+  { 3,15,                        0,     36.400000000000027E0,    -42.999999999999979E0,                        0},
+  { 3,14,    -62.999999999999986E0,                        0,                        0,    -49.000000000000007E0},
+  { 3,13,                        0,    -91.000000000000000E0,     97.999999999999986E0,                        0},
+  { 3,12,     182.00000000000000E0,                        0,                        0,     182.00000000000000E0},
+  { 3,11,                        0,    -364.00000000000000E0,     364.00000000000000E0,                        0},
+  { 2,19,                        0,    -3.2629643962848291E0,     4.6507352941176361E0,                        0},
+  { 2,18,     5.4191176470588296E0,                        0,                        0,     3.7187499999999987E0},
+  { 2,17,                        0,     4.7867647058823506E0,    -6.1213235294117787E0,                        0},
+  { 2,16,    -8.0624999999999964E0,                        0,                        0,    -6.0375000000000050E0},
+  { 2,15,                        0,    -9.8000000000000007E0,     10.799999999999997E0,                        0},
+  { 2,14,     20.999999999999996E0,                        0,                        0,     17.499999999999996E0},
+  { 2,13,                        0,     42.000000000000000E0,    -49.000000000000000E0,                        0},
+  { 2,12,     91.000000000000000E0,                        0,                        0,     91.000000000000000E0},
+  { 1,20,    0.46507352941176361E0,                        0,                        0,    0.30543730650154788E0},
+  { 1,19,                        0,    0.39144736842105249E0,   -0.53212074303405643E0,                        0},
+  { 1,18,   -0.68014705882353099E0,                        0,                        0,   -0.48897058823529393E0},
+  { 1,17,                        0,   -0.71029411764705941E0,    0.86029411764705854E0,                        0},
+  { 1,16,     1.3499999999999996E0,                        0,                        0,     1.0500000000000003E0},
+  { 1,15,                        0,     2.3333333333333330E0,    -2.3999999999999995E0,                        0},
+  { 1,14,    -7.0000000000000000E0,                        0,                        0,    -7.0000000000000000E0},
+  { 1,13,                        0,     14.000000000000000E0,    -14.000000000000000E0,                        0},
+  { 0,21,                        0,  1.4544633642930850E-002, -2.0879404393336194E-002,                        0},
+  { 0,20, -2.6606037151702819E-002,                        0,                        0, -1.8285603715170275E-002},
+  { 0,19,                        0, -2.5735294117647051E-002,  3.3281733746130075E-002,                        0},
+  { 0,18,  4.7794117647058806E-002,                        0,                        0,  3.6029411764705851E-002},
+  { 0,17,                        0,  6.1764705882352951E-002, -7.0588235294117618E-002,                        0},
+  { 0,16,   -0.14999999999999997E0,                        0,                        0,   -0.11666666666666664E0},
+  { 0,15,                        0,   -0.46666666666666667E0,    0.53333333333333333E0,                        0},
+  { 0,14,    -1.0000000000000000E0,                        0,                        0,    -1.0000000000000000E0},
+  {20, 1,                        0,                        0,    0.99999999999999933E0,                        0},
+  {19, 2,     9.9999999999999929E0,                        0,                        0,     7.5000000000000018E0},
+  {19, 1,                        0,                        0,    -1.0000000000000000E0,                        0},
+  {18, 3,                        0,     47.500000000000007E0,    -84.166666666666643E0,                        0},
+  {18, 2,    -9.5000000000000000E0,                        0,                        0,    -7.5000000000000027E0},
+  {18, 1,                        0,                        0,     1.0000000000000000E0,                        0},
+  {17, 4,    -378.74999999999989E0,                        0,                        0,    -277.50000000000006E0},
+  {17, 3,                        0,    -45.000000000000014E0,     81.000000000000000E0,                        0},
+  {17, 2,     9.0000000000000000E0,                        0,                        0,     7.5000000000000027E0},
+  {17, 1,                        0,                        0,    -1.0000000000000002E0,                        0},
+  {16, 5,                        0,    -943.50000000000023E0,     1276.8749999999995E0,                        0},
+  {16, 4,     344.25000000000000E0,                        0,                        0,     266.25000000000006E0},
+  {16, 3,                        0,     42.500000000000014E0,    -78.000000000000014E0,                        0},
+  {16, 2,    -8.5000000000000018E0,                        0,                        0,    -7.5000000000000000E0},
+  {16, 1,                        0,                        0,     1.0000000000000004E0,                        0},
+  {15, 6,     3404.9999999999986E0,                        0,                        0,     2438.6875000000009E0},
+  {15, 5,                        0,     852.00000000000011E0,    -1159.5749999999998E0,                        0},
+  {15, 4,    -312.00000000000006E0,                        0,                        0,    -255.62500000000000E0},
+  {15, 3,                        0,    -40.000000000000000E0,     75.166666666666686E0,                        0},
+  {15, 2,     8.0000000000000036E0,                        0,                        0,     7.4999999999999973E0},
+  {15, 1,                        0,                        0,    -1.0000000000000000E0,                        0},
+  {15, 0,     1.0000000000000000E0,                        0,                        0,     1.0000000000000000E0},
+  {14, 7,                        0,     5225.7589285714303E0,    -6478.1696428571404E0,                        0},
+  {14, 6,    -2898.9374999999995E0,                        0,                        0,    -2194.6875000000005E0},
+  {14, 5,                        0,    -766.87500000000000E0,     1056.3750000000000E0,                        0},
+  {14, 4,     281.87500000000006E0,                        0,                        0,     245.62500000000000E0},
+  {14, 3,                        0,     37.499999999999986E0,    -72.500000000000000E0,                        0},
+  {14, 2,    -7.5000000000000000E0,                        0,                        0,    -7.5000000000000000E0},
+  {14, 1,                        0,     15.000000000000000E0,    -15.000000000000000E0,                        0},
+  {13, 8,    -11336.796874999996E0,                        0,                        0,    -7965.7031250000018E0},
+  {13, 7,                        0,    -4389.3750000000009E0,     5393.7499999999982E0,                        0},
+  {13, 6,     2464.8750000000000E0,                        0,                        0,     1981.8750000000000E0},
+  {13, 5,                        0,     687.75000000000000E0,    -966.00000000000034E0,                        0},
+  {13, 4,    -253.75000000000000E0,                        0,                        0,    -236.25000000000000E0},
+  {13, 3,                        0,    -35.000000000000000E0,     70.000000000000000E0,                        0},
+  {13, 2,    -105.00000000000000E0,                        0,                        0,    -105.00000000000000E0},
+  {12, 9,                        0,    -11506.015625000004E0,     13962.022569444438E0,                        0},
+  {12, 8,     8764.8437499999964E0,                        0,                        0,     6502.0312500000027E0},
+  {12, 7,                        0,     3680.6250000000000E0,    -4525.6250000000000E0,                        0},
+  {12, 6,    -2093.0000000000009E0,                        0,                        0,    -1797.2500000000000E0},
+  {12, 5,                        0,    -614.25000000000000E0,     887.25000000000000E0,                        0},
+  {12, 4,     227.50000000000000E0,                        0,                        0,     227.50000000000000E0},
+  {12, 3,                        0,    -455.00000000000000E0,     455.00000000000000E0,                        0},
+  {11,10,     16754.427083333328E0,                        0,                        0,     11630.937500000004E0},
+  {11, 9,                        0,     8669.3750000000036E0,    -10246.979166666662E0,                        0},
+  {11, 8,    -6788.4375000000000E0,                        0,                        0,    -5350.3125000000009E0},
+  {11, 7,                        0,    -3081.0000000000000E0,     3835.0000000000005E0,                        0},
+  {11, 6,     1774.5000000000000E0,                        0,                        0,     1638.0000000000000E0},
+  {11, 5,                        0,     546.00000000000000E0,    -819.00000000000000E0,                        0},
+  {11, 4,     1365.0000000000000E0,                        0,                        0,     1365.0000000000000E0},
+  {10,11,                        0,     11630.937500000004E0,    -14286.999999999993E0,                        0},
+  {10,10,    -11271.677083333328E0,                        0,                        0,    -8226.9687500000055E0},
+  {10, 9,                        0,    -6539.2708333333339E0,     7611.7708333333339E0,                        0},
+  {10, 8,     5273.1250000000009E0,                        0,                        0,     4450.8750000000000E0},
+  {10, 7,                        0,     2574.0000000000000E0,    -3289.0000000000005E0,                        0},
+  {10, 6,    -1501.5000000000000E0,                        0,                        0,    -1501.5000000000000E0},
+  {10, 5,                        0,     3003.0000000000000E0,    -3003.0000000000000E0,                        0},
+  { 9,12,    -11905.833333333328E0,                        0,                        0,    -8237.3958333333376E0},
+  { 9,11,                        0,    -7479.0625000000045E0,     8804.2499999999964E0,                        0},
+  { 9,10,     7611.7708333333339E0,                        0,                        0,     5883.8541666666679E0},
+  { 9, 9,                        0,     4945.4166666666661E0,    -5759.7222222222226E0,                        0},
+  { 9, 8,    -4111.2500000000009E0,                        0,                        0,    -3753.7499999999991E0},
+  { 9, 7,                        0,    -2145.0000000000000E0,     2860.0000000000000E0,                        0},
+  { 9, 6,    -5005.0000000000000E0,                        0,                        0,    -5005.0000000000000E0},
+  { 8,13,                        0,    -5702.8125000000027E0,     7190.3124999999955E0,                        0},
+  { 8,12,     6603.1874999999973E0,                        0,                        0,     4777.5000000000018E0},
+  { 8,11,                        0,     4814.0625000000018E0,    -5477.0625000000000E0,                        0},
+  { 8,10,    -5183.7500000000009E0,                        0,                        0,    -4289.9999999999991E0},
+  { 8, 9,                        0,    -3753.7499999999991E0,     4468.7500000000009E0,                        0},
+  { 8, 8,     3217.5000000000000E0,                        0,                        0,     3217.5000000000000E0},
+  { 8, 7,                        0,    -6435.0000000000000E0,     6435.0000000000000E0,                        0},
+  { 7,14,     4108.7499999999973E0,                        0,                        0,     2851.8750000000005E0},
+  { 7,13,                        0,     2940.0000000000014E0,    -3519.2499999999977E0,                        0},
+  { 7,12,    -3651.3750000000000E0,                        0,                        0,    -2778.7500000000005E0},
+  { 7,11,                        0,    -3119.9999999999995E0,     3490.5000000000009E0,                        0},
+  { 7,10,     3575.0000000000005E0,                        0,                        0,     3217.5000000000000E0},
+  { 7, 9,                        0,     2860.0000000000000E0,    -3575.0000000000000E0,                        0},
+  { 7, 8,     6435.0000000000000E0,                        0,                        0,     6435.0000000000000E0},
+  { 6,15,                        0,     1330.8750000000002E0,    -1720.9583333333326E0,                        0},
+  { 6,14,    -1759.6249999999989E0,                        0,                        0,    -1273.1250000000007E0},
+  { 6,13,                        0,    -1496.2500000000002E0,     1702.7500000000002E0,                        0},
+  { 6,12,     2036.1250000000005E0,                        0,                        0,     1649.3750000000000E0},
+  { 6,11,                        0,     2047.5000000000000E0,    -2320.5000000000000E0,                        0},
+  { 6,10,    -2502.5000000000000E0,                        0,                        0,    -2502.5000000000000E0},
+  { 6, 9,                        0,     5005.0000000000000E0,    -5005.0000000000000E0,                        0},
+  { 5,16,    -645.35937499999977E0,                        0,                        0,    -450.14062500000011E0},
+  { 5,15,                        0,    -509.25000000000023E0,     624.69999999999970E0,                        0},
+  { 5,14,     729.75000000000011E0,                        0,                        0,     551.25000000000011E0},
+  { 5,13,                        0,     761.25000000000000E0,    -833.00000000000023E0,                        0},
+  { 5,12,    -1160.2500000000000E0,                        0,                        0,    -1023.7500000000000E0},
+  { 5,11,                        0,    -1365.0000000000000E0,     1638.0000000000000E0,                        0},
+  { 5,10,    -3003.0000000000000E0,                        0,                        0,    -3003.0000000000000E0},
+  { 4,17,                        0,    -132.39430147058826E0,     174.25091911764696E0,                        0},
+  { 4,16,     195.21874999999991E0,                        0,                        0,     142.03125000000006E0},
+  { 4,15,                        0,     183.75000000000003E0,    -212.75000000000000E0,                        0},
+  { 4,14,    -297.50000000000006E0,                        0,                        0,    -236.24999999999994E0},
+  { 4,13,                        0,    -393.75000000000000E0,     428.75000000000006E0,                        0},
+  { 4,12,     682.50000000000000E0,                        0,                        0,     682.50000000000000E0},
+  { 4,11,                        0,    -1365.0000000000000E0,     1365.0000000000000E0,                        0},
+  { 3,18,     38.722426470588211E0,                        0,                        0,     27.095588235294130E0},
+  { 3,17,                        0,     33.419117647058840E0,    -41.856617647058798E0,                        0},
+  { 3,16,    -53.187500000000000E0,                        0,                        0,    -40.312500000000014E0},
+  { 3,15,                        0,    -62.999999999999986E0,     68.666666666666671E0,                        0},
+  { 3,14,     122.50000000000001E0,                        0,                        0,     104.99999999999999E0},
+  { 3,13,                        0,     210.00000000000000E0,    -245.00000000000000E0,                        0},
+  { 3,12,     455.00000000000000E0,                        0,                        0,     455.00000000000000E0},
+  { 2,19,                        0,     4.2782507739938094E0,    -5.6936919504643910E0,                        0},
+  { 2,18,    -6.9761029411764657E0,                        0,                        0,    -5.1011029411764746E0},
+  { 2,17,                        0,    -7.1139705882352962E0,     8.4375000000000018E0,                        0},
+  { 2,16,     12.875000000000000E0,                        0,                        0,     10.124999999999998E0},
+  { 2,15,                        0,     20.999999999999996E0,    -22.000000000000004E0,                        0},
+  { 2,14,    -52.500000000000000E0,                        0,                        0,    -52.500000000000000E0},
+  { 2,13,                        0,     105.00000000000000E0,    -105.00000000000000E0,                        0},
+  { 1,20,   -0.56936919504643912E0,                        0,                        0,   -0.39909055727554199E0},
+  { 1,19,                        0,   -0.53695820433436570E0,    0.68111455108359120E0,                        0},
+  { 1,18,    0.93750000000000022E0,                        0,                        0,    0.71691176470588258E0},
+  { 1,17,                        0,     1.1911764705882351E0,    -1.3235294117647058E0,                        0},
+  { 1,16,    -2.7500000000000004E0,                        0,                        0,    -2.2499999999999996E0},
+  { 1,15,                        0,    -7.0000000000000000E0,     8.0000000000000000E0,                        0},
+  { 1,14,    -15.000000000000000E0,                        0,                        0,    -15.000000000000000E0},
+  { 0,21,                        0, -1.9004312251216286E-002,  2.5491117499631392E-002,                        0},
+  { 0,20,  3.4055727554179557E-002,                        0,                        0,  2.4961300309597544E-002},
+  { 0,19,                        0,  3.7732198142414873E-002, -4.5472136222910214E-002,                        0},
+  { 0,18, -7.3529411764705885E-002,                        0,                        0, -5.8823529411764677E-002},
+  { 0,17,                        0,   -0.13235294117647056E0,    0.13235294117647059E0,                        0},
+  { 0,16,    0.50000000000000000E0,                        0,                        0,    0.50000000000000000E0},
+  { 0,15,                        0,    -1.0000000000000000E0,     1.0000000000000000E0,                        0},
+  {20, 1,                        0,                        0,   -0.99999999999999878E0,                        0},
+  {19, 2,    -9.9999999999999876E0,                        0,                        0,    -8.0000000000000053E0},
+  {19, 1,                        0,                        0,     1.0000000000000009E0,                        0},
+  {18, 3,                        0,    -50.666666666666700E0,     91.666666666666629E0,                        0},
+  {18, 2,     9.5000000000000089E0,                        0,                        0,     8.0000000000000018E0},
+  {18, 1,                        0,                        0,   -0.99999999999999978E0,                        0},
+  {17, 4,     412.49999999999983E0,                        0,                        0,     324.00000000000006E0},
+  {17, 3,                        0,     48.000000000000014E0,    -88.500000000000028E0,                        0},
+  {17, 2,    -8.9999999999999982E0,                        0,                        0,    -7.9999999999999982E0},
+  {17, 1,                        0,                        0,     1.0000000000000004E0,                        0},
+  {16, 5,                        0,     1101.6000000000001E0,    -1504.8749999999991E0,                        0},
+  {16, 4,    -376.12500000000011E0,                        0,                        0,    -312.00000000000011E0},
+  {16, 3,                        0,    -45.333333333333321E0,     85.500000000000000E0,                        0},
+  {16, 2,     8.5000000000000036E0,                        0,                        0,     7.9999999999999982E0},
+  {16, 1,                        0,                        0,    -1.0000000000000000E0,                        0},
+  {16, 0,     1.0000000000000000E0,                        0,                        0,     1.0000000000000000E0},
+  {15, 6,    -4012.9999999999977E0,                        0,                        0,    -3092.2000000000003E0},
+  {15, 5,                        0,    -998.40000000000032E0,     1381.2000000000003E0,                        0},
+  {15, 4,     342.00000000000000E0,                        0,                        0,     300.66666666666669E0},
+  {15, 3,                        0,     42.666666666666657E0,    -82.666666666666700E0,                        0},
+  {15, 2,    -8.0000000000000000E0,                        0,                        0,    -7.9999999999999982E0},
+  {15, 1,                        0,     16.000000000000000E0,    -16.000000000000000E0,                        0},
+  {14, 7,                        0,    -6626.1428571428578E0,     8149.9999999999945E0,                        0},
+  {14, 6,     3453.0000000000009E0,                        0,                        0,     2817.0000000000005E0},
+  {14, 5,                        0,     902.00000000000011E0,    -1272.0000000000000E0,                        0},
+  {14, 4,    -310.00000000000011E0,                        0,                        0,    -290.00000000000000E0},
+  {14, 3,                        0,    -39.999999999999993E0,     80.000000000000000E0,                        0},
+  {14, 2,    -120.00000000000000E0,                        0,                        0,    -120.00000000000000E0},
+  {13, 8,     14262.499999999991E0,                        0,                        0,     10787.500000000002E0},
+  {13, 7,                        0,     5634.0000000000009E0,    -6950.0000000000018E0,                        0},
+  {13, 6,    -2968.0000000000000E0,                        0,                        0,    -2575.9999999999995E0},
+  {13, 5,                        0,    -812.00000000000000E0,     1176.0000000000002E0,                        0},
+  {13, 4,     280.00000000000000E0,                        0,                        0,     280.00000000000000E0},
+  {13, 3,                        0,    -560.00000000000000E0,     560.00000000000000E0,                        0},
+  {12, 9,                        0,     15581.944444444447E0,    -18349.861111111099E0,                        0},
+  {12, 8,    -11293.750000000004E0,                        0,                        0,    -9051.2500000000018E0},
+  {12, 7,                        0,    -4783.9999999999991E0,     5979.9999999999991E0,                        0},
+  {12, 6,     2548.0000000000005E0,                        0,                        0,     2366.0000000000000E0},
+  {12, 5,                        0,     728.00000000000000E0,    -1092.0000000000000E0,                        0},
+  {12, 4,     1820.0000000000000E0,                        0,                        0,     1820.0000000000000E0},
+  {11,10,    -22019.833333333318E0,                        0,                        0,    -16395.166666666668E0},
+  {11, 9,                        0,    -12068.333333333336E0,     14061.666666666670E0,                        0},
+  {11, 8,     8969.9999999999982E0,                        0,                        0,     7669.9999999999982E0},
+  {11, 7,                        0,     4056.0000000000000E0,    -5200.0000000000009E0,                        0},
+  {11, 6,    -2184.0000000000000E0,                        0,                        0,    -2184.0000000000000E0},
+  {11, 5,                        0,     4368.0000000000000E0,    -4368.0000000000000E0,                        0},
+  {10,11,                        0,    -16395.166666666668E0,     19109.999999999985E0,                        0},
+  {10,10,     15467.833333333336E0,                        0,                        0,     12178.833333333336E0},
+  {10, 9,                        0,     9374.4444444444434E0,    -10963.333333333332E0,                        0},
+  {10, 8,    -7150.0000000000009E0,                        0,                        0,    -6578.0000000000000E0},
+  {10, 7,                        0,    -3432.0000000000000E0,     4576.0000000000000E0,                        0},
+  {10, 6,    -8008.0000000000000E0,                        0,                        0,    -8008.0000000000000E0},
+  { 9,12,     15924.999999999989E0,                        0,                        0,     11739.000000000000E0},
+  { 9,11,                        0,     11071.666666666670E0,    -12558.000000000000E0,                        0},
+  { 9,10,    -10963.333333333332E0,                        0,                        0,    -9215.5555555555547E0},
+  { 9, 9,                        0,    -7308.8888888888887E0,     8738.8888888888905E0,                        0},
+  { 9, 8,     5720.0000000000000E0,                        0,                        0,     5720.0000000000000E0},
+  { 9, 7,                        0,    -11440.000000000000E0,     11440.000000000000E0,                        0},
+  { 8,13,                        0,     8127.0000000000000E0,    -9572.4999999999891E0,                        0},
+  { 8,12,    -9418.5000000000000E0,                        0,                        0,    -7302.7500000000027E0},
+  { 8,11,                        0,    -7539.9999999999991E0,     8462.9999999999982E0,                        0},
+  { 8,10,     7865.0000000000009E0,                        0,                        0,     7150.0000000000000E0},
+  { 8, 9,                        0,     5720.0000000000000E0,    -7150.0000000000000E0,                        0},
+  { 8, 8,     12870.000000000000E0,                        0,                        0,     12870.000000000000E0},
+  { 7,14,    -5469.9999999999936E0,                        0,                        0,    -4022.0000000000009E0},
+  { 7,13,                        0,    -4494.0000000000018E0,     5068.0000000000018E0,                        0},
+  { 7,12,     5641.9999999999991E0,                        0,                        0,     4653.9999999999991E0},
+  { 7,11,                        0,     5200.0000000000000E0,    -5928.0000000000009E0,                        0},
+  { 7,10,    -5720.0000000000000E0,                        0,                        0,    -5720.0000000000000E0},
+  { 7, 9,                        0,     11440.000000000000E0,    -11440.000000000000E0,                        0},
+  { 6,15,                        0,    -1876.9333333333336E0,     2257.3333333333312E0,                        0},
+  { 6,14,     2534.0000000000009E0,                        0,                        0,     1946.0000000000011E0},
+  { 6,13,                        0,     2505.9999999999995E0,    -2744.0000000000000E0,                        0},
+  { 6,12,    -3458.0000000000005E0,                        0,                        0,    -3094.0000000000000E0},
+  { 6,11,                        0,    -3640.0000000000000E0,     4368.0000000000000E0,                        0},
+  { 6,10,    -8008.0000000000000E0,                        0,                        0,    -8008.0000000000000E0},
+  { 5,16,     846.49999999999920E0,                        0,                        0,     624.70000000000005E0},
+  { 5,15,                        0,     778.40000000000043E0,    -887.20000000000039E0,                        0},
+  { 5,14,    -1176.0000000000000E0,                        0,                        0,    -952.00000000000000E0},
+  { 5,13,                        0,    -1428.0000000000000E0,     1568.0000000000002E0,                        0},
+  { 5,12,     2184.0000000000000E0,                        0,                        0,     2184.0000000000000E0},
+  { 5,11,                        0,    -4368.0000000000000E0,     4368.0000000000000E0,                        0},
+  { 4,17,                        0,     183.73529411764707E0,    -225.66176470588206E0,                        0},
+  { 4,16,    -277.25000000000011E0,                        0,                        0,    -212.75000000000014E0},
+  { 4,15,                        0,    -317.33333333333337E0,     344.00000000000000E0,                        0},
+  { 4,14,     560.00000000000011E0,                        0,                        0,     489.99999999999994E0},
+  { 4,13,                        0,     840.00000000000000E0,    -980.00000000000000E0,                        0},
+  { 4,12,     1820.0000000000000E0,                        0,                        0,     1820.0000000000000E0},
+  { 3,18,    -50.147058823529349E0,                        0,                        0,    -37.205882352941174E0},
+  { 3,17,                        0,    -50.058823529411796E0,     58.235294117647072E0,                        0},
+  { 3,16,     86.000000000000000E0,                        0,                        0,     68.666666666666657E0},
+  { 3,15,                        0,     130.66666666666666E0,    -138.66666666666669E0,                        0},
+  { 3,14,    -280.00000000000000E0,                        0,                        0,    -279.99999999999994E0},
+  { 3,13,                        0,     560.00000000000000E0,    -560.00000000000000E0,                        0},
+  { 2,19,                        0,    -5.8746130030959751E0,     7.3219814241485945E0,                        0},
+  { 2,18,     9.7058823529411793E0,                        0,                        0,     7.5000000000000044E0},
+  { 2,17,                        0,     12.117647058823529E0,    -13.235294117647056E0,                        0},
+  { 2,16,    -26.000000000000004E0,                        0,                        0,    -21.999999999999996E0},
+  { 2,15,                        0,    -55.999999999999993E0,     64.000000000000000E0,                        0},
+  { 2,14,    -120.00000000000000E0,                        0,                        0,    -120.00000000000000E0},
+  { 1,20,    0.73219814241485948E0,                        0,                        0,    0.54489164086687336E0},
+  { 1,19,                        0,    0.78947368421052677E0,   -0.93653250773993835E0,                        0},
+  { 1,18,    -1.4705882352941173E0,                        0,                        0,    -1.1764705882352946E0},
+  { 1,17,                        0,    -2.5882352941176467E0,     2.6470588235294121E0,                        0},
+  { 1,16,     8.0000000000000000E0,                        0,                        0,     8.0000000000000000E0},
+  { 1,15,                        0,    -16.000000000000000E0,     16.000000000000000E0,                        0},
+  { 0,21,                        0,  2.5947220993660636E-002, -3.2636738906088647E-002,                        0},
+  { 0,20, -4.6826625386996917E-002,                        0,                        0, -3.6377708978328212E-002},
+  { 0,19,                        0, -6.1919504643962869E-002,  6.9659442724458218E-002,                        0},
+  { 0,18,    0.14705882352941180E0,                        0,                        0,    0.11764705882352938E0},
+  { 0,17,                        0,    0.47058823529411764E0,   -0.52941176470588236E0,                        0},
+  { 0,16,     1.0000000000000000E0,                        0,                        0,     1.0000000000000000E0},
+  {20, 1,                        0,                        0,     1.0000000000000009E0,                        0},
+  {19, 2,     10.000000000000009E0,                        0,                        0,     8.4999999999999929E0},
+  {19, 1,                        0,                        0,    -1.0000000000000004E0,                        0},
+  {18, 3,                        0,     53.833333333333286E0,    -99.666666666666742E0,                        0},
+  {18, 2,    -9.5000000000000036E0,                        0,                        0,    -8.5000000000000000E0},
+  {18, 1,                        0,                        0,    0.99999999999999911E0,                        0},
+  {17, 4,    -448.50000000000034E0,                        0,                        0,    -376.12499999999983E0},
+  {17, 3,                        0,    -50.999999999999993E0,     96.500000000000057E0,                        0},
+  {17, 2,     8.9999999999999929E0,                        0,                        0,     8.5000000000000036E0},
+  {17, 1,                        0,                        0,    -1.0000000000000000E0,                        0},
+  {17, 0,     1.0000000000000000E0,                        0,                        0,     1.0000000000000000E0},
+  {16, 5,                        0,    -1278.8249999999994E0,     1776.0750000000010E0,                        0},
+  {16, 4,     410.12500000000023E0,                        0,                        0,     363.37500000000006E0},
+  {16, 3,                        0,     48.166666666666693E0,    -93.499999999999986E0,                        0},
+  {16, 2,    -8.5000000000000000E0,                        0,                        0,    -8.5000000000000018E0},
+  {16, 1,                        0,     17.000000000000000E0,    -17.000000000000000E0,                        0},
+  {15, 6,     4736.2000000000025E0,                        0,                        0,     3913.3999999999987E0},
+  {15, 5,                        0,     1162.8000000000002E0,    -1645.6000000000008E0,                        0},
+  {15, 4,    -373.99999999999994E0,                        0,                        0,    -351.33333333333348E0},
+  {15, 3,                        0,    -45.333333333333343E0,     90.666666666666686E0,                        0},
+  {15, 2,    -136.00000000000000E0,                        0,                        0,    -136.00000000000000E0},
+  {14, 7,                        0,     8385.8571428571413E0,    -10377.285714285719E0,                        0},
+  {14, 6,    -4114.0000000000027E0,                        0,                        0,    -3603.9999999999995E0},
+  {14, 5,                        0,    -1054.0000000000005E0,     1529.9999999999995E0,                        0},
+  {14, 4,     340.00000000000006E0,                        0,                        0,     340.00000000000000E0},
+  {14, 3,                        0,    -679.99999999999989E0,     680.00000000000000E0,                        0},
+  {13, 8,    -18160.250000000007E0,                        0,                        0,    -14768.749999999993E0},
+  {13, 7,                        0,    -7207.9999999999991E0,     9044.0000000000036E0,                        0},
+  {13, 6,     3569.9999999999991E0,                        0,                        0,     3332.0000000000009E0},
+  {13, 5,                        0,     952.00000000000000E0,    -1428.0000000000000E0,                        0},
+  {13, 4,     2380.0000000000000E0,                        0,                        0,     2380.0000000000000E0},
+  {12, 9,                        0,    -21332.638888888880E0,     24893.194444444456E0,                        0},
+  {12, 8,     14696.500000000005E0,                        0,                        0,     12707.500000000000E0},
+  {12, 7,                        0,     6188.0000000000018E0,    -7955.9999999999973E0,                        0},
+  {12, 6,    -3094.0000000000000E0,                        0,                        0,    -3094.0000000000000E0},
+  {12, 5,                        0,     6188.0000000000000E0,    -6188.0000000000000E0,                        0},
+  {11,10,     29871.833333333350E0,                        0,                        0,     23904.833333333328E0},
+  {11, 9,                        0,     16943.333333333332E0,    -19890.000000000007E0,                        0},
+  {11, 8,    -11933.999999999996E0,                        0,                        0,    -11050.000000000002E0},
+  {11, 7,                        0,    -5304.0000000000000E0,     7072.0000000000000E0,                        0},
+  {11, 6,    -12376.000000000000E0,                        0,                        0,    -12376.000000000000E0},
+  {10,11,                        0,     23904.833333333328E0,    -27072.500000000015E0,                        0},
+  {10,10,    -21879.000000000007E0,                        0,                        0,    -18637.666666666664E0},
+  {10, 9,                        0,    -13505.555555555558E0,     16206.666666666664E0,                        0},
+  {10, 8,     9724.0000000000000E0,                        0,                        0,     9724.0000000000000E0},
+  {10, 7,                        0,    -19448.000000000000E0,     19448.000000000000E0,                        0},
+  { 9,12,    -22560.416666666679E0,                        0,                        0,    -17790.499999999989E0},
+  { 9,11,                        0,    -16943.333333333328E0,     19079.666666666679E0,                        0},
+  { 9,10,     16206.666666666664E0,                        0,                        0,     14856.111111111113E0},
+  { 9, 9,                        0,     10804.444444444443E0,    -13505.555555555557E0,                        0},
+  { 9, 8,     24310.000000000000E0,                        0,                        0,     24309.999999999996E0},
+  { 8,13,                        0,    -12316.499999999993E0,     13804.000000000007E0,                        0},
+  { 8,12,     14309.750000000007E0,                        0,                        0,     11989.249999999998E0},
+  { 8,11,                        0,     12155.000000000000E0,    -13922.999999999996E0,                        0},
+  { 8,10,    -12155.000000000000E0,                        0,                        0,    -12155.000000000000E0},
+  { 8, 9,                        0,     24309.999999999996E0,    -24310.000000000000E0,                        0},
+  { 7,14,     7888.0000000000045E0,                        0,                        0,     6153.9999999999964E0},
+  { 7,13,                        0,     7377.9999999999991E0,    -8092.0000000000036E0,                        0},
+  { 7,12,    -9281.9999999999982E0,                        0,                        0,    -8398.0000000000018E0},
+  { 7,11,                        0,    -8840.0000000000000E0,     10608.000000000000E0,                        0},
+  { 7,10,    -19448.000000000000E0,                        0,                        0,    -19448.000000000000E0},
+  { 6,15,                        0,     2871.8666666666650E0,    -3234.5333333333356E0,                        0},
+  { 6,14,    -4046.0000000000018E0,                        0,                        0,    -3331.9999999999991E0},
+  { 6,13,                        0,    -4522.0000000000009E0,     4997.9999999999991E0,                        0},
+  { 6,12,     6188.0000000000000E0,                        0,                        0,     6188.0000000000000E0},
+  { 6,11,                        0,    -12376.000000000000E0,     12376.000000000000E0,                        0},
+  { 5,16,    -1212.9500000000007E0,                        0,                        0,    -942.64999999999930E0},
+  { 5,15,                        0,    -1332.7999999999997E0,     1441.6000000000006E0,                        0},
+  { 5,14,     2141.9999999999995E0,                        0,                        0,     1904.0000000000005E0},
+  { 5,13,                        0,     2856.0000000000000E0,    -3332.0000000000000E0,                        0},
+  { 5,12,     6188.0000000000000E0,                        0,                        0,     6188.0000000000000E0},
+  { 4,17,                        0,    -277.24999999999977E0,     317.25000000000023E0,                        0},
+  { 4,16,     450.50000000000017E0,                        0,                        0,     365.49999999999994E0},
+  { 4,15,                        0,     634.66666666666686E0,    -680.00000000000000E0,                        0},
+  { 4,14,    -1190.0000000000000E0,                        0,                        0,    -1190.0000000000000E0},
+  { 4,13,                        0,     2380.0000000000000E0,    -2380.0000000000000E0,                        0},
+  { 3,18,     70.500000000000057E0,                        0,                        0,     54.999999999999957E0},
+  { 3,17,                        0,     85.999999999999986E0,    -93.000000000000028E0,                        0},
+  { 3,16,    -170.00000000000000E0,                        0,                        0,    -147.33333333333337E0},
+  { 3,15,                        0,    -317.33333333333331E0,     362.66666666666663E0,                        0},
+  { 3,14,    -680.00000000000000E0,                        0,                        0,    -679.99999999999989E0},
+  { 2,19,                        0,     8.6842105263157841E0,    -10.131578947368434E0,                        0},
+  { 2,18,    -15.500000000000004E0,                        0,                        0,    -12.499999999999996E0},
+  { 2,17,                        0,    -26.000000000000007E0,     26.999999999999993E0,                        0},
+  { 2,16,     68.000000000000000E0,                        0,                        0,     68.000000000000000E0},
+  { 2,15,                        0,    -136.00000000000000E0,     136.00000000000000E0,                        0},
+  { 1,20,    -1.0131578947368434E0,                        0,                        0,   -0.79605263157894690E0},
+  { 1,19,                        0,    -1.3157894736842102E0,     1.4473684210526332E0,                        0},
+  { 1,18,     2.9999999999999991E0,                        0,                        0,     2.5000000000000004E0},
+  { 1,17,                        0,     8.0000000000000000E0,    -9.0000000000000000E0,                        0},
+  { 1,16,     17.000000000000000E0,                        0,                        0,     17.000000000000000E0},
+  { 0,21,                        0, -3.7907268170426042E-002,  4.4799498746867221E-002,                        0},
+  { 0,20,  7.2368421052631665E-002,                        0,                        0,  5.9210526315789436E-002},
+  { 0,19,                        0,    0.13157894736842107E0,   -0.13157894736842102E0,                        0},
+  { 0,18,   -0.50000000000000000E0,                        0,                        0,   -0.50000000000000000E0},
+  { 0,17,                        0,     1.0000000000000000E0,    -1.0000000000000000E0,                        0},
+  {20, 1,                        0,                        0,    -1.0000000000000013E0,                        0},
+  {19, 2,    -10.000000000000014E0,                        0,                        0,    -9.0000000000000000E0},
+  {19, 1,                        0,                        0,     1.0000000000000000E0,                        0},
+  {18, 3,                        0,    -57.000000000000000E0,     108.16666666666674E0,                        0},
+  {18, 2,     9.5000000000000000E0,                        0,                        0,     8.9999999999999947E0},
+  {18, 1,                        0,                        0,    -1.0000000000000000E0,                        0},
+  {18, 0,     1.0000000000000000E0,                        0,                        0,     1.0000000000000000E0},
+  {17, 4,     486.75000000000034E0,                        0,                        0,     434.24999999999989E0},
+  {17, 3,                        0,     53.999999999999972E0,    -105.00000000000003E0,                        0},
+  {17, 2,    -9.0000000000000000E0,                        0,                        0,    -9.0000000000000000E0},
+  {17, 1,                        0,     18.000000000000000E0,    -18.000000000000000E0,                        0},
+  {16, 5,                        0,     1476.4499999999996E0,    -2096.1000000000008E0,                        0},
+  {16, 4,    -446.25000000000011E0,                        0,                        0,    -420.74999999999989E0},
+  {16, 3,                        0,    -51.000000000000000E0,     102.00000000000000E0,                        0},
+  {16, 2,    -153.00000000000000E0,                        0,                        0,    -153.00000000000000E0},
+  {15, 6,    -5589.6000000000022E0,                        0,                        0,    -4936.7999999999993E0},
+  {15, 5,                        0,    -1346.3999999999996E0,     1958.4000000000005E0,                        0},
+  {15, 4,     408.00000000000000E0,                        0,                        0,     408.00000000000000E0},
+  {15, 3,                        0,    -816.00000000000000E0,     816.00000000000000E0,                        0},
+  {14, 7,                        0,    -10578.857142857141E0,     13318.285714285719E0,                        0},
+  {14, 6,     4896.0000000000018E0,                        0,                        0,     4589.9999999999991E0},
+  {14, 5,                        0,     1224.0000000000000E0,    -1836.0000000000000E0,                        0},
+  {14, 4,     3060.0000000000000E0,                        0,                        0,     3060.0000000000000E0},
+  {13, 8,     23307.000000000007E0,                        0,                        0,     20348.999999999996E0},
+  {13, 7,                        0,     9179.9999999999982E0,    -11832.000000000002E0,                        0},
+  {13, 6,    -4284.0000000000000E0,                        0,                        0,    -4284.0000000000000E0},
+  {13, 5,                        0,     8568.0000000000000E0,    -8568.0000000000000E0,                        0},
+  {12, 9,                        0,     29392.999999999993E0,    -34623.333333333343E0,                        0},
+  {12, 8,    -19227.000000000004E0,                        0,                        0,    -17900.999999999996E0},
+  {12, 7,                        0,    -7956.0000000000000E0,     10608.000000000000E0,                        0},
+  {12, 6,    -18564.000000000000E0,                        0,                        0,    -18564.000000000000E0},
+  {11,10,    -41548.000000000015E0,                        0,                        0,    -35802.000000000000E0},
+  {11, 9,                        0,    -23867.999999999993E0,     28730.000000000004E0,                        0},
+  {11, 8,     15912.000000000000E0,                        0,                        0,     15912.000000000000E0},
+  {11, 7,                        0,    -31824.000000000000E0,     31824.000000000000E0,                        0},
+  {10,11,                        0,    -35802.000000000000E0,     40443.000000000015E0,                        0},
+  {10,10,     31603.000000000004E0,                        0,                        0,     29171.999999999996E0},
+  {10, 9,                        0,     19448.000000000000E0,    -24310.000000000000E0,                        0},
+  {10, 8,     43758.000000000000E0,                        0,                        0,     43758.000000000000E0},
+  { 9,12,     33702.500000000007E0,                        0,                        0,     28619.499999999993E0},
+  { 9,11,                        0,     26519.999999999996E0,    -30498.000000000000E0,                        0},
+  { 9,10,    -24310.000000000000E0,                        0,                        0,    -24310.000000000000E0},
+  { 9, 9,                        0,     48620.000000000000E0,    -48620.000000000000E0,                        0},
+  { 8,13,                        0,     19813.499999999996E0,    -21777.000000000011E0,                        0},
+  { 8,12,    -22873.500000000000E0,                        0,                        0,    -20884.499999999996E0},
+  { 8,11,                        0,    -19890.000000000000E0,     23868.000000000000E0,                        0},
+  { 8,10,    -43758.000000000000E0,                        0,                        0,    -43758.000000000000E0},
+  { 7,14,    -12444.000000000005E0,                        0,                        0,    -10403.999999999998E0},
+  { 7,13,                        0,    -12851.999999999998E0,     14280.000000000002E0,                        0},
+  { 7,12,     15912.000000000000E0,                        0,                        0,     15912.000000000000E0},
+  { 7,11,                        0,    -31824.000000000000E0,     31824.000000000000E0,                        0},
+  { 6,15,                        0,    -4855.1999999999989E0,     5249.6000000000022E0,                        0},
+  { 6,14,     7140.0000000000009E0,                        0,                        0,     6426.0000000000000E0},
+  { 6,13,                        0,     8568.0000000000000E0,    -9996.0000000000000E0,                        0},
+  { 6,12,     18564.000000000000E0,                        0,                        0,     18564.000000000000E0},
+  { 5,16,     1968.6000000000008E0,                        0,                        0,     1621.8000000000000E0},
+  { 5,15,                        0,     2570.3999999999996E0,    -2774.4000000000005E0,                        0},
+  { 5,14,    -4284.0000000000000E0,                        0,                        0,    -4284.0000000000000E0},
+  { 5,13,                        0,     8568.0000000000000E0,    -8568.0000000000000E0,                        0},
+  { 4,17,                        0,     476.99999999999994E0,    -513.00000000000023E0,                        0},
+  { 4,16,    -867.00000000000023E0,                        0,                        0,    -764.99999999999989E0},
+  { 4,15,                        0,    -1428.0000000000000E0,     1632.0000000000000E0,                        0},
+  { 4,14,    -3060.0000000000000E0,                        0,                        0,    -3060.0000000000000E0},
+  { 3,18,    -114.00000000000006E0,                        0,                        0,    -92.999999999999972E0},
+  { 3,17,                        0,    -179.99999999999997E0,     189.00000000000000E0,                        0},
+  { 3,16,     408.00000000000000E0,                        0,                        0,     408.00000000000000E0},
+  { 3,15,                        0,    -816.00000000000000E0,     816.00000000000000E0,                        0},
+  { 2,19,                        0,    -14.684210526315786E0,     15.921052631578958E0,                        0},
+  { 2,18,     31.500000000000000E0,                        0,                        0,     27.000000000000000E0},
+  { 2,17,                        0,     72.000000000000000E0,    -81.000000000000000E0,                        0},
+  { 2,16,     153.00000000000000E0,                        0,                        0,     153.00000000000000E0},
+  { 1,20,     1.5921052631578958E0,                        0,                        0,     1.3026315789473677E0},
+  { 1,19,                        0,     2.8421052631578947E0,    -2.8947368421052637E0,                        0},
+  { 1,18,    -9.0000000000000000E0,                        0,                        0,    -9.0000000000000000E0},
+  { 1,17,                        0,     18.000000000000000E0,    -18.000000000000000E0,                        0},
+  { 0,21,                        0,  6.2030075187969894E-002, -6.8922305764411121E-002,                        0},
+  { 0,20,   -0.14473684210526319E0,                        0,                        0,   -0.11842105263157894E0},
+  { 0,19,                        0,   -0.47368421052631576E0,    0.52631578947368418E0,                        0},
+  { 0,18,    -1.0000000000000000E0,                        0,                        0,    -1.0000000000000000E0},
+  {20, 1,                        0,                        0,     1.0000000000000009E0,                        0},
+  {19, 2,     10.000000000000009E0,                        0,                        0,     9.4999999999999982E0},
+  {19, 1,                        0,                        0,   -0.99999999999999911E0,                        0},
+  {19, 0,     1.0000000000000000E0,                        0,                        0,     1.0000000000000000E0},
+  {18, 3,                        0,     60.166666666666657E0,    -117.16666666666674E0,                        0},
+  {18, 2,    -9.4999999999999911E0,                        0,                        0,    -9.4999999999999982E0},
+  {18, 1,                        0,     19.000000000000000E0,    -19.000000000000000E0,                        0},
+  {17, 4,    -527.25000000000034E0,                        0,                        0,    -498.74999999999994E0},
+  {17, 3,                        0,    -56.999999999999986E0,     114.00000000000000E0,                        0},
+  {17, 2,    -171.00000000000000E0,                        0,                        0,    -171.00000000000000E0},
+  {16, 5,                        0,    -1695.7499999999998E0,     2470.9500000000007E0,                        0},
+  {16, 4,     484.50000000000000E0,                        0,                        0,     484.50000000000000E0},
+  {16, 3,                        0,    -969.00000000000000E0,     969.00000000000000E0,                        0},
+  {15, 6,     6589.2000000000025E0,                        0,                        0,     6201.5999999999995E0},
+  {15, 5,                        0,     1550.4000000000001E0,    -2325.6000000000004E0,                        0},
+  {15, 4,     3876.0000000000000E0,                        0,                        0,     3876.0000000000000E0},
+  {14, 7,                        0,     13289.142857142855E0,    -17165.142857142866E0,                        0},
+  {14, 6,    -5814.0000000000009E0,                        0,                        0,    -5814.0000000000009E0},
+  {14, 5,                        0,     11628.000000000000E0,    -11628.000000000000E0,                        0},
+  {13, 8,    -30039.000000000015E0,                        0,                        0,    -28100.999999999996E0},
+  {13, 7,                        0,    -11628.000000000002E0,     15504.000000000000E0,                        0},
+  {13, 6,    -27132.000000000000E0,                        0,                        0,    -27132.000000000000E0},
+  {12, 9,                        0,    -40590.333333333328E0,     48988.333333333350E0,                        0},
+  {12, 8,     25194.000000000000E0,                        0,                        0,     25194.000000000000E0},
+  {12, 7,                        0,    -50388.000000000000E0,     50388.000000000000E0,                        0},
+  {11,10,     58786.000000000015E0,                        0,                        0,     54587.000000000007E0},
+  {11, 9,                        0,     33592.000000000000E0,    -41990.000000000000E0,                        0},
+  {11, 8,     75582.000000000000E0,                        0,                        0,     75582.000000000000E0},
+  {10,11,                        0,     54587.000000000007E0,    -62985.000000000015E0,                        0},
+  {10,10,    -46189.000000000000E0,                        0,                        0,    -46189.000000000000E0},
+  {10, 9,                        0,     92378.000000000000E0,    -92378.000000000015E0,                        0},
+  { 9,12,    -52487.500000000007E0,                        0,                        0,    -48288.500000000000E0},
+  { 9,11,                        0,    -41990.000000000000E0,     50388.000000000000E0,                        0},
+  { 9,10,    -92378.000000000015E0,                        0,                        0,    -92378.000000000000E0},
+  { 8,13,                        0,    -33430.500000000000E0,     37306.500000000007E0,                        0},
+  { 8,12,     37791.000000000000E0,                        0,                        0,     37791.000000000000E0},
+  { 8,11,                        0,    -75582.000000000000E0,     75582.000000000000E0,                        0},
+  { 7,14,     21318.000000000004E0,                        0,                        0,     19380.000000000000E0},
+  { 7,13,                        0,     23256.000000000000E0,    -27132.000000000000E0,                        0},
+  { 7,12,     50388.000000000000E0,                        0,                        0,     50388.000000000000E0},
+  { 6,15,                        0,     9044.0000000000000E0,    -9819.2000000000025E0,                        0},
+  { 6,14,    -13566.000000000000E0,                        0,                        0,    -13566.000000000002E0},
+  { 6,13,                        0,     27132.000000000000E0,    -27132.000000000000E0,                        0},
+  { 5,16,    -3682.2000000000007E0,                        0,                        0,    -3294.6000000000004E0},
+  { 5,15,                        0,    -5426.4000000000005E0,     6201.6000000000004E0,                        0},
+  { 5,14,    -11628.000000000000E0,                        0,                        0,    -11628.000000000000E0},
+  { 4,17,                        0,    -969.00000000000000E0,     1026.0000000000002E0,                        0},
+  { 4,16,     1938.0000000000000E0,                        0,                        0,     1938.0000000000000E0},
+  { 4,15,                        0,    -3876.0000000000000E0,     3876.0000000000000E0,                        0},
+  { 3,18,     228.00000000000006E0,                        0,                        0,     199.49999999999997E0},
+  { 3,17,                        0,     456.00000000000000E0,    -513.00000000000000E0,                        0},
+  { 3,16,     969.00000000000000E0,                        0,                        0,     969.00000000000000E0},
+  { 2,19,                        0,     31.499999999999993E0,    -32.500000000000000E0,                        0},
+  { 2,18,    -85.500000000000000E0,                        0,                        0,    -85.500000000000000E0},
+  { 2,17,                        0,     171.00000000000000E0,    -171.00000000000000E0,                        0},
+  { 1,20,    -3.2500000000000000E0,                        0,                        0,    -2.7499999999999996E0},
+  { 1,19,                        0,    -9.0000000000000000E0,     10.000000000000000E0,                        0},
+  { 1,18,    -19.000000000000000E0,                        0,                        0,    -19.000000000000000E0},
+  { 0,21,                        0,   -0.13095238095238093E0,    0.13095238095238101E0,                        0},
+  { 0,20,    0.50000000000000000E0,                        0,                        0,    0.50000000000000000E0},
+  { 0,19,                        0,    -1.0000000000000000E0,     1.0000000000000000E0,                        0},
+  {20, 1,                        0,                        0,   -0.99999999999999911E0,                        0},
+  {20, 0,     1.0000000000000000E0,                        0,                        0,     1.0000000000000000E0},
+  {19, 2,    -9.9999999999999911E0,                        0,                        0,    -9.9999999999999964E0},
+  {19, 1,                        0,     20.000000000000000E0,    -20.000000000000000E0,                        0},
+  {18, 3,                        0,    -63.333333333333314E0,     126.66666666666660E0,                        0},
+  {18, 2,    -190.00000000000000E0,                        0,                        0,    -190.00000000000000E0},
+  {17, 4,     569.99999999999966E0,                        0,                        0,     570.00000000000000E0},
+  {17, 3,                        0,    -1140.0000000000000E0,     1140.0000000000000E0,                        0},
+  {16, 5,                        0,     1938.0000000000000E0,    -2906.9999999999991E0,                        0},
+  {16, 4,     4845.0000000000000E0,                        0,                        0,     4845.0000000000000E0},
+  {15, 6,    -7751.9999999999982E0,                        0,                        0,    -7751.9999999999991E0},
+  {15, 5,                        0,     15504.000000000000E0,    -15504.000000000000E0,                        0},
+  {14, 7,                        0,    -16611.428571428569E0,     22148.571428571428E0,                        0},
+  {14, 6,    -38760.000000000000E0,                        0,                        0,    -38760.000000000000E0},
+  {13, 8,     38760.000000000000E0,                        0,                        0,     38759.999999999993E0},
+  {13, 7,                        0,    -77520.000000000000E0,     77520.000000000000E0,                        0},
+  {12, 9,                        0,     55986.666666666657E0,    -69983.333333333314E0,                        0},
+  {12, 8,     125970.00000000000E0,                        0,                        0,     125970.00000000000E0},
+  {11,10,    -83979.999999999985E0,                        0,                        0,    -83980.000000000000E0},
+  {11, 9,                        0,     167960.00000000000E0,    -167960.00000000000E0,                        0},
+  {10,11,                        0,    -83980.000000000000E0,     100775.99999999997E0,                        0},
+  {10,10,    -184756.00000000000E0,                        0,                        0,    -184756.00000000000E0},
+  { 9,12,     83979.999999999985E0,                        0,                        0,     83980.000000000000E0},
+  { 9,11,                        0,    -167960.00000000000E0,     167960.00000000000E0,                        0},
+  { 8,13,                        0,     58140.000000000000E0,    -67829.999999999985E0,                        0},
+  { 8,12,     125970.00000000000E0,                        0,                        0,     125970.00000000000E0},
+  { 7,14,    -38759.999999999993E0,                        0,                        0,    -38760.000000000000E0},
+  { 7,13,                        0,     77520.000000000000E0,    -77520.000000000000E0,                        0},
+  { 6,15,                        0,    -18088.000000000000E0,     20672.000000000000E0,                        0},
+  { 6,14,    -38760.000000000000E0,                        0,                        0,    -38760.000000000000E0},
+  { 5,16,     7752.0000000000000E0,                        0,                        0,     7752.0000000000000E0},
+  { 5,15,                        0,    -15504.000000000000E0,     15504.000000000000E0,                        0},
+  { 4,17,                        0,     2280.0000000000000E0,    -2564.9999999999995E0,                        0},
+  { 4,16,     4845.0000000000000E0,                        0,                        0,     4845.0000000000000E0},
+  { 3,18,    -569.99999999999989E0,                        0,                        0,    -569.99999999999989E0},
+  { 3,17,                        0,     1140.0000000000000E0,    -1140.0000000000000E0,                        0},
+  { 2,19,                        0,    -89.999999999999986E0,     100.00000000000000E0,                        0},
+  { 2,18,    -190.00000000000000E0,                        0,                        0,    -190.00000000000000E0},
+  { 1,20,     10.000000000000000E0,                        0,                        0,     10.000000000000000E0},
+  { 1,19,                        0,    -20.000000000000000E0,     20.000000000000000E0,                        0},
+  { 0,21,                        0,    0.47619047619047616E0,   -0.52380952380952372E0,                        0},
+  { 0,20,     1.0000000000000000E0,                        0,                        0,     1.0000000000000000E0},
+  {21, 0,     1.0000000000000000E0,                        0,                        0,     1.0000000000000000E0},
+  {20, 1,                        0,     21.000000000000000E0,    -21.000000000000000E0,                        0},
+  {19, 2,    -210.00000000000000E0,                        0,                        0,    -210.00000000000000E0},
+  {18, 3,                        0,    -1330.0000000000000E0,     1330.0000000000000E0,                        0},
+  {17, 4,     5985.0000000000000E0,                        0,                        0,     5985.0000000000000E0},
+  {16, 5,                        0,     20349.000000000000E0,    -20349.000000000000E0,                        0},
+  {15, 6,    -54264.000000000000E0,                        0,                        0,    -54264.000000000000E0},
+  {14, 7,                        0,    -116280.00000000000E0,     116280.00000000000E0,                        0},
+  {13, 8,     203490.00000000000E0,                        0,                        0,     203490.00000000000E0},
+  {12, 9,                        0,     293930.00000000000E0,    -293930.00000000000E0,                        0},
+  {11,10,    -352716.00000000000E0,                        0,                        0,    -352716.00000000000E0},
+  {10,11,                        0,    -352716.00000000000E0,     352716.00000000000E0,                        0},
+  { 9,12,     293930.00000000000E0,                        0,                        0,     293930.00000000000E0},
+  { 8,13,                        0,     203490.00000000000E0,    -203490.00000000000E0,                        0},
+  { 7,14,    -116280.00000000000E0,                        0,                        0,    -116280.00000000000E0},
+  { 6,15,                        0,    -54264.000000000000E0,     54264.000000000000E0,                        0},
+  { 5,16,     20349.000000000000E0,                        0,                        0,     20349.000000000000E0},
+  { 4,17,                        0,     5985.0000000000000E0,    -5985.0000000000000E0,                        0},
+  { 3,18,    -1330.0000000000000E0,                        0,                        0,    -1330.0000000000000E0},
+  { 2,19,                        0,    -210.00000000000000E0,     210.00000000000000E0,                        0},
+  { 1,20,     21.000000000000000E0,                        0,                        0,     21.000000000000000E0},
+  { 0,21,                        0,     1.0000000000000000E0,    -1.0000000000000000E0,                        0}
+};
+
+// --- implementation ---------------------------------------------------------o
+
+static inline int
+get_nc (int no, int ic)
+{
+  int n = no+1-ic;
+  return n*(n+1)/2;
+}
+
+void
+mad_curvmul_bfxy (int nmul, const num_t knl[], const num_t ksl[], num_t eh,
+                  int snm, num_t bfx[], num_t bfy[])
+{
+  const int nc = get_nc(snm,0);
+  for (int k=0; k < nc; k++) bfx[k] = 0, bfy[k] = 0;
+
+  for (int n=1; n <= nmul; n++) {
+    const num_t kn = knl[n-1], ks = ksl[n-1];
+    if (fabs(kn) + fabs(ks) == 0) continue;
+
+    for (int c=mad_curvmul_cidx[n-1]; c < mad_curvmul_cidx[n]; c++) {
+      const curvmul_t *e = &mad_curvmul_coef[c];
+      const int k = e->i + e->j;
+      if (n-1 <= k && k < snm) {
+        const num_t ehn = pow(eh, k+1-n);
+        const int   idx = get_nc(snm, e->i) - e->j - 1;
+        bfx[idx] += (ks*e->ax + kn*e->bx) * ehn;
+        bfy[idx] += (ks*e->ay + kn*e->by) * ehn;
+      }
+    }
+  }
+}
+
+// --- end --------------------------------------------------------------------o
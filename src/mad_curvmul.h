@@ -0,0 +1,53 @@
+#ifndef MAD_CURVMUL_H
+#define MAD_CURVMUL_H
+
+/*
+ o-----------------------------------------------------------------------------o
+ |
+ | Curved multipoles module interface
+ |
+ | Methodical Accelerator Design - Copyright (c) 2016+
+ | Support: http://cern.ch/mad  - mad at cern.ch
+ | Authors: L. Deniau, laurent.deniau at cern.ch
+ | Contrib: J. Gray, joshua.gray at cern.ch
+ |
+ o-----------------------------------------------------------------------------o
+ | You can redistribute this file and/or modify it under the terms of the GNU
+ | General Public License GPLv3 (or later), as published by the Free Software
+ | Foundation. This file is distributed in the hope that it will be useful, but
+ | WITHOUT ANY WARRANTY OF ANY KIND. See http://gnu.org/licenses for details.
+ o-----------------------------------------------------------------------------o
+
+  Purpose:
+  - Provide the coefficients and the function to compute the expansion of the
+    curved multipoles fields (i.e. bfx, bfy for bxbyh in mad_dynmap.cpp).
+
+  Information:
+  - knl, ksl are the multipoles strengths divided by (n-1)!, eh = edir*h and
+    snm is the order of the expansion, bfx and bfy must hold at least
+    (snm+1)*(snm+2)/2 coefficients.
+
+ o-----------------------------------------------------------------------------o
+ */
+
+#include "mad_def.h"
+
+// --- types ------------------------------------------------------------------o
+
+typedef struct curvmul_ {   // coefficients of x^i y^j
+  int   i, j;
+  num_t ax, bx, ay, by;
+} curvmul_t;
+
+// --- interface --------------------------------------------------------------o
+
+void mad_curvmul_bfxy (int nmul, const num_t knl[], const num_t ksl[], num_t eh,
+                       int snm, num_t bfx[], num_t bfy[]);
+
+// non-zero coefficients of multipole n are in coef[cidx[n-1]..cidx[n]-1]
+extern const int       mad_curvmul_cidx[];
+extern const curvmul_t mad_curvmul_coef[];
+
+// ----------------------------------------------------------------------------o
+
+#endif // MAD_CURVMUL_H
@@ -0,0 +1,152 @@
+/*
+ o-----------------------------------------------------------------------------o
+ |
+ | Beam distributions module implementation
+ |
+ | Methodical Accelerator Design - Copyright (c) 2016+
+ | Support: http://cern.ch/mad  - mad at cern.ch
+ | Authors: L. Deniau, laurent.deniau at cern.ch
+ | Contrib: -
+ |
+ o-----------------------------------------------------------------------------o
+ | You can redistribute this file and/or modify it under the terms of the GNU
+ | General Public License GPLv3 (or later), as published by the Free Software
+ | Foundation. This file is distributed in the hope that it will be useful, but
+ | WITHOUT ANY WARRANTY OF ANY KIND. See http://gnu.org/licenses for details.
+ o-----------------------------------------------------------------------------o
+*/
+
+#include <math.h>
+#include <assert.h>
+
+#include "mad_cst.h"
+#include "mad_log.h"
+#include "mad_mem.h"
+#include "mad_dist.h"
+
+// --- implementation ---------------------------------------------------------o
+
+enum { dist_blk = 1 << 14 }; // particles per random stream
+
+static inline void // pair of N(0,1) (Marsaglia's polar form)
+dist_randn2 (prng_state_t *rng, num_t *z1, num_t *z2)
+{
+  num_t x1, x2, w;
+  do {
+    x1 = 2*mad_num_rand(rng) - 1;
+    x2 = 2*mad_num_rand(rng) - 1;
+    w  = x1*x1 + x2*x2;
+  } while (w >= 1 || w == 0);
+  w = sqrt(-2*log(w)/w);
+  *z1 = x1*w, *z2 = x2*w;
+}
+
+static inline void // uniform direction on the unit d-sphere
+dist_sphere (prng_state_t *rng, num_t z[], int d)
+{
+  num_t s = 0;
+  for (int k=0; k < d; k += 2) {
+    dist_randn2(rng, z+k, z+k+1);
+    s += z[k]*z[k] + z[k+1]*z[k+1];
+  }
+  s = 1/sqrt(s);
+  for (int k=0; k < d; k++) z[k] *= s;
+}
+
+static inline void
+dist_draw (prng_state_t *rng, int kind, int np, num_t cut, num_t r1, num_t r2,
+           num_t z[6])
+{
+  int d = 2*np;
+
+  switch (kind) {
+  case dist_gauss:
+    for (int k=0; k < d; k += 2)
+      do dist_randn2(rng, z+k, z+k+1);
+      while (cut > 0 && z[k]*z[k] + z[k+1]*z[k+1] > cut*cut);
+    return;
+
+  case dist_waterbag:
+    dist_sphere(rng, z, d);
+    r1 = sqrt(d+2.0) * pow(mad_num_rand(rng), 1.0/d);
+    break;
+
+  case dist_kv:
+    dist_sphere(rng, z, d);
+    r1 = sqrt(d);
+    break;
+
+  case dist_hollow: {
+    dist_sphere(rng, z, d);
+    num_t a = pow(r1, d), b = pow(r2, d);
+    r1 = pow(a + (b-a)*mad_num_rand(rng), 1.0/d);
+  } break;
+
+  case dist_shell:
+    dist_sphere(rng, z, d);
+    break;
+
+  default:
+    error("invalid distribution kind %d", kind);
+  }
+
+  for (int k=0; k < d; k++) z[k] *= r1;
+}
+
+static inline void
+dist_lattice (ssz_t i, ssz_t n, int np, num_t r1, num_t z[6])
+{
+  ssz_t m = ceil(pow(n, 1.0/np) - 1e-9);
+  for (int p=0; p < np; p++, i /= m) {
+    z[2*p  ] = m > 1 ? r1*(2.0*(i % m)/(m-1) - 1) : 0;
+    z[2*p+1] = 0;
+  }
+}
+
+void
+mad_dist_gen (prng_state_t *rng, int kind, int np, const num_t A[6*6],
+              const num_t X0[6], const num_t E[3], num_t cut, num_t r1,
+              num_t r2, num_t X[], ssz_t n)
+{
+  assert(rng && A && X0 && E && X);
+  ensure(np == 2 || np == 3, "invalid number of planes %d (2 or 3 expected)", np);
+  ensure(kind >= dist_gauss && kind <= dist_grid, "invalid distribution kind %d", kind);
+
+  // scaled matrix A*E^1/2 (columns of planes)
+  num_t B[6*6];
+  for (int i=0; i < 6; i++)
+  for (int j=0; j < 6; j++)
+    B[i*6+j] = j/2 < np ? A[i*6+j]*sqrt(E[j/2]) : 0;
+
+  // one random stream per block (independent of the number of threads)
+  ssz_t nb = (n+dist_blk-1)/dist_blk;
+  mad_alloc_tmp(prng_state_t, rs, nb);
+  for (idx_t b=0; b < nb; b++) {
+    mad_num_randjump(rng);
+    rs[b] = *rng;
+  }
+  mad_num_randjump(rng);
+
+#ifdef _OPENMP
+  #pragma omp parallel for schedule(static) if (nb > 1)
+#endif
+  for (idx_t b=0; b < nb; b++) {
+    prng_state_t st = rs[b];
+    ssz_t i1 = b*dist_blk+dist_blk < n ? b*dist_blk+dist_blk : n;
+    for (idx_t i=b*dist_blk; i < i1; i++) {
+      num_t z[6] = {0};
+      if (kind == dist_grid) dist_lattice(i, n, np, r1, z);
+      else dist_draw(&st, kind, np, cut, r1, r2, z);
+
+      for (int k=0; k < 6; k++) {
+        num_t x = X0[k];
+        for (int j=0; j < 2*np; j++) x += B[k*6+j]*z[j];
+        X[k*n+i] = x;
+      }
+    }
+  }
+
+  mad_free_tmp(rs);
+}
+
+// --- end --------------------------------------------------------------------o
@@ -0,0 +1,58 @@
+#ifndef MAD_DIST_H
+#define MAD_DIST_H
+
+/*
+ o-----------------------------------------------------------------------------o
+ |
+ | Beam distributions module interface
+ |
+ | Methodical Accelerator Design - Copyright (c) 2016+
+ | Support: http://cern.ch/mad  - mad at cern.ch
+ | Authors: L. Deniau, laurent.deniau at cern.ch
+ | Contrib: -
+ |
+ o-----------------------------------------------------------------------------o
+ | You can redistribute this file and/or modify it under the terms of the GNU
+ | General Public License GPLv3 (or later), as published by the Free Software
+ | Foundation. This file is distributed in the hope that it will be useful, but
+ | WITHOUT ANY WARRANTY OF ANY KIND. See http://gnu.org/licenses for details.
+ o-----------------------------------------------------------------------------o
+
+  Purpose:
+  - Provide the generation of matched beam distributions of n particles in
+    the SoA buffer X[6 x n] (i.e. X[k*n+i] is the coordinate k of particle i)
+    from the normalized coordinates z[2*np] of np planes (2 or 3), such that
+    X = X0 + A*E^1/2*z, where A [6x6] is the normalizing matrix (e.g. from
+    bet2map or normal1, with dispersion and coupling) and E the emittances.
+
+  Information:
+  - the normalized coordinates z follow one of (radii r1, r2 in sigma):
+    - gauss   : normal N(0,1), truncated at cut sigma per plane (cut > 0).
+    - waterbag: uniform in the 2np-ball of radius sqrt(2np+2).
+    - kv      : uniform on the 2np-sphere of radius sqrt(2np).
+    - hollow  : uniform in the 2np-shell between radii r1 and r2.
+    - shell   : uniform on the 2np-sphere of radius r1.
+    - grid    : regular grid of m^np points in [-r1,r1] of the position of
+                each plane (momenta are zero), m = ceil(n^(1/np)).
+  - random draws use xoshiro256** streams separated by mad_num_randjump for
+    each block of particles, hence the results do not depend on the number
+    of threads, and rng is jumped after the last block.
+
+ o-----------------------------------------------------------------------------o
+ */
+
+#include "mad_num.h"
+
+// --- types ------------------------------------------------------------------o
+
+enum { dist_gauss, dist_waterbag, dist_kv, dist_hollow, dist_shell, dist_grid };
+
+// --- interface --------------------------------------------------------------o
+
+void mad_dist_gen (prng_state_t *rng, int kind, int np, const num_t A[6*6],
+                   const num_t X0[6], const num_t E[3], num_t cut, num_t r1,
+                   num_t r2, num_t X[], ssz_t n);
+
+// ----------------------------------------------------------------------------o
+
+#endif // MAD_DIST_H
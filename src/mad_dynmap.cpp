@@ -23,14 +23,22 @@
 
 // --- includes ---------------------------------------------------------------o
 
+#include <cstddef>
+#include <cstring>
+#include <algorithm>
 #include <type_traits>
+#include <complex>
+#include <vector>
 #include "mad_tpsa.hpp"
+#include "mad_jet.hpp"
 
 extern "C" {
 #include "mad_log.h"
 #include "mad_cst.h"
 #include "mad_mem.h"
+#include "mad_vec.h"
 #include "mad_mat.h"
+#include "mad_rad.h"
 #include "mad_dynmap.h"
 }
 
@@ -52,6 +60,11 @@ struct cflw { // must be identical to def of 3 variants in madl_etck.mad!!
   // directions, path
   int sdir, edir, pdir, T, Tbak;
 
+  // fringes coefficients (see frng_coef), cleared once per element
+  int   fcok;
+  num_t fcb0, fcca, fcsa, fcf1, fcf2;
+  num_t fckn[nmul_max], fcks[nmul_max];
+
 // start of polymorphic section
 
   // element data
@@ -81,6 +94,12 @@ struct cflw { // must be identical to def of 3 variants in madl_etck.mad!!
   MP  bfx[snm_max];
   MP  bfy[snm_max];
 
+  // beam-beam (strong beam), space-charge (frozen beam)
+  int   bbns;
+  bool  bbko;
+  num_t bbq, bbb, bbtol, bbsz, bbphi, bbalp;
+  MP    bbx, bby, bbsx, bbsy, bbdpx, bbdpy;
+
   // particles/damaps/parametric_damaps (must be last!!)
   int npar;
   MT **par;
@@ -137,6 +156,44 @@ struct prm_t { // parametric damaps
   mad::tpsa_ref x, px, y, py, t, pt;
 };
 
+template <int N>
+struct map_t1 { // dense damaps of order 1 with nv <= N (see dense_map)
+  // traits
+  using T  = mad::jet<N>;   // type of variables  in maps (num_t  or tpsa)
+  using P  = num_t;         // type of parameters in maps (num_t  or tpsa)
+  using R  = num_t&;        // type of prms refs  in maps (num_t  or tpsa_ref)
+  using A  = num_t*;        // type of prms array in maps (num_t& or tpsa_refs)
+  using MT = mad::jet<N>;   // type of variables  in mflw (num_t  or tpsa_t*)
+  using MP = num_t;         // type of parameters in mflw (num_t  or tpsa_t*)
+  static constexpr int nv = N; // max number of variables
+  // ctor
+  map_t1(struct cflw<map_t1> &m, int i)
+    : x(m.par[i][0]), px(m.par[i][1]),
+      y(m.par[i][2]), py(m.par[i][3]),
+      t(m.par[i][4]), pt(m.par[i][5]) {}
+  // members
+  mad::jet<N> &x, &px, &y, &py, &t, &pt;
+};
+
+template <int N>
+struct map_t2 { // dense damaps of order 2 with nv <= N (see dense_map)
+  // traits
+  using T  = mad::jet2<N>;  // type of variables  in maps (num_t  or tpsa)
+  using P  = num_t;         // type of parameters in maps (num_t  or tpsa)
+  using R  = num_t&;        // type of prms refs  in maps (num_t  or tpsa_ref)
+  using A  = num_t*;        // type of prms array in maps (num_t& or tpsa_refs)
+  using MT = mad::jet2<N>;  // type of variables  in mflw (num_t  or tpsa_t*)
+  using MP = num_t;         // type of parameters in mflw (num_t  or tpsa_t*)
+  static constexpr int nv = N; // max number of variables
+  // ctor
+  map_t2(struct cflw<map_t2> &m, int i)
+    : x(m.par[i][0]), px(m.par[i][1]),
+      y(m.par[i][2]), py(m.par[i][3]),
+      t(m.par[i][4]), pt(m.par[i][5]) {}
+  // members
+  mad::jet2<N> &x, &px, &y, &py, &t, &pt;
+};
+
 extern "C" {
 union cflw_x {
   struct cflw<par_t> rflw;
@@ -162,7 +219,7 @@ using namespace mad;
 #define mdump(n)
 #endif
 
-template <typename M, typename T=M::T>
+template <typename M>
 inline void (mdump) (cflw<M> &m, str_t s, int n)
 {
   if (!m.dbg) return;
@@ -173,13 +230,9 @@ inline void (mdump) (cflw<M> &m, str_t s, int n)
 
   if (!m.npar) { printf("no particle found\n"); return; }
 
-  M p(m,0);
-  if constexpr (std::is_floating_point<T>::value)
-    printf("% -.16e  % -.16e  % -.16e  % -.16e  % -.16e  % -.16e\n",
-                p.x,    p.px,     p.y,    p.py,     p.t,    p.pt);
-  else
-    printf("% -.16e  % -.16e  % -.16e  % -.16e  % -.16e  % -.16e\n",
-             p.x[0], p.px[0],  p.y[0], p.py[0],  p.t[0], p.pt[0]);
+  M p(m,0); // fval: scalar part of particles, tpsa and jets
+  printf("% -.16e  % -.16e  % -.16e  % -.16e  % -.16e  % -.16e\n",
+         fval(p.x), fval(p.px), fval(p.y), fval(p.py), fval(p.t), fval(p.pt));
 }
 
 // --- constants --------------------------------------------------------------o
@@ -195,52 +248,93 @@ const num_t twopi_clight = mad_cst_2PI/mad_cst_CLIGHT;
 
 // --- multipoles -------------------------------------------------------------o
 
-template <typename M, typename T=M::T, typename V, typename R=M::R>
-inline void bxby (const cflw<M> &m, const V &x, const V &y, T &bx, T &by)
+// zero coefficient? (parametric coefficients must be fully zero)
+inline bool isnul (num_t a) { return a == 0; }
+inline bool isnul (const tpsa_t *a) { return mad_tpsa_isnul(a); }
+
+// r += c, skip zero coefficients for damaps (i.e. save tpsa ops)
+template <typename M, typename T, typename R=M::R, typename MP>
+inline void addcoef (T &r, const MP &c)
 {
-  bx = R(m.ksl[m.nmul-1]);
-  by = R(m.knl[m.nmul-1]);
+  if constexpr (std::is_floating_point<T>::value) r += c;
+  else if (!isnul(c)) r += R(c);
+}
+
+// N > 0 specializes the Horner scheme for nmul=N (unrolled), N=0 is generic
+template <int N, typename M, typename T, typename V, typename R=M::R>
+inline void bxbyn (const cflw<M> &m, const V &x, const V &y, T &bx, T &by)
+{
+  const int n = N ? N : m.nmul;
 
-  if (m.nmul > 1) {
+  bx = R(m.ksl[n-1]);
+  by = R(m.knl[n-1]);
+
+  if (n > 1) {
     T byt(by);
-    RFOR(i,m.nmul-1) {
-      byt = by*x - bx*y + R(m.knl[i]);
-      bx  = by*y + bx*x + R(m.ksl[i]);
+    RFOR(i,n-1) {
+      byt = by*x - bx*y; addcoef<M>(byt, m.knl[i]);
+      bx  = by*y + bx*x; addcoef<M>(bx , m.ksl[i]);
       by  = byt;
     }
   }
 }
 
-template <typename M, typename T=M::T, typename V, typename R=M::R>
-inline void bxbyh (const cflw<M> &m, const V &x, const V &y, T &bx, T &by)
+template <int N, typename M, typename T, typename V, typename R=M::R>
+inline void bxbyhn (const cflw<M> &m, const V &x, const V &y, T &bx, T &by)
 {
+  const int snm = N ? N : m.snm;
   T btx(bx), bty(by);
 
   int k = -1;
   bx = 0., by = 0.;
-  RFOR(i,m.snm) {
+  RFOR(i,snm) {
     btx = 0., bty = 0.;
 
-    RFOR(j,m.snm-i-1) { ++k; // must skip the first iteration
-      btx = (btx + R(m.bfx[k])) * y;
-      bty = (bty + R(m.bfy[k])) * y;
+    RFOR(j,snm-i-1) { ++k; // must skip the first iteration
+      addcoef<M>(btx, m.bfx[k]); btx *= y;
+      addcoef<M>(bty, m.bfy[k]); bty *= y;
     }
 
     ++k;
-    bx = (bx + btx + R(m.bfx[k])) * x;
-    by = (by + bty + R(m.bfy[k])) * x;
+    bx += btx; addcoef<M>(bx, m.bfx[k]); bx *= x;
+    by += bty; addcoef<M>(by, m.bfy[k]); by *= x;
   }
 
   btx = 0., bty = 0.;
-  RFOR(i,m.snm) { ++k;
-    btx = (btx + R(m.bfx[k])) * y;
-    bty = (bty + R(m.bfy[k])) * y;
+  RFOR(i,snm) { ++k;
+    addcoef<M>(btx, m.bfx[k]); btx *= y;
+    addcoef<M>(bty, m.bfy[k]); bty *= y;
   }
 
   bx += btx + R(m.bfx[k+1]); // better to enforce associativity in Lua.
   by += bty + R(m.bfy[k+1]);
 }
 
+// dispatch on the element (sector) number of multipoles, most common first
+template <typename M, typename T=M::T, typename V>
+inline void bxby (const cflw<M> &m, const V &x, const V &y, T &bx, T &by)
+{
+  switch (m.nmul) {
+  case 2 : bxbyn<2>(m, x, y, bx, by); break; // quadrupole
+  case 3 : bxbyn<3>(m, x, y, bx, by); break; // sextupole
+  case 1 : bxbyn<1>(m, x, y, bx, by); break; // dipole
+  case 4 : bxbyn<4>(m, x, y, bx, by); break; // octupole
+  default: bxbyn<0>(m, x, y, bx, by);
+  }
+}
+
+template <typename M, typename T=M::T, typename V>
+inline void bxbyh (const cflw<M> &m, const V &x, const V &y, T &bx, T &by)
+{
+  switch (m.snm) {
+  case 1 : bxbyhn<1>(m, x, y, bx, by); break;
+  case 2 : bxbyhn<2>(m, x, y, bx, by); break;
+  case 3 : bxbyhn<3>(m, x, y, bx, by); break;
+  case 4 : bxbyhn<4>(m, x, y, bx, by); break;
+  default: bxbyhn<0>(m, x, y, bx, by);
+  }
+}
+
 // --- patches ----------------------------------------------------------------o
 
 template <typename M, typename T=M::T, typename P=M::P, typename R=M::R, typename V>
@@ -1141,6 +1235,526 @@ inline void rfcav_kickn (cflw<M> &m, num_t lw, int is)
   mdump(1);
 }
 
+// --- beam-beam ---
+
+// 2D field of a gaussian strong beam per unit of line charge and kicks of
+// (4D) and Hirata-like (6D) interactions, slices of the 6D strong beam have
+// equal charges, constant sigmas (no hourglass) and are met head first.
+
+const num_t bb_fct = 1/(mad_cst_2PI*mad_cst_EPSILON0);
+
+// particles are kicked only if the orbit is kicked (see bbeam_kick in Lua)
+template <typename M>
+constexpr bool bb_ispar = std::is_same<M,par_t>::value;
+
+// Faddeeva function w(z) for z = zr + i zi
+inline void bb_wf (num_t zr, num_t zi, num_t &wr, num_t &wi)
+{
+  mad_cvec_wf_r(&zr, &zi, &wr, &wi, 1);
+}
+
+inline int bb_ord (num_t) { return 0; }
+template <int N> inline int bb_ord (const mad::jet <N>&  ) { return 1; }
+template <int N> inline int bb_ord (const mad::jet2<N>&  ) { return 2; }
+template <class A> inline int bb_ord (const mad::tpsa_base<A> &a) { return a.mo(); }
+
+// w(z) for maps, i.e. Taylor series around z0 = fval(z) from the recurrence
+// c1 = -2 z0 c0 + 2i/sqrt(pi), c(n+1) = -2 (z0 cn + c(n-1)) / (n+1)
+template <typename T>
+inline void bb_wf (const T &zr, const T &zi, T &wr, T &wi)
+{
+  using cnum_t = std::complex<num_t>;
+  const int n = std::max(bb_ord(zr), bb_ord(zi));
+  num_t z0r = fval(zr), z0i = fval(zi), w0r, w0i;
+  bb_wf(z0r, z0i, w0r, w0i);
+
+  cnum_t z0(z0r, z0i), c_[3], *c = c_;
+  std::vector<cnum_t> cv;
+  if (n > 2) cv.resize(n+1), c = cv.data();
+
+  c[0] = cnum_t(w0r, w0i);
+  if (n > 0) c[1] = -2.*z0*c[0] + cnum_t(0, mad_cst_2_SQRTPI);
+  FOR(k,1,n) c[k+1] = -2.*(z0*c[k] + c[k-1])/num_t(k+1);
+
+  T dr = zr - z0r, di = zi - z0i, tr(zr);
+  wr = c[n].real(), wi = c[n].imag();
+  RFOR(k,n) {
+    tr = wr*dr - wi*di + c[k].real();
+    wi = wr*di + wi*dr + c[k].imag();
+    wr = tr;
+  }
+}
+
+// field of a round beam, (1-exp(-u))/u is expanded for small u
+template <typename T, typename P>
+inline void bb_exey_rnd (const T &x, const T &y, const P &sig, T &ex, T &ey)
+{
+  P s2 = 2*sqr(sig);
+  T u  = (sqr(x) + sqr(y))/s2;
+  T f(x), c(x);
+
+  if (fval(u) < 0.1) {
+    f = 1., c = 1.;
+    FOR(k,1,11) c = -u/(k+1)*c, f += c;
+  } else
+    f = (1 - exp(-u))/u;
+
+  f = (bb_fct/s2)*f;
+  ex = f*x, ey = f*y;
+}
+
+// field of an elliptical beam (Bassetti-Erskine) in the first quadrant
+template <typename T, typename P, typename Q>
+inline void bb_exey (const T &x, const T &y, const Q &sx_, const Q &sy_, num_t tol,
+                     T &ex, T &ey)
+{
+  P sx(sx_), sy(sy_); sx = sx_, sy = sy_;
+
+  if (fabs(fval(sx)-fval(sy)) < tol) {
+    P sig = 0.5*(sx+sy);
+    bb_exey_rnd<T,P>(x, y, sig, ex, ey); return;
+  }
+
+  const bool sw = fval(sx) < fval(sy);
+  const num_t gx = fval(x) < 0 ? -1 : 1, gy = fval(y) < 0 ? -1 : 1;
+  const T  ax = gx*x, ay = gy*y;
+  const P &a  = sw ? sy : sx, &b = sw ? sx : sy;
+  const T &u  = sw ? ay : ax, &v = sw ? ax : ay;
+
+  P S = sqrt(2*(sqr(a)-sqr(b)));
+  T zr = u/S, zi = v/S, er = b/a*zr, ei = a/b*zi;
+  T wzr(zr), wzi(zi), wer(er), wei(ei);
+  bb_wf(zr, zi, wzr, wzi);
+  bb_wf(er, ei, wer, wei);
+
+  P fct = (bb_fct*mad_cst_SQRTPI)/S;
+  T e   = exp(-0.5*(sqr(ax/sx) + sqr(ay/sy)));
+  T fi  = fct*(wzi - wei*e), fr = fct*(wzr - wer*e);
+
+  if (sw) ex = gx*fr, ey = gy*fi;
+  else    ex = gx*fi, ey = gy*fr;
+}
+
+// fields of all particles at once, i.e. one call to the vectorized w(z)
+inline void bb_exey (ssz_t n, const num_t x[], const num_t y[],
+                     num_t sx, num_t sy, num_t tol, num_t ex[], num_t ey[])
+{
+  if (n <= 0) return;
+
+  if (fabs(sx-sy) < tol) {
+    num_t sig = 0.5*(sx+sy);
+    FOR(i,n) bb_exey_rnd(x[i], y[i], sig, ex[i], ey[i]);
+    return;
+  }
+
+  const bool sw = sx < sy;
+  const num_t a = sw ? sy : sx, b = sw ? sx : sy;
+  const num_t S = sqrt(2*(sqr(a)-sqr(b))), fct = (bb_fct*mad_cst_SQRTPI)/S;
+
+  num_t buf_[4*2*64], *buf = n <= 64 ? buf_ : (num_t*)mad_malloc(4*2*n*sizeof *buf);
+  num_t *zr = buf, *zi = buf+2*n, *wr = buf+4*n, *wi = buf+6*n;
+
+  FOR(i,n) {
+    num_t u = fabs(sw ? y[i] : x[i]), v = fabs(sw ? x[i] : y[i]);
+    zr[i] = u/S,       zi[i] = v/S;
+    zr[n+i] = b/a*u/S, zi[n+i] = a/b*v/S;
+  }
+
+  mad_cvec_wf_r(zr, zi, wr, wi, 2*n);
+
+  FOR(i,n) {
+    num_t e  = exp(-0.5*(sqr(x[i]/sx) + sqr(y[i]/sy)));
+    num_t fi = fct*(wi[i] - wi[n+i]*e), fr = fct*(wr[i] - wr[n+i]*e);
+    num_t gx = x[i] < 0 ? -1 : 1, gy = y[i] < 0 ? -1 : 1;
+    if (sw) ex[i] = gx*fr, ey[i] = gy*fi;
+    else    ex[i] = gx*fi, ey[i] = gy*fr;
+  }
+
+  if (n > 64) mad_free(buf);
+}
+
+// kick factor for a particle of velocity bet (i.e. pz/(1/beta+pt))
+template <typename M, typename T>
+inline T bb_kck (const cflw<M> &m, const T &bet)
+{
+  num_t c = mad_cst_QELECT*m.bbq*m.charge*m.edir*m.sdir/m.pc;
+  return c*(1 + bet*m.bbb)/(bet + m.bbb);
+}
+
+template <typename M, typename T=M::T, typename P=M::P, typename R=M::R>
+inline void bbeam_kick (cflw<M> &m, num_t lw, int is)
+{                                       (void)lw, (void)is;
+  if (m.npar <= 0 || (bb_ispar<M> && !m.bbko)) return;
+
+  mdump(0);
+  if constexpr (std::is_floating_point<T>::value) {
+    const int n = m.npar;
+    num_t buf_[4*64], *buf = n <= 64 ? buf_ : (num_t*)mad_malloc(4*n*sizeof *buf);
+    num_t *x = buf, *y = buf+n, *ex = buf+2*n, *ey = buf+3*n;
+
+    FOR(i,n) {
+      M p(m,i);
+      x[i] = p.x - m.bbx, y[i] = p.y - m.bby;
+    }
+
+    bb_exey(n, x, y, m.bbsx, m.bbsy, m.bbtol, ex, ey);
+
+    FOR(i,n) {
+      M p(m,i);
+      num_t bet = sqrt(1 + 2*p.pt/m.beta + sqr(p.pt))/(1/m.beta + p.pt);
+      num_t kck = bb_kck(m, bet);
+      p.px += kck*ex[i] - m.bbdpx;
+      p.py += kck*ey[i] - m.bbdpy;
+    }
+
+    if (n > 64) mad_free(buf);
+  } else {
+    FOR(i,m.npar) {
+      M p(m,i);
+      T x = p.x - R(m.bbx), y = p.y - R(m.bby), ex(x), ey(y);
+      bb_exey<T,P,R>(x, y, R(m.bbsx), R(m.bbsy), m.bbtol, ex, ey);
+
+      T bet = sqrt(1 + 2*p.pt/m.beta + sqr(p.pt))/(1/m.beta + p.pt);
+      T kck = bb_kck(m, bet);
+      ex = kck*ex, ey = kck*ey;
+
+      if (!m.bbko) ex -= fval(ex), ey -= fval(ey); // clear orbit kick
+      p.px += ex - R(m.bbdpx);
+      p.py += ey - R(m.bbdpy);
+    }
+  }
+  mdump(1);
+}
+
+// boost to the head-on frame of (x,px,y,py,z,d), z=t*pz/(1/beta+pt) and d=pz-1
+// are canonical
+struct bb_angle {
+  num_t sphi, cphi, tphi, salp, calp;
+  bb_angle(num_t phi, num_t alp)
+    : sphi(sin(phi)), cphi(cos(phi)), tphi(tan(phi)), salp(sin(alp)), calp(cos(alp)) {}
+};
+
+template <typename T, typename M>
+inline void bb_boost (M &p, const bb_angle &a)
+{
+  T h  = p.pt + 1 - sqrt(sqr(1+p.pt) - sqr(p.px) - sqr(p.py));
+  T px = (p.px - h*a.calp*a.tphi)/a.cphi;
+  T py = (p.py - h*a.salp*a.tphi)/a.cphi;
+  T d  = p.pt - (p.px*a.calp + p.py*a.salp)*a.tphi + h*sqr(a.tphi);
+  T pz = sqrt(sqr(1+d) - sqr(px) - sqr(py));
+  T hx = px/pz, hy = py/pz, hz = 1 - (1+d)/pz;
+
+  T x = (1+hx*a.calp*a.sphi)*p.x + hx*a.salp*a.sphi*p.y + a.calp*a.tphi*p.t;
+  T y = hy*a.calp*a.sphi*p.x + (1+hy*a.salp*a.sphi)*p.y + a.salp*a.tphi*p.t;
+  p.t = hz*a.calp*a.sphi*p.x + hz*a.salp*a.sphi*p.y + p.t/a.cphi;
+  p.x = x, p.y = y, p.px = px, p.py = py, p.pt = d;
+}
+
+template <typename T, typename M>
+inline void bb_iboost (M &p, const bb_angle &a)
+{
+  T pz = sqrt(sqr(1+p.pt) - sqr(p.px) - sqr(p.py));
+  T hx = p.px/pz, hy = p.py/pz, hz = 1 - (1+p.pt)/pz;
+
+  // inverse of the linear part of the boost by cofactors
+  T l11 = 1+hx*a.calp*a.sphi, l12 = hx*a.salp*a.sphi;
+  T l21 = hy*a.calp*a.sphi, l22 = 1+hy*a.salp*a.sphi;
+  T l31 = hz*a.calp*a.sphi, l32 = hz*a.salp*a.sphi;
+  num_t l13 = a.calp*a.tphi, l23 = a.salp*a.tphi, l33 = 1/a.cphi;
+
+  T c11 = l22*l33 - l23*l32, c12 = l13*l32 - l12*l33, c13 = l12*l23 - l13*l22;
+  T c21 = l23*l31 - l21*l33, c22 = l11*l33 - l13*l31, c23 = l13*l21 - l11*l23;
+  T c31 = l21*l32 - l22*l31, c32 = l12*l31 - l11*l32, c33 = l11*l22 - l12*l21;
+  T idet = 1/(l11*c11 + l12*c21 + l13*c31);
+
+  T x = (c11*p.x + c12*p.y + c13*p.t)*idet;
+  T y = (c21*p.x + c22*p.y + c23*p.t)*idet;
+  p.t = (c31*p.x + c32*p.y + c33*p.t)*idet;
+  p.x = x, p.y = y;
+
+  T h = (1 + p.pt - pz)*sqr(a.cphi);
+  p.px = p.px*a.cphi + h*a.calp*a.tphi;
+  p.py = p.py*a.cphi + h*a.salp*a.tphi;
+  p.pt = p.pt + (p.px*a.calp + p.py*a.salp)*a.tphi - h*sqr(a.tphi);
+}
+
+// centroids of ns gaussian slices of equal charge, head first
+inline void bb_slices (int ns, num_t sz, num_t zs[])
+{
+  const num_t c = 1/sqrt(mad_cst_2PI);
+  num_t g0 = 0; // density at the edge +inf
+
+  FOR(k,1,ns+1) {
+    num_t q = 0, g1 = 0; // edge at quantile 1-k/ns (-inf if k=ns)
+    if (k < ns) {
+      const num_t pk = 1 - num_t(k)/ns; // solve cdf(q) = pk by Newton
+      FOR(it,100) {
+        num_t dq = (0.5*erfc(-q/mad_cst_SQRT2) - pk)/(c*exp(-0.5*sqr(q)));
+        q -= dq;
+        if (fabs(dq) < 1e-15*(1+fabs(q))) break;
+      }
+      g1 = c*exp(-0.5*sqr(q));
+    }
+    zs[k-1] = ns*sz*(g1 - g0);
+    g0 = g1;
+  }
+}
+
+template <typename M, typename T, typename V>
+inline void bb_slice_kick (const cflw<M> &m, M &p, num_t s, int ns,
+                           const V &ex, const V &ey)
+{
+  T pz  = 1 + p.pt;
+  T bet = pz/sqrt(sqr(pz) + 1/sqr(m.betgam));
+  T kck = bb_kck(m, bet)/ns;
+  T fx  = kck*ex, fy = kck*ey, S = 0.5*(p.t - s);
+
+  p.pt += 0.5*(fx*(p.px + 0.5*fx) + fy*(p.py + 0.5*fy));
+  p.x  -= S*fx, p.px += fx;
+  p.y  -= S*fy, p.py += fy;
+}
+
+template <typename M, typename T=M::T, typename P=M::P, typename R=M::R>
+inline void bbeam_kick6D (cflw<M> &m, num_t lw, int is)
+{                                         (void)lw, (void)is;
+  if (m.npar <= 0 || (bb_ispar<M> && !m.bbko)) return;
+
+  mdump(0);
+  const int n = m.npar, ns = std::max(1, m.bbns);
+  const bb_angle a(m.bbphi, m.bbalp);
+  std::vector<num_t> zs(ns), orb(bb_ispar<M> || m.bbko ? 0 : 6*n);
+
+  bb_slices(ns, m.bbsz, zs.data());
+
+  FOR(i,n) {
+    M p(m,i);
+    if (!orb.empty()) {
+      num_t *o = &orb[6*i];
+      o[0] = fval(p.x), o[1] = fval(p.px), o[2] = fval(p.y);
+      o[3] = fval(p.py), o[4] = fval(p.t), o[5] = fval(p.pt);
+    }
+    T pz = sqrt(1 + 2*p.pt/m.beta + sqr(p.pt));
+    p.t  = p.t*pz/(1/m.beta + p.pt);
+    p.pt = pz - 1;
+    bb_boost<T>(p, a);
+  }
+
+  if constexpr (std::is_floating_point<T>::value) {
+    num_t buf_[4*64], *buf = n <= 64 ? buf_ : (num_t*)mad_malloc(4*n*sizeof *buf);
+    num_t *x = buf, *y = buf+n, *ex = buf+2*n, *ey = buf+3*n;
+
+    FOR(k,ns) {
+      FOR(i,n) {
+        M p(m,i);
+        num_t S = 0.5*(p.t - zs[k]);
+        x[i] = p.x + S*p.px - m.bbx, y[i] = p.y + S*p.py - m.bby;
+      }
+      bb_exey(n, x, y, m.bbsx, m.bbsy, m.bbtol, ex, ey);
+      FOR(i,n) {
+        M p(m,i);
+        bb_slice_kick<M,T>(m, p, zs[k], ns, ex[i], ey[i]);
+      }
+    }
+
+    if (n > 64) mad_free(buf);
+  } else {
+    FOR(i,n) {
+      M p(m,i);
+      FOR(k,ns) {
+        T S = 0.5*(p.t - zs[k]);
+        T x = p.x + S*p.px - R(m.bbx), y = p.y + S*p.py - R(m.bby), ex(x), ey(y);
+        bb_exey<T,P,R>(x, y, R(m.bbsx), R(m.bbsy), m.bbtol, ex, ey);
+        bb_slice_kick<M,T>(m, p, zs[k], ns, ex, ey);
+      }
+    }
+  }
+
+  FOR(i,n) {
+    M p(m,i);
+    bb_iboost<T>(p, a);
+    T pz = 1 + p.pt;
+    p.pt = sqrt(sqr(pz) + 1/sqr(m.betgam)) - 1/m.beta;
+    p.t  = p.t*(1/m.beta + p.pt)/pz;
+
+    if (!orb.empty()) { // clear orbit kick
+      const num_t *o = &orb[6*i];
+      p.x  += o[0]-fval(p.x) , p.px += o[1]-fval(p.px), p.y  += o[2]-fval(p.y);
+      p.py += o[3]-fval(p.py), p.t  += o[4]-fval(p.t) , p.pt += o[5]-fval(p.pt);
+    }
+    p.px -= R(m.bbdpx);
+    p.py -= R(m.bbdpy);
+  }
+  mdump(1);
+}
+
+// --- space-charge ---
+
+// frozen space-charge of the own gaussian beam (4D), the fields of the strong
+// beam hold the beam sizes and centre, bbq the kick strength per unit of line
+// density and bbsz the bunch length, or 0 for coasting beam (see set_spch in
+// madl_etrck.mad). Kicks scale as (1-bet^2)/bet, i.e. 1/(gamma^2 beta).
+
+template <typename M, typename T=M::T, typename P=M::P, typename R=M::R>
+inline void spch_kick (cflw<M> &m, num_t lw, int is)
+{                                                                 (void)is;
+  if (m.npar <= 0) return;
+
+  mdump(0);
+  const num_t kq = lw*m.sdir*m.bbq, bsz = m.bbsz > 0 ? m.beta/m.bbsz : 0;
+
+  if constexpr (std::is_floating_point<T>::value) {
+    const int n = m.npar;
+    num_t buf_[4*64], *buf = n <= 64 ? buf_ : (num_t*)mad_malloc(4*n*sizeof *buf);
+    num_t *x = buf, *y = buf+n, *ex = buf+2*n, *ey = buf+3*n;
+
+    FOR(i,n) {
+      M p(m,i);
+      x[i] = p.x - m.bbx, y[i] = p.y - m.bby;
+    }
+
+    bb_exey(n, x, y, m.bbsx, m.bbsy, m.bbtol, ex, ey);
+
+    FOR(i,n) {
+      M p(m,i);
+      num_t bet = sqrt(1 + 2*p.pt/m.beta + sqr(p.pt))/(1/m.beta + p.pt);
+      num_t kck = kq*(1 - sqr(bet))/bet;
+      if (m.bbsz > 0) kck *= exp(-0.5*sqr(p.t*bsz));
+      p.px += kck*ex[i];
+      p.py += kck*ey[i];
+    }
+
+    if (n > 64) mad_free(buf);
+  } else {
+    FOR(i,m.npar) {
+      M p(m,i);
+      T x = p.x - R(m.bbx), y = p.y - R(m.bby), ex(x), ey(y);
+      bb_exey<T,P,R>(x, y, R(m.bbsx), R(m.bbsy), m.bbtol, ex, ey);
+
+      T bet = sqrt(1 + 2*p.pt/m.beta + sqr(p.pt))/(1/m.beta + p.pt);
+      T kck = kq*(1 - sqr(bet))/bet;
+      if (m.bbsz > 0) kck = kck*exp(-0.5*sqr(p.t*bsz));
+      p.px += kck*ex;
+      p.py += kck*ey;
+    }
+  }
+  mdump(1);
+}
+
+// --- synchrotron radiation ---
+
+// energy loss of synchrotron radiation in the slice from the curvature of the
+// trajectory in the fields (PTC-like), see srad_damp in madl_synrad.mad.
+// Quantum photons use the curvature from the momenta at the previous slice
+// (bak), see srad_quant in madl_synrad.mad, and are emitted from the
+// counter-based stream (seed,id,turn,elem) of each particle, i.e.
+// independently of the particles order and threads.
+
+const num_t srad_kcrit = 1.5*mad_cst_HBAR*mad_cst_CLIGHT;
+
+template <typename M, typename T=M::T, typename P=M::P, typename R=M::R>
+inline void srad_curv (cflw<M> &m, const M &p, num_t aelw, T &h2, T &hlw, T &dp1)
+{
+  T bx(p.x), by(p.y);
+  if (m.snm  > 0) bxbyh(m, p.x, p.y, bx, by); else
+  if (m.nmul > 0) bxby (m, p.x, p.y, bx, by); else bx = 0., by = 0.;
+  bx = bx/R(m.lrad), by = by/R(m.lrad);
+
+  P bsol = R(m.ks)*0.5*m.edir;
+  dp1    = sqrt(1 + 2/m.beta*p.pt + sqr(p.pt));
+  T npx  = p.px + bsol*m.charge*p.y;
+  T npy  = p.py - bsol*m.charge*p.x;
+  T npz  = sqrt(sqr(dp1) - sqr(npx) - sqr(npy));
+  T ex   = npx/dp1, ey = npy/dp1, ez = npz/dp1;
+  T be   = bx*ex + by*ey + 2*bsol*ez;
+
+  h2  = sqr(bx - be*ex) + sqr(by - be*ey) + sqr(2*bsol - be*ez);
+  hlw = aelw*(1 + R(m.eh)*p.x)/npz;
+}
+
+template <typename M, typename T=M::T, typename P=M::P, typename R=M::R>
+inline void srad_damp (cflw<M> &m, num_t lw, const srad_t &r)
+{
+  if (m.lrad == 0 || !m.charge) return;
+
+  mdump(0);
+  const num_t aelw = fabs(m.lrad*lw);
+  const num_t gam0 = m.betgam/m.beta;
+  const num_t rcst = 2./3*r.facr*r.emrad*gam0*gam0*gam0;
+  P bsol = R(m.ks)*0.5*m.edir*m.charge;
+
+  FOR(i,m.npar) {
+    M p(m,i);
+    T h2(p.x), hlw(p.x), dp1(p.x);
+    srad_curv(m, p, aelw, h2, hlw, dp1);
+    if (fval(h2) <= 0) continue;
+
+    T rfac = rcst*(1+p.pt)*(1+p.pt)*(1+p.pt)*h2*hlw;
+    if (m.sdir < 0) rfac = -rfac;
+
+    T pt   = p.pt - rfac;
+    T pfac = sqrt(1 + 2/m.beta*pt + sqr(pt))/dp1;
+    p.px = p.px*pfac + bsol*p.y*(pfac-1);
+    p.py = p.py*pfac - bsol*p.x*(pfac-1);
+    p.pt = pt;
+  }
+  mdump(1);
+}
+
+inline void srad_quant (cflw<par_t> &m, num_t lw, srad_t &r)
+{
+  using M = par_t;
+  r.nphot = r.mphot = 0;
+  if (m.lrad == 0 || !m.charge) return;
+
+  mdump(0);
+  const num_t aelw = fabs(m.lrad*lw);
+  const num_t gam0 = m.betgam/m.beta;
+  const num_t mass = m.pc/m.betgam;
+
+  FOR(i,m.npar) {
+    M p(m,i);
+    num_t *b = r.bak[i];
+    const num_t hlw = aelw*(1 + 0.5*m.eh*(p.x+b[0]));
+    const num_t h   = hypot((p.px-b[1])/hlw - m.eh, (p.py-b[2])/hlw);
+    b[0] = p.x, b[1] = p.px, b[2] = p.py; // backup
+    if (!(h > 0)) continue; // as kck > 0 in Lua (nan)
+
+    const num_t dp1   = sqrt(1 + 2/m.beta*p.pt + sqr(p.pt));
+    const num_t gam   = (1 + m.beta*p.pt)*gam0;
+    const num_t ucrit = srad_kcrit*gam*gam/mass*h;  // relative to energy
+    const num_t aphot = r.aphot*dp1*h*hlw;          // mean number of photons
+
+    crng_state_t rng = r.rng;
+    mad_num_crandpos(&rng, r.id[i], r.turn, r.elem);
+    rng.n = r.slc << 16;
+
+    // number of photons (poisson) from exponential free paths
+    int nph = 0;
+    for (num_t s=-log1p(-mad_num_crand(&rng)); s < aphot;
+               s-=log1p(-mad_num_crand(&rng))) ++nph;
+    if (!nph) continue;
+
+    num_t rfac = 0, ph[8];
+    for (int k=0; k < nph; k += 8) {
+      const int n = std::min(nph-k, 8);
+      mad_rad_photv(&rng, ph, n);
+      FOR(j,n) rfac += ph[j];
+    }
+    rfac *= ucrit;
+
+    const num_t ibet = (1/m.beta + p.pt)/dp1;
+    num_t damp = sqrt(1 + rfac*(rfac-2)*sqr(ibet));
+    if (m.sdir < 0) damp = 1/damp, rfac = -rfac;
+
+    p.px = p.px*damp;
+    p.py = p.py*damp;
+    p.pt = p.pt*(1-rfac) - rfac/m.beta;
+
+    r.nphot += nph, r.mphot = std::max(r.mphot, nph);
+  }
+  mdump(1);
+}
+
 // --- fringe maps ------------------------------------------------------------o
 
 // must be identical to M.fringe in madl_dynmap.mad
@@ -1319,6 +1933,45 @@ inline void mad8_wedge (cflw<M> &m, num_t lw, const V &e)
   mdump(1);
 }
 
+// element constant factors of bend, qsad and mult fringes with numeric
+// parameters, computed on first use of each fringe and cleared by cfringe
+// (madl_etrck.mad)
+template <typename M>
+constexpr bool frng_isnum = std::is_same<typename M::P,num_t>::value;
+
+enum { fcok_bend = 1, fcok_qsad = 2, fcok_mult = 4 };
+
+template <typename M>
+inline void frng_coef (cflw<M> &m, int knd)
+{
+  if (m.fcok & knd) return;
+  m.fcok |= knd;
+
+  switch (knd) {
+  case fcok_bend:
+    m.fcb0 = m.knl[0]/fabs(m.el)*(m.sdir*m.edir*m.charge);
+    break;
+
+  case fcok_qsad: {
+    num_t a  = -0.5*atan2(m.ksl[1], m.knl[1]);
+    num_t b2 = hypot(m.knl[1], m.ksl[1])/m.el*m.edir;
+    m.fcca = cos(a), m.fcsa = sin(a);
+    m.fcf1 = m.charge*(fabs(m.f1)*m.f1/-24)*b2;
+    m.fcf2 = m.charge*m.f2*b2*m.sdir;
+  } break;
+
+  case fcok_mult: {
+    int   n  = MIN(m.nmul,m.fmax);
+    num_t _l = fval(m.el) ? m.edir/m.el : m.edir;
+    FOR (j,1,n+1) {
+      num_t nj = -m.charge/(4.*(j+1));
+      m.fckn[j-1] = nj*(m.knl[j-1]*_l);
+      m.fcks[j-1] = nj*(m.ksl[j-1]*_l);
+    }
+  } break;
+  }
+}
+
 #if 0  // version from L.D. & PTC (requires correct inversion for backtracking)
 template <typename M, typename T=M::T, typename P=M::P, typename R=M::R>
 inline void bend_fringe (cflw<M> &m, num_t lw)
@@ -1387,11 +2040,14 @@ inline void bend_fringe (cflw<M> &m, num_t lw)
 
   mdump(0);
   P fh = 2*R(m.fint)*R(m.hgap);
-  P b0 = R(m.knl[0])/abs(R(m.el))*(lw*m.sdir*m.edir*m.charge);
+  P b0(1);
+  if constexpr (frng_isnum<M>) frng_coef(m, fcok_bend), b0 = lw*m.fcb0;
+  else b0 = R(m.knl[0])/abs(R(m.el))*(lw*m.sdir*m.edir*m.charge);
   P c2 = fh*b0;
   P fsad(1);
 
   if (fval(fh)) fsad=1/(36*fh); else fsad = 0.;
+  P fb2 = fsad*sqr(b0);
 
   FOR (i,m.npar) {
     M p(m,i);
@@ -1401,7 +2057,7 @@ inline void bend_fringe (cflw<M> &m, num_t lw)
     T  _pz2 = sqr(_pz);
     T  relp = invsqrt(dpp);
     T  tfac = -1/m.beta - p.pt;
-    T    c3 = fsad*sqr(b0)*relp;
+    T    c3 = fb2*relp;
 
     T xp  = p.px/pz,  yp  = p.py/pz;
     T xyp = xp*yp  ,  yp2 = 1+sqr(yp);
@@ -1472,11 +2128,18 @@ inline void qsad_fringe (cflw<M> &m, num_t lw)
   if (fabs(m.f1)    +fabs(m.f2)     < minstr) return;
 
   mdump(0);
-  P a   = -0.5*atan2(R(m.ksl[1]), R(m.knl[1]));
-  P b2  = hypot(R(m.knl[1]), R(m.ksl[1]))/R(m.el)*m.edir;
-  P ca  = cos(a), sa = sin(a);
-  P bf1 = (abs(R(m.f1))*R(m.f1)/-24)*b2;
-  P bf2 =               R(m.f2)     *b2*m.sdir;
+  P ca(1), sa(1), bf1(1), bf2(1);
+  if constexpr (frng_isnum<M>) {
+    frng_coef(m, fcok_qsad);
+    ca  = m.fcca   , sa  = m.fcsa;
+    bf1 = m.fcf1*lw, bf2 = m.fcf2;
+  } else {
+    P a  = -0.5*atan2(R(m.ksl[1]), R(m.knl[1]));
+    P b2 = hypot(R(m.knl[1]), R(m.ksl[1]))/R(m.el)*m.edir;
+    ca  = cos(a), sa = sin(a);
+    bf1 = (lw*m.charge)*(abs(R(m.f1))*R(m.f1)/-24)*b2;
+    bf2 =     m.charge *               R(m.f2)     *b2*m.sdir;
+  }
 
   // Lee-Whiting formula, E. Forest ch 13.2.3, eq 13.33
   FOR (i,m.npar) {
@@ -1484,21 +2147,22 @@ inline void qsad_fringe (cflw<M> &m, num_t lw)
     T _pz = invsqrt(1 + 2/m.beta*p.pt + sqr(p.pt));
     T  dt = (1/m.beta+p.pt)*_pz;
 
-    T  f1 = lw*m.charge*bf1*_pz;
-    T  f2 =    m.charge*bf2*_pz;
+    T  f1 = bf1*_pz;
+    T  f2 = bf2*_pz;
+    T ef1 = exp(f1), _ef1 = 1/ef1;
 
     T nx  = ca*p.x  + sa*p.y;
     T npx = ca*p.px + sa*p.py;
     T ny  = ca*p.y  - sa*p.x;
     T npy = ca*p.py - sa*p.px;
 
-    p.t  -= dt*((f1*nx + (1+f1/2)*exp(-f1)*f2*npx*_pz)*npx -
-                (f1*ny + (1-f1/2)*exp( f1)*f2*npy*_pz)*npy)*_pz;
+    p.t  -= dt*((f1*nx + (1+f1/2)*_ef1*f2*npx*_pz)*npx -
+                (f1*ny + (1-f1/2)* ef1*f2*npy*_pz)*npy)*_pz;
 
-    nx  =  nx*exp( f1) + f2*npx*_pz;
-    ny  =  ny*exp(-f1) - f2*npy*_pz;
-    npx = npx*exp(-f1);
-    npy = npy*exp( f1);
+    nx  =  nx* ef1 + f2*npx*_pz;
+    ny  =  ny*_ef1 - f2*npy*_pz;
+    npx = npx*_ef1;
+    npy = npy* ef1;
 
     p.x  = ca*nx  - sa*ny;
     p.px = ca*npx - sa*npy;
@@ -1519,7 +2183,8 @@ inline void mult_fringe (cflw<M> &m, num_t lw)
   int   no_k1 = m.frng & fringe_bend;
   P     _l(1);
 
-  if (fval(m.el)) _l = m.edir/R(m.el); else _l = m.edir;
+  if constexpr (frng_isnum<M>) frng_coef(m, fcok_mult);
+  else if (fval(m.el)) _l = m.edir/R(m.el); else _l = m.edir;
 
   FOR (i,m.npar) {
     M p(m,i);
@@ -1535,7 +2200,9 @@ inline void mult_fringe (cflw<M> &m, num_t lw)
       ix = drx*p.y + dix*p.x;
 
       num_t nj = -wchg/(4*(j+1)), nf = (j+2.)/j;
-      P kj = R(m.knl[j-1])*_l, ksj = R(m.ksl[j-1])*_l;
+      P kj(1), ksj(1);
+      if constexpr (frng_isnum<M>) nj = lw, kj = m.fckn[j-1], ksj = m.fcks[j-1];
+      else kj = R(m.knl[j-1])*_l, ksj = R(m.ksl[j-1])*_l;
 
       T u(p.x), v(p.x), du(p.x), dv(p.x);
       if (j == 1 && no_k1) {
@@ -1578,6 +2245,9 @@ inline void mult_fringe (cflw<M> &m, num_t lw)
   mdump(1);
 }
 
+// the bend, mult and qsad fringes read their coefficients from frng_coef, the
+// faces and wedges are not cached as they cost a few flops (and one sincos) per
+// element side compared to the loops over the particles.
 template <typename M, typename T=M::T, typename P=M::P, typename R=M::R>
 inline void curex_fringe (cflw<M> &m, num_t lw)
 {
@@ -1658,6 +2328,154 @@ inline void rfcav_fringe (cflw<M> &m, num_t lw)
   mdump(1);
 }
 
+// --- dense damaps -----------------------------------------------------------o
+
+// damaps of order 1 with nn <= 8 and of order 2 with nn <= 6 are tracked as
+// dense jets (map_t1, map_t2) converted from and back to GTPSA around each map,
+// this avoids the overhead of tpsa temporaries and calls for the few coefs of
+// low orders damaps. Order 2 with nn > 6 is not faster than GTPSA (hessian).
+
+enum { dense_nn1 = 8, dense_nn2 = 6 };
+
+template <int N>
+struct dense_idx { // cache of GTPSA indexes of order 2 for the packed hessian
+  static constexpr int H = N*(N+1)/2;
+  const desc_t *d;
+  int   nv, np;
+  ord_t mo, po;
+  ssz_t nc;                  // number of coefs up to order 2
+  idx_t h[H];                // nc (i.e. dummy slot) if not in the descriptor
+  num_t s[H];                // scaling from Taylor coefs to derivatives
+};
+
+template <int N>
+inline const dense_idx<N>& dense_hidx (const desc_t *d, int nn)
+{
+  static thread_local dense_idx<N> c {};
+  int nv, np; ord_t mo, po;
+  nv = mad_desc_getnv(d, &mo, &np, &po);
+
+  if (c.d != d || c.nv != nv || c.np != np || c.mo != mo || c.po != po) {
+    c.d = d, c.nv = nv, c.np = np, c.mo = mo, c.po = po;
+    c.nc = mo < 2 ? 1+nn : mad_desc_maxlen(d, 2);
+    ord_t m[N] = {};
+    for (int i=0, k=0; i < N; i++)
+      for (int j=i; j < N; j++, k++) {
+        idx_t ij = -1;
+        if (j < nn) {
+          m[i] += 1, m[j] += 1;
+          ij = mad_desc_idxm(d, nn, m);
+          m[i] -= 1, m[j] -= 1;
+        }
+        c.h[k] = ij < 0 ? c.nc : ij;
+        c.s[k] = i == j ? 2 : 1;
+      }
+  }
+  return c;
+}
+
+template <int N>
+inline void dense_get (const tpsa_t *t, mad::jet<N> &r, int nn, const dense_idx<N>&)
+{
+  num_t c[1+N];
+  mad_tpsa_getv(t, 0, 1+nn, c);
+  r.v = c[0];
+  for (int i=0; i < N; i++) r.d[i] = i < nn ? c[1+i] : 0;
+}
+
+template <int N>
+inline void dense_set (tpsa_t *t, const mad::jet<N> &a, int nn, const dense_idx<N>&)
+{
+  num_t c[1+N];
+  c[0] = a.v;
+  for (int i=0; i < nn; i++) c[1+i] = a.d[i];
+  mad_tpsa_setv(t, 0, 1+nn, c);
+}
+
+template <int N>
+inline void dense_get (const tpsa_t *t, mad::jet2<N> &r, int nn, const dense_idx<N> &x)
+{
+  num_t c[2+N+dense_idx<N>::H];
+  mad_tpsa_getv(t, 0, x.nc, c); c[x.nc] = 0;
+  r.v = c[0];
+  for (int i=0; i < N; i++) r.d[i] = i < nn ? c[1+i] : 0;
+  for (int k=0; k < x.H; k++) r.h[k] = x.s[k]*c[x.h[k]];
+}
+
+template <int N>
+inline void dense_set (tpsa_t *t, const mad::jet2<N> &a, int nn, const dense_idx<N> &x)
+{
+  num_t c[2+N+dense_idx<N>::H];
+  for (int k=0; k <= x.nc; k++) c[k] = 0;
+  c[0] = a.v;
+  for (int i=0; i < nn; i++) c[1+i] = a.d[i];
+  for (int k=0; k < x.H; k++) c[x.h[k]] = a.h[k]/x.s[k];
+  mad_tpsa_setv(t, 0, x.nc, c);
+}
+
+// max order of damaps if dense tracking is possible, 0 otherwise
+inline ord_t dense_ord (const cflw<map_t> &m, int &nn)
+{
+  if (m.npar <= 0) return 0;
+
+  int np; nn = mad_desc_getnv(mad_tpsa_desc(m.par[0][0]), 0, &np, 0);
+  nn += np;
+  if (nn > dense_nn1) return 0;
+
+  ord_t mo = 0;
+  for (int i=0; i < m.npar; i++)
+    mo = std::max(mo, mad_tpsa_mord(6, const_cast<const tpsa_t**>(m.par[i]), 0));
+  return mo == 1 || (mo == 2 && nn <= dense_nn2) ? mo : 0;
+}
+
+template <typename D, typename F>
+inline void dense_run (cflw<map_t> &m, F &fun, int nn)
+{
+  using MT = D::MT;
+  static_assert(offsetof(cflw<map_t>, par) == offsetof(cflw<D>, par),
+                "incompatible cflw layouts");
+
+  const auto &x = dense_hidx<D::nv>(mad_tpsa_desc(m.par[0][0]), nn);
+  const int np = m.npar;
+  tpsa_t ***par = m.par;
+
+  // most of the time, there is only one damap
+  MT  buf_[2][6], *ptr_[2];
+  MT (*buf)[6] = np <= 2 ? buf_ : (MT(*)[6])mad_malloc(np*sizeof *buf);
+  MT  **ptr    = np <= 2 ? ptr_ : (MT  **  )mad_malloc(np*sizeof *ptr);
+
+  for (int i=0; i < np; i++) {
+    ptr[i] = buf[i];
+    for (int k=0; k < 6; k++) dense_get(par[i][k], buf[i][k], nn, x);
+  }
+
+  // flows differ only by par (see cflw_x), swap it to avoid copying the flow
+  cflw<D> &d = reinterpret_cast<cflw<D>&>(m);
+  memcpy(&d.par, &ptr, sizeof ptr);
+  fun(d);
+  memcpy(&m.par, &par, sizeof par);
+
+  for (int i=0; i < np; i++)
+    for (int k=0; k < 6; k++) dense_set(par[i][k], buf[i][k], nn, x);
+
+  if (np > 2) mad_free(buf), mad_free(ptr);
+}
+
+// call fun(cflw<M>&) with M = map_t or dense damaps
+template <typename F>
+inline void dense_map (cflw<map_t> &m, F &&fun)
+{
+  int nn;
+  switch (dense_ord(m, nn)) {
+  case 1 : dense_run<map_t1<dense_nn1>>(m,fun,nn); break;
+  case 2 : dense_run<map_t2<dense_nn2>>(m,fun,nn); break;
+  default: fun(m);
+  }
+}
+
+#define TMAP(...) \
+  dense_map(m->tflw, [=]<typename M>(cflw<M> &f) { __VA_ARGS__; })
+
 // --- specializations --------------------------------------------------------o
 
 // --- tilt & misalignment ---
@@ -1665,7 +2483,7 @@ void mad_trk_tilt_r (mflw_t *m, num_t lw) {
   srotation<par_t>(m->rflw, lw*m->rflw.sdir, m->rflw.tlt);
 }
 void mad_trk_tilt_t (mflw_t *m, num_t lw) {
-  srotation<map_t>(m->tflw, lw*m->tflw.sdir, m->tflw.tlt);
+  TMAP(srotation<M>(f, lw*f.sdir, f.tlt));
 }
 void mad_trk_tilt_p (mflw_t *m, num_t lw) {
   srotation<prm_t>(m->pflw, lw*m->pflw.sdir, tpsa_ref(m->pflw.tlt));
@@ -1675,7 +2493,7 @@ void mad_trk_misalign_r (mflw_t *m, num_t lw) {
   misalign<par_t>(m->rflw, lw);
 }
 void mad_trk_misalign_t (mflw_t *m, num_t lw) {
-  misalign<map_t>(m->tflw, lw);
+  TMAP(misalign<M>(f, lw));
 }
 void mad_trk_misalign_p (mflw_t *m, num_t lw) {
   misalign<prm_t>(m->pflw, lw);
@@ -1694,13 +2512,13 @@ void mad_trk_rfcav_fringe_r (mflw_t *m, num_t lw) {
 }
 
 void mad_trk_strex_fringe_t (mflw_t *m, num_t lw) {
-  strex_fringe<map_t>(m->tflw, lw);
+  TMAP(strex_fringe<M>(f, lw));
 }
 void mad_trk_curex_fringe_t (mflw_t *m, num_t lw) {
-  curex_fringe<map_t>(m->tflw, lw);
+  TMAP(curex_fringe<M>(f, lw));
 }
 void mad_trk_rfcav_fringe_t (mflw_t *m, num_t lw) {
-  rfcav_fringe<map_t>(m->tflw, lw);
+  TMAP(rfcav_fringe<M>(f, lw));
 }
 
 void mad_trk_strex_fringe_p (mflw_t *m, num_t lw) {
@@ -1732,19 +2550,19 @@ void mad_trk_changeref_r (mflw_t *m, num_t lw, int is) {
 }
 
 void mad_trk_xrotation_t (mflw_t *m, num_t lw, int is) {
-  xrotation<map_t>(m->tflw, lw, zero); (void)is;
+  TMAP(xrotation<M>(f, lw, zero)); (void)is;
 }
 void mad_trk_yrotation_t (mflw_t *m, num_t lw, int is) {
-  yrotation<map_t>(m->tflw, lw, zero); (void)is;
+  TMAP(yrotation<M>(f, lw, zero)); (void)is;
 }
 void mad_trk_srotation_t (mflw_t *m, num_t lw, int is) {
-  srotation<map_t>(m->tflw, lw, zero); (void)is;
+  TMAP(srotation<M>(f, lw, zero)); (void)is;
 }
 void mad_trk_translate_t (mflw_t *m, num_t lw, int is) {
-  translate<map_t>(m->tflw, lw, zero, zero, zero); (void)is;
+  TMAP(translate<M>(f, lw, zero, zero, zero)); (void)is;
 }
 void mad_trk_changeref_t (mflw_t *m, num_t lw, int is) {
-  changeref<map_t>(m->tflw, lw); (void)is;
+  TMAP(changeref<M>(f, lw)); (void)is;
 }
 
 void mad_trk_xrotation_p (mflw_t *m, num_t lw, int is) {
@@ -1776,13 +2594,13 @@ void mad_trk_strex_kickhs_r (mflw_t *m, num_t lw, int is) {
 }
 
 void mad_trk_strex_drift_t (mflw_t *m, num_t lw, int is) {
-  strex_drift<map_t>(m->tflw,lw,is);
+  TMAP(strex_drift<M>(f,lw,is));
 }
 void mad_trk_strex_kick_t (mflw_t *m, num_t lw, int is) {
-  strex_kick<map_t>(m->tflw,lw,is);
+  TMAP(strex_kick<M>(f,lw,is));
 }
 void mad_trk_strex_kickhs_t (mflw_t *m, num_t lw, int is) {
-  strex_kickhs<map_t>(m->tflw,lw,is);
+  TMAP(strex_kickhs<M>(f,lw,is));
 }
 
 void mad_trk_strex_drift_p (mflw_t *m, num_t lw, int is) {
@@ -1805,10 +2623,10 @@ void mad_trk_curex_kick_r (mflw_t *m, num_t lw, int is) {
 }
 
 void mad_trk_curex_drift_t (mflw_t *m, num_t lw, int is) {
-  curex_drift<map_t>(m->tflw,lw,is);
+  TMAP(curex_drift<M>(f,lw,is));
 }
 void mad_trk_curex_kick_t (mflw_t *m, num_t lw, int is) {
-  curex_kick<map_t>(m->tflw,lw,is);
+  TMAP(curex_kick<M>(f,lw,is));
 }
 
 void mad_trk_curex_drift_p (mflw_t *m, num_t lw, int is) {
@@ -1828,10 +2646,10 @@ void mad_trk_sbend_kick_r (mflw_t *m, num_t lw, int is) {
 }
 
 void mad_trk_sbend_thick_t (mflw_t *m, num_t lw, int is) {
-  sbend_thick<map_t>(m->tflw,lw,is);
+  TMAP(sbend_thick<M>(f,lw,is));
 }
 void mad_trk_sbend_kick_t (mflw_t *m, num_t lw, int is) {
-  curex_kick<map_t>(m->tflw,lw,is,true);
+  TMAP(curex_kick<M>(f,lw,is,true));
 }
 
 void mad_trk_sbend_thick_p (mflw_t *m, num_t lw, int is) {
@@ -1851,10 +2669,10 @@ void mad_trk_rbend_kick_r (mflw_t *m, num_t lw, int is) {
 }
 
 void mad_trk_rbend_thick_t (mflw_t *m, num_t lw, int is) {
-  rbend_thick<map_t>(m->tflw,lw,is);
+  TMAP(rbend_thick<M>(f,lw,is));
 }
 void mad_trk_rbend_kick_t (mflw_t *m, num_t lw, int is) {
-  strex_kick<map_t>(m->tflw,lw,is,true);
+  TMAP(strex_kick<M>(f,lw,is,true));
 }
 
 void mad_trk_rbend_thick_p (mflw_t *m, num_t lw, int is) {
@@ -1895,31 +2713,31 @@ void mad_trk_quad_kickh__r (mflw_t *m, num_t lw, int is) {
 }
 
 void mad_trk_quad_thick_t (mflw_t *m, num_t lw, int is) {
-  quad_thick<map_t>(m->tflw,lw,is);
+  TMAP(quad_thick<M>(f,lw,is));
 }
 void mad_trk_quad_thicks_t (mflw_t *m, num_t lw, int is) {
-  quad_thicks<map_t>(m->tflw,lw,is);
+  TMAP(quad_thicks<M>(f,lw,is));
 }
 void mad_trk_quad_thickh_t (mflw_t *m, num_t lw, int is) {
-  quad_thickh<map_t>(m->tflw,lw,is);
+  TMAP(quad_thickh<M>(f,lw,is));
 }
 void mad_trk_quad_kick_t (mflw_t *m, num_t lw, int is) {
-  quad_kick<map_t>(m->tflw,lw,0); (void)is; // always yoshida
+  TMAP(quad_kick<M>(f,lw,0)); (void)is; // always yoshida
 }
 void mad_trk_quad_kicks_t (mflw_t *m, num_t lw, int is) {
-  quad_kicks<map_t>(m->tflw,lw,0); (void)is; // always yoshida
+  TMAP(quad_kicks<M>(f,lw,0)); (void)is; // always yoshida
 }
 void mad_trk_quad_kickh_t (mflw_t *m, num_t lw, int is) {
-  quad_kickh<map_t>(m->tflw,lw,0); (void)is; // always yoshida
+  TMAP(quad_kickh<M>(f,lw,0)); (void)is; // always yoshida
 }
 void mad_trk_quad_kick__t (mflw_t *m, num_t lw, int is) {
-  quad_kick<map_t>(m->tflw,lw,is);
+  TMAP(quad_kick<M>(f,lw,is));
 }
 void mad_trk_quad_kicks__t (mflw_t *m, num_t lw, int is) {
-  quad_kicks<map_t>(m->tflw,lw,is);
+  TMAP(quad_kicks<M>(f,lw,is));
 }
 void mad_trk_quad_kickh__t (mflw_t *m, num_t lw, int is) {
-  quad_kickh<map_t>(m->tflw,lw,is);
+  TMAP(quad_kickh<M>(f,lw,is));
 }
 
 void mad_trk_quad_thick_p (mflw_t *m, num_t lw, int is) {
@@ -1956,7 +2774,7 @@ void mad_trk_solen_thick_r (mflw_t *m, num_t lw, int is) {
   solen_thick<par_t>(m->rflw,lw,is);
 }
 void mad_trk_solen_thick_t (mflw_t *m, num_t lw, int is) {
-  solen_thick<map_t>(m->tflw,lw,is);
+  TMAP(solen_thick<M>(f,lw,is));
 }
 void mad_trk_solen_thick_p (mflw_t *m, num_t lw, int is) {
   solen_thick<prm_t>(m->pflw,lw,is);
@@ -1968,7 +2786,7 @@ void mad_trk_esept_thick_r (mflw_t *m, num_t lw, int is) {
   esept_thick<par_t>(m->rflw,lw,is);
 }
 void mad_trk_esept_thick_t (mflw_t *m, num_t lw, int is) {
-  esept_thick<map_t>(m->tflw,lw,is);
+  TMAP(esept_thick<M>(f,lw,is));
 }
 void mad_trk_esept_thick_p (mflw_t *m, num_t lw, int is) {
   esept_thick<prm_t>(m->pflw,lw,is);
@@ -1984,10 +2802,10 @@ void mad_trk_rfcav_kickn_r (mflw_t *m, num_t lw, int is) {
 }
 
 void mad_trk_rfcav_kick_t (mflw_t *m, num_t lw, int is) {
-  rfcav_kick<map_t>(m->tflw,lw,is);
+  TMAP(rfcav_kick<M>(f,lw,is));
 }
 void mad_trk_rfcav_kickn_t (mflw_t *m, num_t lw, int is) {
-  rfcav_kickn<map_t>(m->tflw,lw,is);
+  TMAP(rfcav_kickn<M>(f,lw,is));
 }
 
 void mad_trk_rfcav_kick_p (mflw_t *m, num_t lw, int is) {
@@ -1997,6 +2815,55 @@ void mad_trk_rfcav_kickn_p (mflw_t *m, num_t lw, int is) {
   rfcav_kickn<prm_t>(m->pflw,lw,is);
 }
 
+// --- beam-beam ---
+
+void mad_trk_bbeam_kick_r (mflw_t *m, num_t lw, int is) {
+  bbeam_kick<par_t>(m->rflw,lw,is);
+}
+void mad_trk_bbeam_kick6D_r (mflw_t *m, num_t lw, int is) {
+  bbeam_kick6D<par_t>(m->rflw,lw,is);
+}
+
+void mad_trk_bbeam_kick_t (mflw_t *m, num_t lw, int is) {
+  TMAP(bbeam_kick<M>(f,lw,is));
+}
+void mad_trk_bbeam_kick6D_t (mflw_t *m, num_t lw, int is) {
+  TMAP(bbeam_kick6D<M>(f,lw,is));
+}
+
+void mad_trk_bbeam_kick_p (mflw_t *m, num_t lw, int is) {
+  bbeam_kick<prm_t>(m->pflw,lw,is);
+}
+void mad_trk_bbeam_kick6D_p (mflw_t *m, num_t lw, int is) {
+  bbeam_kick6D<prm_t>(m->pflw,lw,is);
+}
+
+// --- space-charge ---
+
+void mad_trk_spch_kick_r (mflw_t *m, num_t lw, int is) {
+  spch_kick<par_t>(m->rflw,lw,is);
+}
+
+void mad_trk_spch_kick_t (mflw_t *m, num_t lw, int is) {
+  TMAP(spch_kick<M>(f,lw,is));
+}
+
+void mad_trk_spch_kick_p (mflw_t *m, num_t lw, int is) {
+  spch_kick<prm_t>(m->pflw,lw,is);
+}
+
+// --- synchrotron radiation ---
+
+void mad_trk_srad_damp_r (mflw_t *m, num_t lw, srad_t *r) {
+  srad_damp<par_t>(m->rflw,lw,*r);
+}
+void mad_trk_srad_damp_t (mflw_t *m, num_t lw, srad_t *r) {
+  TMAP(srad_damp<M>(f,lw,*r));
+}
+void mad_trk_srad_quant_r (mflw_t *m, num_t lw, srad_t *r) {
+  srad_quant(m->rflw,lw,*r);
+}
+
 // --- do nothing ---
 
 void mad_trk_fnil (mflw_t *m, num_t lw, int is) {
@@ -2149,6 +3016,46 @@ void mad_trk_slice_tpt (mflw_t *m, num_t lw, trkfun *thick, trkfun *kick, int kn
     thick(m, lw*teapot[j].d, k++*d);
 }
 
+// --- track nsl uniform slices -----------------------------------------------o
+
+// used when there is no slice action to call back between slices
+void mad_trk_slice_nsl (mflw_t *m, num_t lw, trkfun *thick, trkfun *kick,
+                        char scm, int ord, int nsl)
+{
+  ensure(nsl > 0, "invalid number of slices (>0 expected)");
+  lw /= nsl;
+
+  switch (scm) {
+  case '1': FOR(i,nsl) mad_trk_slice_one(m, lw, thick);                 break;
+  case 'D': FOR(i,nsl) mad_trk_slice_dkd(m, lw, thick, kick, ord);      break;
+  case 'K': FOR(i,nsl) mad_trk_slice_kmk(m, lw, thick, kick, ord);      break;
+  case 'T': FOR(i,nsl) mad_trk_slice_tpt(m, lw, thick, kick, ord);      break;
+  default : error("invalid integration scheme '%c'", scm);
+  }
+}
+
+// --- track linear maps ------------------------------------------------------o
+
+// X = R X + K for npar particles, X is 6 x npar (i.e. coordinates by rows) and
+// R is 6 x 6, particles are processed by blocks to let the compiler vectorize.
+void mad_trk_linmap (ssz_t npar, num_t *X, const num_t *R, const num_t *K)
+{
+  enum { nb = 64 };
+  num_t Y[6][nb];
+
+  for (ssz_t i0=0; i0 < npar; i0 += nb) {
+    const ssz_t n = MIN(nb, npar-i0);
+    FOR(j,6) {
+      FOR(i,n) Y[j][i] = K[j];
+      FOR(k,6) {
+        const num_t r = R[6*j+k], *x = X+k*npar+i0;
+        FOR(i,n) Y[j][i] += r*x[i];
+      }
+    }
+    FOR(j,6) FOR(i,n) X[j*npar+i0+i] = Y[j][i];
+  }
+}
+
 // --- speed tests ------------------------------------------------------------o
 
 #if TPSA_SPDTESTS
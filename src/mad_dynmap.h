@@ -25,9 +25,11 @@
  */
 
 #include "mad_def.h"
+#include "mad_num.h"
 
 typedef union cflw_x mflw_t;
 typedef void (trkfun) (mflw_t*, num_t, int);
+typedef struct srad_ srad_t;
 
 // --- interface --------------------------------------------------------------o
 
@@ -37,6 +39,11 @@ void mad_trk_slice_tkt (mflw_t *m, num_t lw, trkfun *dft, trkfun *kck, int ord);
 void mad_trk_slice_kmk (mflw_t *m, num_t lw, trkfun *dft, trkfun *kck, int ord);// boole
 void mad_trk_slice_tpt (mflw_t *m, num_t lw, trkfun *dft, trkfun *kck, int knd);// teapot
 void mad_trk_slice_one (mflw_t *m, num_t lw, trkfun *dft_or_kck);               // single
+void mad_trk_slice_nsl (mflw_t *m, num_t lw, trkfun *dft, trkfun *kck,
+                        char scm, int ord, int nsl);                  // uniform
+
+// -- track linear maps (X is 6 x npar)
+void mad_trk_linmap    (ssz_t npar, num_t *X, const num_t *R, const num_t *K);
 
 // -- tilt & misalignment
 void mad_trk_tilt_r         (mflw_t *m, num_t lw);
@@ -146,16 +153,39 @@ void mad_trk_solen_thick_r  (mflw_t *m, num_t lw, int _);
 void mad_trk_esept_thick_r  (mflw_t *m, num_t lw, int _);
 void mad_trk_rfcav_kick_r   (mflw_t *m, num_t lw, int _);
 void mad_trk_rfcav_kickn_r  (mflw_t *m, num_t lw, int _);
+void mad_trk_bbeam_kick_r   (mflw_t *m, num_t lw, int _);
+void mad_trk_bbeam_kick6D_r (mflw_t *m, num_t lw, int _);
+void mad_trk_spch_kick_r   (mflw_t *m, num_t lw, int _);
 
 void mad_trk_solen_thick_t  (mflw_t *m, num_t lw, int _);
 void mad_trk_esept_thick_t  (mflw_t *m, num_t lw, int _);
 void mad_trk_rfcav_kick_t   (mflw_t *m, num_t lw, int _);
 void mad_trk_rfcav_kickn_t  (mflw_t *m, num_t lw, int _);
+void mad_trk_bbeam_kick_t   (mflw_t *m, num_t lw, int _);
+void mad_trk_bbeam_kick6D_t (mflw_t *m, num_t lw, int _);
+void mad_trk_spch_kick_t   (mflw_t *m, num_t lw, int _);
 
 void mad_trk_solen_thick_p  (mflw_t *m, num_t lw, int _);
 void mad_trk_esept_thick_p  (mflw_t *m, num_t lw, int _);
 void mad_trk_rfcav_kick_p   (mflw_t *m, num_t lw, int _);
 void mad_trk_rfcav_kickn_p  (mflw_t *m, num_t lw, int _);
+void mad_trk_bbeam_kick_p   (mflw_t *m, num_t lw, int _);
+void mad_trk_bbeam_kick6D_p (mflw_t *m, num_t lw, int _);
+void mad_trk_spch_kick_p   (mflw_t *m, num_t lw, int _);
+
+// -- synchrotron radiation (per slice, see madl_synrad.mad)
+void mad_trk_srad_damp_r    (mflw_t *m, num_t lw, srad_t *r);
+void mad_trk_srad_damp_t    (mflw_t *m, num_t lw, srad_t *r);
+void mad_trk_srad_quant_r   (mflw_t *m, num_t lw, srad_t *r);
+
+struct srad_ { // must be identical to def in madl_synrad.mad !!
+  num_t emrad, aphot, facr; // beam radiation constants, slice weight
+  crng_state_t rng;         // key (seed) of the particles random streams
+  u32_t turn, elem, slc;    // stream (id,turn,elem), first draw at slc*2^16
+  const idx_t *id;          // particles ids (i.e. streams)
+  num_t (*bak)[3];          // particles (x,px,py) at the previous slice
+  int nphot, mphot;         // number of photons emitted (total, max per par)
+};
 
 // -- do nothing
 void mad_trk_fnil           (mflw_t *m, num_t lw, int _);
@@ -169,6 +199,7 @@ void mad_trk_cpptest (void);
 extern const size_t mad_cflw_rsize;
 extern const size_t mad_cflw_tsize;
 extern const size_t mad_cflw_psize;
+extern const size_t mad_cflw_jsize;
 extern const size_t mad_cflw_xsize;
 
 // --- end --------------------------------------------------------------------o
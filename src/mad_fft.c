@@ -18,10 +18,12 @@
 
 #include <math.h>
 //#include <stdlib.h>
+#include <stdint.h>
 #include <string.h>
 #include <complex.h>
 #include <assert.h>
 
+#include "mad_cst.h"
 #include "mad_log.h"
 #include "mad_mem.h"
 #include "mad_vec.h"
@@ -140,6 +142,178 @@ mad_cmat_irfft (const cpx_t x[], num_t r[], ssz_t m, ssz_t n)
   mad_vec_muln(r, 1.0/(m*n), r, m*n);
 }
 
+/* -- NAFF --------------------------------------------------------------------o
+[1] J. Laskar, "Frequency analysis for multi-dimensional systems. Global
+    dynamics and diffusion", Physica D 67 (1993) 257-281.
+[2] R. Bartolini and F. Schmidt, "Normal form via tracking or beam data",
+    Part. Accel. 59 (1998) 93-106.
+
+Refined frequencies of a signal z[n] sampled each turn:
+  - the signal is windowed by the Hann window w_k = 1-cos(2pi k/n),
+  - the peak of the FFT of the windowed signal gives a coarse frequency,
+    refined by maximizing |<z,e^{2pi i f k}>_w| with a golden section search
+    in the main lobe [f-1/n, f+1/n],
+  - the component a e^{2pi i f k} is subtracted from the signal and the
+    process is repeated up to nf frequencies.
+Frequencies are in [0,1[ for complex signals (e.g. x-i*px normalized) and in
+[0,0.5] for real signals. Signals with NaN (e.g. lost particles) return NaN.
+*/
+
+static const num_t naff_tol = 1e-12;
+
+static inline log_t // NaN or Inf, robust to -ffast-math
+naff_nfin (num_t x)
+{
+  uint64_t u; memcpy(&u, &x, sizeof u);
+  return (u & 0x7ff0000000000000ull) == 0x7ff0000000000000ull;
+}
+
+static inline cpx_t // <z,e^{2pi i f k}>_w = 1/n sum_k w_k z_k e^{-2pi i f k}
+naff_amp (const cpx_t z[], const num_t w[], num_t f, ssz_t n)
+{
+  cpx_t s = 0, e = 1, de = cexp(-M_2PI*I*f);
+  for (idx_t k=0; k < n; k++) {
+    if (!(k & 255)) e = cexp(-M_2PI*I*f*k); // resync recurrence
+    s += w[k]*z[k]*e, e *= de;
+  }
+  return s/n;
+}
+
+static num_t // golden section search of max |<z,e^{2pi i f k}>_w| in [a,b]
+naff_max (const cpx_t z[], const num_t w[], num_t a, num_t b, ssz_t n)
+{
+  const num_t g = 0.6180339887498949;
+  num_t c = b-g*(b-a), d = a+g*(b-a);
+  num_t fc = cabs(naff_amp(z,w,c,n)), fd = cabs(naff_amp(z,w,d,n));
+
+  while (b-a > naff_tol) {
+    if (fc > fd) b = d, d = c, fd = fc, c = b-g*(b-a), fc = cabs(naff_amp(z,w,c,n));
+    else         a = c, c = d, fc = fd, d = a+g*(b-a), fd = cabs(naff_amp(z,w,d,n));
+  }
+  return (a+b)/2;
+}
+
+static ssz_t // z is modified, y and r are FFTW buffers of plan p
+naff (cpx_t z[], cpx_t y[], cpx_t r[], const num_t w[], fftw_plan p,
+      num_t f[], cpx_t a[], ssz_t n, ssz_t nf, log_t real)
+{
+  ssz_t j = 0;
+
+  for (idx_t k=0; k < n; k++)
+    if (naff_nfin(creal(z[k])) || naff_nfin(cimag(z[k]))) goto done;
+
+  for (; j < nf; j++) {
+    // coarse frequency from the FFT peak of the windowed signal
+    for (idx_t k=0; k < n; k++) y[k] = w[k]*z[k];
+    fftw_execute_dft(p, y, r);
+
+    ssz_t nk = real ? n/2+1 : n;
+    idx_t km = 0;
+    num_t rm = cabs(r[0]);
+    for (idx_t k=1; k < nk; k++)
+      if (cabs(r[k]) > rm) km = k, rm = cabs(r[k]);
+    if (rm == 0) break;
+
+    // refined frequency and amplitude
+    num_t fj = naff_max(z, w, (km-1.0)/n, (km+1.0)/n, n);
+    cpx_t aj = naff_amp(z, w, fj, n);
+    if (real) fj = fabs(fj);
+    else      fj = fj - floor(fj);
+
+    // subtract component from signal
+    cpx_t e = 1, de = cexp(M_2PI*I*fj);
+    for (idx_t k=0; k < n; k++) {
+      if (!(k & 255)) e = cexp(M_2PI*I*fj*k);
+      z[k] -= real ? (km ? 2 : 1)*creal(aj*e) : aj*e, e *= de;
+    }
+
+    f[j] = fj, a[j] = aj;
+  }
+
+done:
+  for (idx_t i=j; i < nf; i++) f[i] = NAN, a[i] = NAN;
+  return j;
+}
+
+static void
+naff_hann (num_t w[], ssz_t n)
+{
+  for (idx_t k=0; k < n; k++) w[k] = 1-cos(M_2PI*k/n);
+}
+
+static ssz_t
+naff_run (cpx_t z[], num_t f[], cpx_t a[], ssz_t n, ssz_t nf, log_t real)
+{
+  num_t *w = mad_malloc(n * sizeof *w);
+  naff_hann(w, n);
+
+  cpx_t *y = fftw_malloc(n * sizeof *y);
+  cpx_t *r = fftw_malloc(n * sizeof *r);
+  fftw_plan p = fftw_plan_dft_1d(n, y, r, FFTW_FORWARD, FFTW_ESTIMATE);
+
+  ssz_t nr = naff(z, y, r, w, p, f, a, n, nf, real);
+
+  fftw_destroy_plan(p);
+  fftw_free(r), fftw_free(y);
+  mad_free(w);
+  return nr;
+}
+
+ssz_t // x [n] -> f [nf], a [nf]
+mad_vec_naff (const num_t x[], num_t f[], cpx_t a[], ssz_t n, ssz_t nf)
+{
+  assert( x && f && a );
+  mad_alloc_tmp(cpx_t, z, n);
+  mad_vec_copyv(x, z, n);
+  ssz_t nr = naff_run(z, f, a, n, nf, TRUE);
+  mad_free_tmp(z);
+  return nr;
+}
+
+ssz_t // z [n] -> f [nf], a [nf]
+mad_cvec_naff (const cpx_t z[], num_t f[], cpx_t a[], ssz_t n, ssz_t nf)
+{
+  assert( z && f && a );
+  mad_alloc_tmp(cpx_t, cz, n);
+  mad_cvec_copy(z, cz, n);
+  ssz_t nr = naff_run(cz, f, a, n, nf, FALSE);
+  mad_free_tmp(cz);
+  return nr;
+}
+
+void // z [m x n] -> f [m x nf], a [m x nf], m signals of n turns
+mad_cmat_naff (const cpx_t z[], num_t f[], cpx_t a[], ssz_t m, ssz_t n, ssz_t nf)
+{
+  assert( z && f && a );
+  num_t *w = mad_malloc(n * sizeof *w);
+  naff_hann(w, n);
+
+  cpx_t *y = fftw_malloc(n * sizeof *y);
+  cpx_t *r = fftw_malloc(n * sizeof *r);
+  fftw_plan p = fftw_plan_dft_1d(n, y, r, FFTW_FORWARD, FFTW_ESTIMATE);
+
+#ifdef _OPENMP
+  #pragma omp parallel if (m > 1)
+#endif
+  { // plan execution is thread safe on fftw_malloc'ed buffers (same alignment)
+    cpx_t *zt = fftw_malloc(n * sizeof *zt);
+    cpx_t *yt = fftw_malloc(n * sizeof *yt);
+    cpx_t *rt = fftw_malloc(n * sizeof *rt);
+#ifdef _OPENMP
+    #pragma omp for schedule(dynamic)
+#endif
+    for (idx_t i=0; i < m; i++) {
+      mad_cvec_copy(z+i*n, zt, n);
+      naff(zt, yt, rt, w, p, f+i*nf, a+i*nf, n, nf, FALSE);
+    }
+    fftw_free(rt), fftw_free(yt), fftw_free(zt);
+  }
+
+  fftw_destroy_plan(p);
+  fftw_free(r), fftw_free(y);
+  mad_free(w);
+}
+
 /* -- NFFT --------------------------------------------------------------------o
 [1] J. Keiner, S. Kunis and D. Potts, "Using NFFT 3 — A Software Library for
     Various Nonequispaced Fast Fourier Transforms", ACM Transactions on
@@ -0,0 +1,388 @@
+#ifndef MAD_JET_HPP
+#define MAD_JET_HPP
+
+/*
+ o-----------------------------------------------------------------------------o
+ |
+ | Simple C++ first and second order jets (forward mode automatic differentiation)
+ |
+ | Methodical Accelerator Design - Copyright (c) 2016+
+ | Support: http://cern.ch/mad  - mad at cern.ch
+ | Authors: L. Deniau, laurent.deniau at cern.ch
+ | Contrib: -
+ |
+ o-----------------------------------------------------------------------------o
+ | You can redistribute this file and/or modify it under the terms of the GNU
+ | General Public License GPLv3 (or later), as published by the Free Software
+ | Foundation. This file is distributed in the hope that it will be useful, but
+ | WITHOUT ANY WARRANTY OF ANY KIND. See http://gnu.org/licenses for details.
+ o-----------------------------------------------------------------------------o
+
+  Purpose:
+  - Provide a dense value and gradient type of N variables, aka jet, with the
+    operators and functions used by the dynamic maps. A jet is a trivial type
+    that can be stack allocated or shared with LuaJIT FFI as num_t[1+N].
+  - Jets behave like a GTPSA truncated at order 1 with N variables, i.e. the
+    functions follow the tpsa conventions (e.g. fabs and fval use the value).
+  - Second order jets, aka jet2, add the symmetric Hessian stored as packed
+    upper triangle (i<=j, row major) and behave like a GTPSA truncated at
+    order 2. Note that the Hessian holds derivatives, not Taylor coefficients.
+
+ o-----------------------------------------------------------------------------o
+ */
+
+// --- includes ---------------------------------------------------------------o
+
+#include <cmath>
+
+extern "C" {
+#include "mad_num.h"
+}
+
+// --- types ------------------------------------------------------------------o
+
+namespace mad {
+
+template <int N>
+struct jet { // must be identical to jet6_t in madl_cmad.mad for N=6
+  num_t v, d[N]; // value and gradient
+
+  jet () = default;
+  jet (num_t a) : v(a) { for (int i=0; i<N; i++) d[i] = 0; }
+
+  jet& operator= (num_t a) { v = a; for (int i=0; i<N; i++) d[i] = 0; return *this; }
+
+  jet& operator+=(const jet &a) { v += a.v; for (int i=0; i<N; i++) d[i] += a.d[i]; return *this; }
+  jet& operator-=(const jet &a) { v -= a.v; for (int i=0; i<N; i++) d[i] -= a.d[i]; return *this; }
+  jet& operator*=(const jet &a) { return *this = *this * a; }
+  jet& operator/=(const jet &a) { return *this = *this / a; }
+
+  jet& operator+=(num_t a) { v += a; return *this; }
+  jet& operator-=(num_t a) { v -= a; return *this; }
+  jet& operator*=(num_t a) { v *= a; for (int i=0; i<N; i++) d[i] *= a; return *this; }
+  jet& operator/=(num_t a) { return *this *= 1/a; }
+
+  // r = f(a) with f'(a) = df (chain rule)
+  static jet chain (const jet &a, num_t f, num_t df) {
+    jet r; r.v = f; for (int i=0; i<N; i++) r.d[i] = df*a.d[i]; return r;
+  }
+
+  friend jet operator+ (const jet &a) { return a; }
+  friend jet operator- (const jet &a) { return chain(a, -a.v, -1); }
+
+  friend jet operator+ (jet a, const jet &b) { return a += b; }
+  friend jet operator- (jet a, const jet &b) { return a -= b; }
+  friend jet operator+ (jet a, num_t b) { return a += b; }
+  friend jet operator- (jet a, num_t b) { return a -= b; }
+  friend jet operator+ (num_t a, jet b) { return b += a; }
+  friend jet operator- (num_t a, const jet &b) { return chain(b, a-b.v, -1); }
+
+  friend jet operator* (const jet &a, const jet &b) {
+    jet r; r.v = a.v*b.v;
+    for (int i=0; i<N; i++) r.d[i] = a.d[i]*b.v + a.v*b.d[i];
+    return r;
+  }
+  friend jet operator* (jet a, num_t b) { return a *= b; }
+  friend jet operator* (num_t a, jet b) { return b *= a; }
+
+  friend jet operator/ (const jet &a, const jet &b) {
+    jet r; r.v = a.v/b.v; num_t ib = 1/b.v;
+    for (int i=0; i<N; i++) r.d[i] = (a.d[i] - r.v*b.d[i])*ib;
+    return r;
+  }
+  friend jet operator/ (jet a, num_t b) { return a /= b; }
+  friend jet operator/ (num_t a, const jet &b) {
+    num_t r = a/b.v; return chain(b, r, -r/b.v);
+  }
+};
+
+// --- functions ---
+
+template <int N> inline num_t fval (const jet<N> &a) { return a.v; }
+template <int N> inline num_t fabs (const jet<N> &a) { return std::abs(a.v); }
+
+template <int N>
+inline jet<N> sqr (const jet<N> &a) { return jet<N>::chain(a, a.v*a.v, 2*a.v); }
+
+template <int N>
+inline jet<N> inv (const jet<N> &a, num_t v=1) {
+  num_t r = v/a.v; return jet<N>::chain(a, r, -r/a.v);
+}
+
+template <int N>
+inline jet<N> sqrt (const jet<N> &a) {
+  num_t r = std::sqrt(a.v); return jet<N>::chain(a, r, 0.5/r);
+}
+
+template <int N>
+inline jet<N> invsqrt (const jet<N> &a, num_t v=1) {
+  num_t r = v/std::sqrt(a.v); return jet<N>::chain(a, r, -0.5*r/a.v);
+}
+
+template <int N>
+inline jet<N> pow (const jet<N> &a, int n) {
+  if (n == 0) return jet<N>(1);
+  num_t r = std::pow(a.v, n-1); return jet<N>::chain(a, r*a.v, n*r);
+}
+
+template <int N>
+inline jet<N> exp (const jet<N> &a) {
+  num_t r = std::exp(a.v); return jet<N>::chain(a, r, r);
+}
+
+template <int N>
+inline jet<N> log (const jet<N> &a) {
+  return jet<N>::chain(a, std::log(a.v), 1/a.v);
+}
+
+template <int N>
+inline jet<N> sin (const jet<N> &a) {
+  return jet<N>::chain(a, std::sin(a.v), std::cos(a.v));
+}
+
+template <int N>
+inline jet<N> cos (const jet<N> &a) {
+  return jet<N>::chain(a, std::cos(a.v), -std::sin(a.v));
+}
+
+template <int N>
+inline jet<N> tan (const jet<N> &a) {
+  num_t r = std::tan(a.v); return jet<N>::chain(a, r, 1+r*r);
+}
+
+template <int N>
+inline jet<N> sinh (const jet<N> &a) {
+  return jet<N>::chain(a, std::sinh(a.v), std::cosh(a.v));
+}
+
+template <int N>
+inline jet<N> cosh (const jet<N> &a) {
+  return jet<N>::chain(a, std::cosh(a.v), std::sinh(a.v));
+}
+
+template <int N>
+inline jet<N> asin (const jet<N> &a) {
+  return jet<N>::chain(a, std::asin(a.v), 1/std::sqrt(1-a.v*a.v));
+}
+
+template <int N>
+inline jet<N> atan (const jet<N> &a) {
+  return jet<N>::chain(a, std::atan(a.v), 1/(1+a.v*a.v));
+}
+
+// sinc, sinhc and asinc derivatives use Taylor series near zero
+
+template <int N>
+inline jet<N> sinc (const jet<N> &a) {
+  num_t x = a.v, r = mad_num_sinc(x), x2 = x*x;
+  num_t dr = std::abs(x) < 1e-4 ? x*(-1./3 + x2/30) : (std::cos(x)-r)/x;
+  return jet<N>::chain(a, r, dr);
+}
+
+template <int N>
+inline jet<N> sinhc (const jet<N> &a) {
+  num_t x = a.v, r = mad_num_sinhc(x), x2 = x*x;
+  num_t dr = std::abs(x) < 1e-4 ? x*(1./3 + x2/30) : (std::cosh(x)-r)/x;
+  return jet<N>::chain(a, r, dr);
+}
+
+template <int N>
+inline jet<N> asinc (const jet<N> &a) {
+  num_t x = a.v, r = mad_num_asinc(x), x2 = x*x;
+  num_t dr = std::abs(x) < 1e-4 ? x*(1./3 + 0.3*x2) : (1/std::sqrt(1-x2)-r)/x;
+  return jet<N>::chain(a, r, dr);
+}
+
+// --- second order jets ------------------------------------------------------o
+
+template <int N>
+struct jet2 {
+  static constexpr int H = N*(N+1)/2;
+  num_t v, d[N], h[H]; // value, gradient and hessian (packed upper triangle)
+
+  jet2 () = default;
+  jet2 (num_t a) : v(a) { clear(); }
+
+  jet2& operator= (num_t a) { v = a; clear(); return *this; }
+
+  jet2& operator+=(const jet2 &a) {
+    v += a.v;
+    for (int i=0; i<N; i++) d[i] += a.d[i];
+    for (int k=0; k<H; k++) h[k] += a.h[k];
+    return *this;
+  }
+  jet2& operator-=(const jet2 &a) {
+    v -= a.v;
+    for (int i=0; i<N; i++) d[i] -= a.d[i];
+    for (int k=0; k<H; k++) h[k] -= a.h[k];
+    return *this;
+  }
+  jet2& operator*=(const jet2 &a) { return *this = *this * a; }
+  jet2& operator/=(const jet2 &a) { return *this = *this / a; }
+
+  jet2& operator+=(num_t a) { v += a; return *this; }
+  jet2& operator-=(num_t a) { v -= a; return *this; }
+  jet2& operator*=(num_t a) {
+    v *= a;
+    for (int i=0; i<N; i++) d[i] *= a;
+    for (int k=0; k<H; k++) h[k] *= a;
+    return *this;
+  }
+  jet2& operator/=(num_t a) { return *this *= 1/a; }
+
+  void clear () {
+    for (int i=0; i<N; i++) d[i] = 0;
+    for (int k=0; k<H; k++) h[k] = 0;
+  }
+
+  // r = f(a) with f'(a) = df and f''(a) = d2f (chain rule)
+  static jet2 chain (const jet2 &a, num_t f, num_t df, num_t d2f) {
+    jet2 r; r.v = f;
+    for (int i=0; i<N; i++) r.d[i] = df*a.d[i];
+    for (int i=0, k=0; i<N; i++)
+      for (int j=i; j<N; j++, k++) r.h[k] = df*a.h[k] + d2f*a.d[i]*a.d[j];
+    return r;
+  }
+
+  friend jet2 operator+ (const jet2 &a) { return a; }
+  friend jet2 operator- (const jet2 &a) { return chain(a, -a.v, -1, 0); }
+
+  friend jet2 operator+ (jet2 a, const jet2 &b) { return a += b; }
+  friend jet2 operator- (jet2 a, const jet2 &b) { return a -= b; }
+  friend jet2 operator+ (jet2 a, num_t b) { return a += b; }
+  friend jet2 operator- (jet2 a, num_t b) { return a -= b; }
+  friend jet2 operator+ (num_t a, jet2 b) { return b += a; }
+  friend jet2 operator- (num_t a, const jet2 &b) { return chain(b, a-b.v, -1, 0); }
+
+  friend jet2 operator* (const jet2 &a, const jet2 &b) {
+    jet2 r; r.v = a.v*b.v;
+    for (int i=0; i<N; i++) r.d[i] = a.d[i]*b.v + a.v*b.d[i];
+    for (int i=0, k=0; i<N; i++)
+      for (int j=i; j<N; j++, k++)
+        r.h[k] = a.h[k]*b.v + a.v*b.h[k] + a.d[i]*b.d[j] + a.d[j]*b.d[i];
+    return r;
+  }
+  friend jet2 operator* (jet2 a, num_t b) { return a *= b; }
+  friend jet2 operator* (num_t a, jet2 b) { return b *= a; }
+
+  friend jet2 operator/ (const jet2 &a, const jet2 &b) {
+    num_t r = 1/b.v; return a * chain(b, r, -r*r, 2*r*r*r);
+  }
+  friend jet2 operator/ (jet2 a, num_t b) { return a /= b; }
+  friend jet2 operator/ (num_t a, const jet2 &b) {
+    num_t r = a/b.v; return chain(b, r, -r/b.v, 2*r/(b.v*b.v));
+  }
+};
+
+// --- functions ---
+
+template <int N> inline num_t fval (const jet2<N> &a) { return a.v; }
+template <int N> inline num_t fabs (const jet2<N> &a) { return std::abs(a.v); }
+
+template <int N>
+inline jet2<N> sqr (const jet2<N> &a) { return jet2<N>::chain(a, a.v*a.v, 2*a.v, 2); }
+
+template <int N>
+inline jet2<N> inv (const jet2<N> &a, num_t v=1) {
+  num_t r = v/a.v; return jet2<N>::chain(a, r, -r/a.v, 2*r/(a.v*a.v));
+}
+
+template <int N>
+inline jet2<N> sqrt (const jet2<N> &a) {
+  num_t r = std::sqrt(a.v), dr = 0.5/r; return jet2<N>::chain(a, r, dr, -0.5*dr/a.v);
+}
+
+template <int N>
+inline jet2<N> invsqrt (const jet2<N> &a, num_t v=1) {
+  num_t r = v/std::sqrt(a.v);
+  return jet2<N>::chain(a, r, -0.5*r/a.v, 0.75*r/(a.v*a.v));
+}
+
+template <int N>
+inline jet2<N> pow (const jet2<N> &a, int n) {
+  if (n == 0) return jet2<N>(1);
+  if (n == 1) return a;
+  num_t r = std::pow(a.v, n-2);
+  return jet2<N>::chain(a, r*a.v*a.v, n*r*a.v, n*(n-1)*r);
+}
+
+template <int N>
+inline jet2<N> exp (const jet2<N> &a) {
+  num_t r = std::exp(a.v); return jet2<N>::chain(a, r, r, r);
+}
+
+template <int N>
+inline jet2<N> log (const jet2<N> &a) {
+  num_t ia = 1/a.v; return jet2<N>::chain(a, std::log(a.v), ia, -ia*ia);
+}
+
+template <int N>
+inline jet2<N> sin (const jet2<N> &a) {
+  num_t s = std::sin(a.v); return jet2<N>::chain(a, s, std::cos(a.v), -s);
+}
+
+template <int N>
+inline jet2<N> cos (const jet2<N> &a) {
+  num_t c = std::cos(a.v); return jet2<N>::chain(a, c, -std::sin(a.v), -c);
+}
+
+template <int N>
+inline jet2<N> tan (const jet2<N> &a) {
+  num_t r = std::tan(a.v), dr = 1+r*r; return jet2<N>::chain(a, r, dr, 2*r*dr);
+}
+
+template <int N>
+inline jet2<N> sinh (const jet2<N> &a) {
+  num_t s = std::sinh(a.v); return jet2<N>::chain(a, s, std::cosh(a.v), s);
+}
+
+template <int N>
+inline jet2<N> cosh (const jet2<N> &a) {
+  num_t c = std::cosh(a.v); return jet2<N>::chain(a, c, std::sinh(a.v), c);
+}
+
+template <int N>
+inline jet2<N> asin (const jet2<N> &a) {
+  num_t dr = 1/std::sqrt(1-a.v*a.v);
+  return jet2<N>::chain(a, std::asin(a.v), dr, a.v*dr*dr*dr);
+}
+
+template <int N>
+inline jet2<N> atan (const jet2<N> &a) {
+  num_t dr = 1/(1+a.v*a.v); return jet2<N>::chain(a, std::atan(a.v), dr, -2*a.v*dr*dr);
+}
+
+// sinc, sinhc and asinc derivatives use Taylor series near zero
+
+template <int N>
+inline jet2<N> sinc (const jet2<N> &a) {
+  num_t x = a.v, r = mad_num_sinc(x), x2 = x*x, dr, d2r;
+  if (std::abs(x) < 1e-4) dr = x*(-1./3 + x2/30), d2r = -1./3 + x2/10;
+  else dr = (std::cos(x)-r)/x, d2r = -r - 2*dr/x;
+  return jet2<N>::chain(a, r, dr, d2r);
+}
+
+template <int N>
+inline jet2<N> sinhc (const jet2<N> &a) {
+  num_t x = a.v, r = mad_num_sinhc(x), x2 = x*x, dr, d2r;
+  if (std::abs(x) < 1e-4) dr = x*(1./3 + x2/30), d2r = 1./3 + x2/10;
+  else dr = (std::cosh(x)-r)/x, d2r = r - 2*dr/x;
+  return jet2<N>::chain(a, r, dr, d2r);
+}
+
+template <int N>
+inline jet2<N> asinc (const jet2<N> &a) {
+  num_t x = a.v, r = mad_num_asinc(x), x2 = x*x, dr, d2r;
+  if (std::abs(x) < 1e-4) dr = x*(1./3 + 0.3*x2), d2r = 1./3 + 0.9*x2;
+  else {
+    num_t is = 1/std::sqrt(1-x2);
+    dr = (is-r)/x, d2r = (x*is*is*is - 2*dr)/x;
+  }
+  return jet2<N>::chain(a, r, dr, d2r);
+}
+
+} // mad
+
+// --- end --------------------------------------------------------------------o
+
+#endif // MAD_JET_HPP
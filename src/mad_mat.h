@@ -113,6 +113,7 @@ void  mad_cmat_nfft    (const cpx_t x[], const num_t x_node[],  cpx_t r[], ssz_t
 void  mad_cmat_ifft    (const cpx_t x[],                        cpx_t r[], ssz_t m, ssz_t n);                       //  cmat ->cmat
 void  mad_cmat_irfft   (const cpx_t x[],                        num_t r[], ssz_t m, ssz_t n);                       //  cmat -> mat
 void  mad_cmat_infft   (const cpx_t x[], const num_t r_node[],  cpx_t r[], ssz_t m, ssz_t n, ssz_t nx);
+void  mad_cmat_naff    (const cpx_t x[], num_t f[],             cpx_t a[], ssz_t m, ssz_t n, ssz_t nf);             //  NAFF
 void  mad_cmat_sympconj(const cpx_t x[],                        cpx_t r[],          ssz_t n);                       //  -J M' J
 num_t mad_cmat_symperr (const cpx_t x[],                        cpx_t r[],          ssz_t n, num_t *tol_);          //  M' J M - J
 
@@ -0,0 +1,132 @@
+/*
+ o-----------------------------------------------------------------------------o
+ |
+ | MPI module implementation
+ |
+ | Methodical Accelerator Design - Copyright (c) 2016+
+ | Support: http://cern.ch/mad  - mad at cern.ch
+ | Authors: L. Deniau, laurent.deniau at cern.ch
+ | Contrib: -
+ |
+ o-----------------------------------------------------------------------------o
+ | You can redistribute this file and/or modify it under the terms of the GNU
+ | General Public License GPLv3 (or later), as published by the Free Software
+ | Foundation. This file is distributed in the hope that it will be useful, but
+ | WITHOUT ANY WARRANTY OF ANY KIND. See http://gnu.org/licenses for details.
+ o-----------------------------------------------------------------------------o
+*/
+
+#include <limits.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef MAD_MPI
+#include <mpi.h>
+#endif
+
+#include "mad_log.h"
+#include "mad_mem.h"
+#include "mad_mpi.h"
+
+// --- implementation ---------------------------------------------------------o
+
+#ifdef MAD_MPI
+
+static int mpi_own = 0; // MPI initialized by mad_mpi_init
+
+int
+mad_mpi_init (void)
+{
+  int flg;
+  MPI_Initialized(&flg);
+  if (!flg) {
+    ensure(MPI_Init(NULL, NULL) == MPI_SUCCESS, "unable to initialize MPI");
+    mpi_own = 1;
+    atexit(mad_mpi_fini);
+  }
+  return mad_mpi_size();
+}
+
+void
+mad_mpi_fini (void)
+{
+  int flg;
+  if (!mpi_own) return;
+  MPI_Finalized(&flg);
+  if (!flg) MPI_Finalize();
+  mpi_own = 0;
+}
+
+int
+mad_mpi_rank (void)
+{
+  int r = 0;
+  MPI_Comm_rank(MPI_COMM_WORLD, &r);
+  return r;
+}
+
+int
+mad_mpi_size (void)
+{
+  int n = 1;
+  MPI_Comm_size(MPI_COMM_WORLD, &n);
+  return n;
+}
+
+void
+mad_mpi_barrier (void)
+{
+  MPI_Barrier(MPI_COMM_WORLD);
+}
+
+int64_t
+mad_mpi_gatherlen (int64_t len, int64_t lens[])
+{
+  int n = mad_mpi_size();
+  MPI_Allgather(&len, 1, MPI_INT64_T, lens, 1, MPI_INT64_T, MPI_COMM_WORLD);
+
+  int64_t tot = 0;
+  for (int i=0; i < n; i++) tot += lens[i];
+  ensure(tot <= INT_MAX, "MPI gathered buffers exceed %d bytes", INT_MAX);
+  return tot;
+}
+
+void
+mad_mpi_gather (const void *buf, int64_t len, const int64_t lens[], void *out)
+{
+  int n = mad_mpi_size();
+  mad_alloc_tmp(int, cnt, n);
+  mad_alloc_tmp(int, dsp, n);
+
+  for (int i=0, d=0; i < n; d += cnt[i++]) cnt[i] = lens[i], dsp[i] = d;
+
+  MPI_Allgatherv(buf, len, MPI_BYTE, out, cnt, dsp, MPI_BYTE, MPI_COMM_WORLD);
+
+  mad_free_tmp(cnt);
+  mad_free_tmp(dsp);
+}
+
+#else // serial (single rank)
+
+int  mad_mpi_init    (void) { return 1; }
+void mad_mpi_fini    (void) {}
+int  mad_mpi_rank    (void) { return 0; }
+int  mad_mpi_size    (void) { return 1; }
+void mad_mpi_barrier (void) {}
+
+int64_t
+mad_mpi_gatherlen (int64_t len, int64_t lens[])
+{
+  return lens[0] = len;
+}
+
+void
+mad_mpi_gather (const void *buf, int64_t len, const int64_t lens[], void *out)
+{
+  (void)lens;
+  memcpy(out, buf, len);
+}
+
+#endif
+
+// ----------------------------------------------------------------------------o
@@ -0,0 +1,56 @@
+#ifndef MAD_MPI_H
+#define MAD_MPI_H
+
+/*
+ o-----------------------------------------------------------------------------o
+ |
+ | MPI module interface
+ |
+ | Methodical Accelerator Design - Copyright (c) 2016+
+ | Support: http://cern.ch/mad  - mad at cern.ch
+ | Authors: L. Deniau, laurent.deniau at cern.ch
+ | Contrib: -
+ |
+ o-----------------------------------------------------------------------------o
+ | You can redistribute this file and/or modify it under the terms of the GNU
+ | General Public License GPLv3 (or later), as published by the Free Software
+ | Foundation. This file is distributed in the hope that it will be useful, but
+ | WITHOUT ANY WARRANTY OF ANY KIND. See http://gnu.org/licenses for details.
+ o-----------------------------------------------------------------------------o
+
+  Purpose:
+  - Provide the minimal support to distribute the tracking over MPI ranks
+    (e.g. track mpi), i.e. ranks identification, synchronization and exchange
+    of variable size byte buffers between all ranks.
+
+  Information:
+  - MPI is only available when compiled with MAD_MPI defined (e.g. make MPI=1),
+    otherwise the functions behave as a single rank (i.e. rank 0 of size 1).
+  - mad_mpi_init initializes MPI once (if not already done by the caller) and
+    registers mad_mpi_fini to be called at exit, it returns the number of ranks.
+  - mad_mpi_gatherlen gathers the sizes len of the buffers of all ranks in
+    lens[size] and returns the total size.
+  - mad_mpi_gather gathers the buffers buf of size len of all ranks in out
+    (rank order), where lens[size] are the sizes returned by mad_mpi_gatherlen.
+  - all ranks must call the collective functions in the same order.
+
+ o-----------------------------------------------------------------------------o
+ */
+
+#include "mad_def.h"
+
+// --- interface --------------------------------------------------------------o
+
+int     mad_mpi_init      (void);
+void    mad_mpi_fini      (void);
+int     mad_mpi_rank      (void);
+int     mad_mpi_size      (void);
+void    mad_mpi_barrier   (void);
+
+int64_t mad_mpi_gatherlen (int64_t len, int64_t lens[]);
+void    mad_mpi_gather    (const void *buf, int64_t len, const int64_t lens[],
+                           void *out);
+
+// ----------------------------------------------------------------------------o
+
+#endif // MAD_MPI_H
@@ -401,6 +401,89 @@ void mad_num_randjump (prng_state_t *restrict st)
 
 #undef N
 
+// -- RNG Philox4x32-10 -------------------------------------------------------o
+
+/* Counter-based generator of J. Salmon et al., "Parallel random numbers: as
+   easy as 1, 2, 3", SC11 (2011). The draw #n of the stream (k; c0,c1,c2) is
+   the 64-bit lane n%2 of Philox(k; c0,c1,c2,n/2), hence any draw of any
+   stream can be computed independently of the others, in any order.
+*/
+
+static inline void
+philox (const u32_t k_[2], u32_t c0, u32_t c1, u32_t c2, u32_t c3, u32_t r[4])
+{
+  u32_t k0 = k_[0], k1 = k_[1];
+
+  for (int i=0; i < 10; i++) {
+    const u64_t p0 = (u64_t)0xD2511F53u * c0;
+    const u64_t p1 = (u64_t)0xCD9E8D57u * c2;
+    c0 = (u32_t)(p1 >> 32) ^ c1 ^ k0; c1 = (u32_t)p1;
+    c2 = (u32_t)(p0 >> 32) ^ c3 ^ k1; c3 = (u32_t)p0;
+    k0 += 0x9E3779B9u, k1 += 0xBB67AE85u;
+  }
+
+  r[0] = c0, r[1] = c1, r[2] = c2, r[3] = c3;
+}
+
+static inline num_t
+u64tonum (u64_t x)
+{
+  const union numbit n = { .u = 0x3ffULL << 52 | x >> 12 };
+  return n.d - 1; // [1.,2.) -> [0.,1.)
+}
+
+u64_t mad_num_crandi (crng_state_t *restrict st)
+{
+  u32_t r[4];
+  const u32_t l = 2*(st->n & 1);
+  philox(st->k, st->c[0], st->c[1], st->c[2], st->n >> 1, r);
+  st->n += 1;
+  return (u64_t)r[l] << 32 | r[l+1];
+}
+
+num_t mad_num_crand (crng_state_t *restrict st)
+{
+  return u64tonum(mad_num_crandi(st));
+}
+
+void mad_num_crandv (crng_state_t *restrict st, num_t r[], ssz_t n)
+{
+  assert(r);
+  idx_t i = 0;
+  if (n > 0 && st->n & 1) r[i++] = mad_num_crand(st);
+
+  const u32_t n0 = st->n >> 1;
+  const ssz_t nb = (n-i)/2;
+  FOR(b,nb) { // independent blocks
+    u32_t v[4];
+    philox(st->k, st->c[0], st->c[1], st->c[2], n0+b, v);
+    r[i+2*b  ] = u64tonum((u64_t)v[0] << 32 | v[1]);
+    r[i+2*b+1] = u64tonum((u64_t)v[2] << 32 | v[3]);
+  }
+  st->n += 2*nb, i += 2*nb;
+
+  if (i < n) r[i] = mad_num_crand(st);
+}
+
+void mad_num_crandexpv (crng_state_t *restrict st, num_t r[], ssz_t n, num_t mu)
+{
+  mad_num_crandv(st, r, n);
+  FOR(i,n) r[i] = -mu * log1p(-r[i]);
+}
+
+void mad_num_crandpos (crng_state_t *restrict st, u32_t id, u32_t turn, u32_t elem)
+{
+  st->c[0] = id, st->c[1] = turn, st->c[2] = elem, st->n = 0;
+}
+
+void mad_num_crandseed (crng_state_t *restrict st, num_t seed)
+{
+  const union numbit n = { .d = seed };
+  const u64_t k = splitmix64(n.u);
+  st->k[0] = (u32_t)k, st->k[1] = (u32_t)(k >> 32);
+  mad_num_crandpos(st, 0, 0, 0);
+}
+
 // -- RNG MADX ----------------------------------------------------------------o
 
 #define MAX_RAND 1000000000
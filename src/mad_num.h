@@ -145,6 +145,23 @@ struct xrng_state_ {
   idx_t n;
 };
 
+// MAD counter-based pseudo-random number generator (Philox4x32-10)
+typedef struct crng_state_ crng_state_t;
+
+num_t mad_num_crand     (crng_state_t*);            // [0.,1.)
+u64_t mad_num_crandi    (crng_state_t*);            // [0,ULLONG_MAX]
+void  mad_num_crandv    (crng_state_t*, num_t r[], ssz_t n);          // [0.,1.)
+void  mad_num_crandexpv (crng_state_t*, num_t r[], ssz_t n, num_t mu); // exp(mu)
+void  mad_num_crandpos  (crng_state_t*, u32_t id, u32_t turn, u32_t elem);
+void  mad_num_crandseed (crng_state_t*, num_t seed);
+
+// --- private
+struct crng_state_ {
+  u32_t k[2];         // key (seed)
+  u32_t c[3];         // stream (e.g. particle id, turn, element)
+  u32_t n;            // draw index in stream
+};
+
 // --- OMP --------------------------------------------------------------------o
 
 num_t mad_num_suminv (u64_t n); // dummy function for testing OpenMP
@@ -0,0 +1,99 @@
+/*
+ o-----------------------------------------------------------------------------o
+ |
+ | Processes module implementation
+ |
+ | Methodical Accelerator Design - Copyright (c) 2016+
+ | Support: http://cern.ch/mad  - mad at cern.ch
+ | Authors: L. Deniau, laurent.deniau at cern.ch
+ | Contrib: -
+ |
+ o-----------------------------------------------------------------------------o
+ | You can redistribute this file and/or modify it under the terms of the GNU
+ | General Public License GPLv3 (or later), as published by the Free Software
+ | Foundation. This file is distributed in the hope that it will be useful, but
+ | WITHOUT ANY WARRANTY OF ANY KIND. See http://gnu.org/licenses for details.
+ o-----------------------------------------------------------------------------o
+*/
+
+#if !defined(_WIN32) && !defined(_WIN64)
+#define _DEFAULT_SOURCE
+#include <errno.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "mad_proc.h"
+
+// --- implementation ---------------------------------------------------------o
+
+#if !defined(_WIN32) && !defined(_WIN64)
+
+#ifndef MAP_ANONYMOUS
+#define MAP_ANONYMOUS MAP_ANON
+#endif
+
+#ifndef MAP_NORESERVE
+#define MAP_NORESERVE 0
+#endif
+
+int
+mad_proc_ncpu (void)
+{
+  long n = sysconf(_SC_NPROCESSORS_ONLN);
+  return n > 0 ? n : 1;
+}
+
+int
+mad_proc_fork (void)
+{
+  fflush(NULL); // avoid duplicated outputs
+  return fork();
+}
+
+int
+mad_proc_wait (int pid)
+{
+  int st;
+  while (waitpid(pid, &st, 0) < 0)
+    if (errno != EINTR) return -1;
+  return WIFEXITED(st) ? WEXITSTATUS(st) : -1;
+}
+
+void
+mad_proc_exit (int status)
+{
+  fflush(NULL);
+  _exit(status);
+}
+
+void*
+mad_proc_shmnew (size_t size)
+{
+  void *ptr = mmap(NULL, size, PROT_READ | PROT_WRITE,
+                   MAP_SHARED | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+  return ptr == MAP_FAILED ? NULL : ptr;
+}
+
+void
+mad_proc_shmdel (void *ptr, size_t size)
+{
+  if (ptr) munmap(ptr, size);
+}
+
+#else // Windows
+
+int   mad_proc_ncpu   (void)                { return 1;  }
+int   mad_proc_fork   (void)                { return -1; }
+int   mad_proc_wait   (int pid)             { (void)pid; return -1; }
+void  mad_proc_exit   (int status)          { fflush(NULL); _Exit(status); }
+void* mad_proc_shmnew (size_t size)         { (void)size; return NULL; }
+void  mad_proc_shmdel (void *ptr, size_t size) { (void)ptr, (void)size; }
+
+#endif
+
+// ----------------------------------------------------------------------------o
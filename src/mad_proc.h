@@ -0,0 +1,53 @@
+#ifndef MAD_PROC_H
+#define MAD_PROC_H
+
+/*
+ o-----------------------------------------------------------------------------o
+ |
+ | Processes module interface
+ |
+ | Methodical Accelerator Design - Copyright (c) 2016+
+ | Support: http://cern.ch/mad  - mad at cern.ch
+ | Authors: L. Deniau, laurent.deniau at cern.ch
+ | Contrib: -
+ |
+ o-----------------------------------------------------------------------------o
+ | You can redistribute this file and/or modify it under the terms of the GNU
+ | General Public License GPLv3 (or later), as published by the Free Software
+ | Foundation. This file is distributed in the hope that it will be useful, but
+ | WITHOUT ANY WARRANTY OF ANY KIND. See http://gnu.org/licenses for details.
+ o-----------------------------------------------------------------------------o
+
+  Purpose:
+  - Provide the minimal support to run worker processes (e.g. track nproc),
+    i.e. forking, waiting and exchanging data through shared memory.
+
+  Information:
+  - mad_proc_ncpu returns the number of online processors.
+  - mad_proc_fork flushes all output streams before forking, and returns the
+    pid of the child in the parent, 0 in the child and -1 on failure.
+  - mad_proc_wait returns the exit status of the child or -1 on failure.
+  - mad_proc_exit flushes all output streams and terminates the child without
+    calling the exit handlers (i.e. inherited from the parent).
+  - mad_proc_shmnew returns an anonymous memory mapping shared with the forked
+    children, physical pages are only allocated when used (size is a bound).
+  - processes are not supported on Windows (i.e. fork fails).
+
+ o-----------------------------------------------------------------------------o
+ */
+
+#include "mad_def.h"
+
+// --- interface --------------------------------------------------------------o
+
+int   mad_proc_ncpu   (void);
+int   mad_proc_fork   (void);
+int   mad_proc_wait   (int pid);
+void  mad_proc_exit   (int status);
+
+void* mad_proc_shmnew (size_t size);
+void  mad_proc_shmdel (void *ptr, size_t size);
+
+// ----------------------------------------------------------------------------o
+
+#endif // MAD_PROC_H
@@ -100,6 +100,15 @@ mad_rad_InvSynFracInt (num_t x)
   else                 return y*Chebyshev(aa5,aa6,cheb4,ncheb4,y);
 }
 
+// --- Photons spectrum -------------------------------------------------------o
+
+void
+mad_rad_photv (crng_state_t *rng, num_t r[], ssz_t n)
+{
+  mad_num_crandv(rng, r, n);
+  for (idx_t i=0; i < n; i++) r[i] = mad_rad_InvSynFracInt(r[i]);
+}
+
 #if 0
 // Obsolete code not used, adapted from Placet (courtesy A. Latina)
 
@@ -28,11 +28,15 @@
  */
 
 #include "mad_def.h"
+#include "mad_num.h"
 
 // --- interface --------------------------------------------------------------o
 
 num_t mad_rad_InvSynFracInt (num_t x); // HBU 2007
 
+// photons energies normalized to the critical energy drawn from the stream
+void  mad_rad_photv (crng_state_t*, num_t r[], ssz_t n);
+
 // ----------------------------------------------------------------------------o
 
 #if 0
@@ -0,0 +1,80 @@
+/*
+ o-----------------------------------------------------------------------------o
+ |
+ | Parameters schedules module implementation
+ |
+ | Methodical Accelerator Design - Copyright (c) 2016+
+ | Support: http://cern.ch/mad  - mad at cern.ch
+ | Authors: L. Deniau, laurent.deniau at cern.ch
+ | Contrib: -
+ |
+ o-----------------------------------------------------------------------------o
+ | You can redistribute this file and/or modify it under the terms of the GNU
+ | General Public License GPLv3 (or later), as published by the Free Software
+ | Foundation. This file is distributed in the hope that it will be useful, but
+ | WITHOUT ANY WARRANTY OF ANY KIND. See http://gnu.org/licenses for details.
+ o-----------------------------------------------------------------------------o
+*/
+
+#include <math.h>
+#include <assert.h>
+
+#include "mad_cst.h"
+#include "mad_log.h"
+#include "mad_sched.h"
+
+// --- implementation ---------------------------------------------------------o
+
+static inline num_t
+sched_tbl (const sched_t *s, num_t u)
+{
+  const num_t *x = s->x, *y = s->y;
+  ssz_t n = s->n;
+
+  if (u <= x[0  ]) return y[0  ];
+  if (u >= x[n-1]) return y[n-1];
+
+  ssz_t i = 0, j = n-1; // bisection, x[i] < u < x[j]
+  while (j-i > 1) {
+    ssz_t k = (i+j)/2;
+    if (u < x[k]) j = k; else i = k;
+  }
+  return y[i] + (y[j]-y[i])*(u-x[i])/(x[j]-x[i]);
+}
+
+static inline num_t
+sched_rnd (const sched_t *s, u32_t turn)
+{
+  crng_state_t st = s->rng;
+  mad_num_crandpos(&st, s->id, turn, 0);
+
+  num_t u1 = mad_num_crand(&st), u2 = mad_num_crand(&st); // Box-Muller
+  return sqrt(-2*log1p(-u1)) * cos(2*M_PI*u2);
+}
+
+num_t
+mad_sched_eval (const sched_t *s, u32_t turn, num_t time)
+{
+  assert(s);
+  num_t u = s->clk == sched_time ? time : turn;
+  num_t f = 0;
+
+  switch (s->kind) {
+  case sched_table: f = sched_tbl(s, u);                break;
+  case sched_sine : f = sin(2*M_PI*s->frq*u + s->phs);  break;
+  case sched_noise: f = sched_rnd(s, turn);             break;
+  default: error("invalid schedule kind %d", s->kind);
+  }
+
+  num_t a = s->env ? s->amp*mad_sched_eval(s->env, turn, time) : s->amp;
+  return s->off + a*f;
+}
+
+void
+mad_sched_evalv (ssz_t n, const sched_t *s[], u32_t turn, num_t time, num_t r[])
+{
+  assert(s && r);
+  FOR(i,n) r[i] = mad_sched_eval(s[i], turn, time);
+}
+
+// --- end --------------------------------------------------------------------o
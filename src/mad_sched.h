@@ -0,0 +1,65 @@
+#ifndef MAD_SCHED_H
+#define MAD_SCHED_H
+
+/*
+ o-----------------------------------------------------------------------------o
+ |
+ | Parameters schedules module interface
+ |
+ | Methodical Accelerator Design - Copyright (c) 2016+
+ | Support: http://cern.ch/mad  - mad at cern.ch
+ | Authors: L. Deniau, laurent.deniau at cern.ch
+ | Contrib: -
+ |
+ o-----------------------------------------------------------------------------o
+ | You can redistribute this file and/or modify it under the terms of the GNU
+ | General Public License GPLv3 (or later), as published by the Free Software
+ | Foundation. This file is distributed in the hope that it will be useful, but
+ | WITHOUT ANY WARRANTY OF ANY KIND. See http://gnu.org/licenses for details.
+ o-----------------------------------------------------------------------------o
+
+  Purpose:
+  - Provide the evaluation of elements parameters schedules, i.e. functions of
+    the turn or the time used by track to ramp or modulate elements attributes.
+
+  Information:
+  - the value of a schedule is off + amp*env*f(u), where u is the turn or the
+    time [s] (see clk), env is the value of the optional envelope schedule and
+    f(u) is one of:
+    - table: piecewise linear interpolation of (x,y), constant outside x.
+    - sine : sin(2pi*frq*u + phs), frq is a tune for turns or [Hz] for time.
+    - noise: normal distribution N(0,1), one draw per turn (sample and hold)
+             from the counter based stream of seed and id.
+
+ o-----------------------------------------------------------------------------o
+ */
+
+#include "mad_num.h"
+
+// --- types ------------------------------------------------------------------o
+
+enum { sched_table, sched_sine, sched_noise };  // kind
+enum { sched_turn , sched_time };               // clk
+
+typedef struct sched_ sched_t;
+
+struct sched_ {
+  int   kind, clk;
+  num_t off, amp;
+  num_t frq, phs;       // sine
+  ssz_t n;              // table
+  const num_t *x, *y;
+  crng_state_t rng;     // noise
+  u32_t id;
+  const sched_t *env;   // envelope (optional)
+};
+
+// --- interface --------------------------------------------------------------o
+
+num_t mad_sched_eval  (const sched_t *s, u32_t turn, num_t time);
+void  mad_sched_evalv (ssz_t n, const sched_t *s[], u32_t turn, num_t time,
+                       num_t r[]);
+
+// ----------------------------------------------------------------------------o
+
+#endif // MAD_SCHED_H
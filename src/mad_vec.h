@@ -71,6 +71,7 @@ void  mad_vec_difv   (const num_t x[], const cpx_t y[],        cpx_t r[], ssz_t
 void  mad_vec_fft    (const num_t x[],                         cpx_t r[], ssz_t n); // vec ->cvec
 void  mad_vec_rfft   (const num_t x[],                         cpx_t r[], ssz_t n); // vec ->cvec
 void  mad_vec_nfft   (const num_t x[], const num_t x_node[],   cpx_t r[], ssz_t n, ssz_t nr);
+ssz_t mad_vec_naff   (const num_t x[], num_t f[],              cpx_t a[], ssz_t n, ssz_t nf); // NAFF
 void  mad_vec_kadd   (int k,const num_t a[], const num_t *x[], num_t r[], ssz_t n); //  sum_k ax
 
 void  mad_cvec_fill  (      cpx_t x  ,                         cpx_t r[], ssz_t n); // cpx ->cvec
@@ -132,7 +133,10 @@ void  mad_cvec_nfft  (const cpx_t x[], const num_t x_node[],   cpx_t r[], ssz_t
 void  mad_cvec_ifft  (const cpx_t x[],                         cpx_t r[], ssz_t n); // cvec ->cvec
 void  mad_cvec_irfft (const cpx_t x[],                         num_t r[], ssz_t n); // cvec -> vec
 void  mad_cvec_infft (const cpx_t x[], const num_t r_node[],   cpx_t r[], ssz_t n, ssz_t nx);
+ssz_t mad_cvec_naff  (const cpx_t x[], num_t f[],              cpx_t a[], ssz_t n, ssz_t nf); // NAFF
 void  mad_cvec_kadd  (int k,const cpx_t a[], const cpx_t *x[], cpx_t r[], ssz_t n); // sum_k ax
+void  mad_cvec_wf    (const cpx_t x[],                         cpx_t r[], ssz_t n); // w(cvec)
+void  mad_cvec_wf_r  (const num_t x_re[], const num_t x_im[], num_t r_re[], num_t r_im[], ssz_t n);
 
 void  mad_ivec_fill  (      idx_t x  ,                         idx_t r[], ssz_t n); // idx ->ivec
 void  mad_ivec_roll  (      idx_t x[],                                    ssz_t n, int nroll);